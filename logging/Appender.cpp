@@ -1,76 +1,159 @@
 #include "logging/Appender.hpp"
+#include "logging/Category.hpp"
+#include "logging/Layout.hpp"
 #include "ocl/Component.hpp"
 
 #include <log4cpp/Appender.hh>
 #include <log4cpp/BasicLayout.hh>
 #include <log4cpp/SimpleLayout.hh>
 #include <log4cpp/PatternLayout.hh>
+#include <rtt/os/TimeService.hpp>
 
 namespace OCL {
 namespace logging {
 
 Appender::Appender(std::string name) :
     RTT::TaskContext(name, RTT::TaskContext::PreOperational), 
+        event_queue(0),
+        queueCapacity_prop("QueueCapacity", "Number of events in the queue used when the logging service uses event queues", 100),
         appender(0),
         layoutName_prop("LayoutName", "Layout name (e.g. 'simple', 'pattern')"),
         layoutPattern_prop("LayoutPattern", "Layout conversion pattern (for those layouts that use a pattern)"),
+        drainTimeBudget_prop("DrainTimeBudget", "Time per cycle in seconds to process more events than the maximum when there is a backlog (0 to disable)", 0.0),
+        queueDepth_prop("QueueDepth", "Events in the event queue after the last cycle (read-only)", 0),
+        queueHighWater_prop("QueueHighWater", "Highest number of events in the event queue since start (read-only)", 0),
+        eventsPerCycle_prop("EventsPerCycle", "Events processed in the last cycle (read-only)", 0),
+        droppedEvents_prop("DroppedEvents", "Events dropped by categories as the event queue or pool was full (read-only)", 0),
+        worstLatency_prop("WorstLatency", "Highest time between logging and processing an event since start, in seconds (read-only)", 0.0),
         countMaxPopped(0)
 {
     ports()->addEventPort("LogPort", log_port );
 
+    properties()->addProperty(queueCapacity_prop);
     properties()->addProperty(layoutName_prop);
     properties()->addProperty(layoutPattern_prop);
+    properties()->addProperty(drainTimeBudget_prop);
+    properties()->addProperty(queueDepth_prop);
+    properties()->addProperty(queueHighWater_prop);
+    properties()->addProperty(eventsPerCycle_prop);
+    properties()->addProperty(droppedEvents_prop);
+    properties()->addProperty(worstLatency_prop);
 }
 
 Appender::~Appender()
 {
+    if (event_queue)
+    {
+        // categories may still send events to the queue
+        Category::removeEventQueue(event_queue);
+        // releases the events still queued
+        delete event_queue;
+    }
+}
+
+LoggingEventQueue* Appender::getEventQueue()
+{
+    if (!event_queue)
+    {
+        int capacity = queueCapacity_prop.rvalue();
+        if (0 >= capacity)
+        {
+            log(RTT::Error) << "Invalid QueueCapacity value of "
+                            << capacity << ". Value must be > 0."
+                            << RTT::endlog();
+            return 0;
+        }
+        event_queue = new LoggingEventQueue(capacity, this);
+    }
+    return event_queue;
+}
+
+int Appender::queuedEvents() const
+{
+    return event_queue ? event_queue->size() : 0;
 }
 
 bool Appender::configureLayout()
 {
     bool rc;
-    const std::string& layoutName       = layoutName_prop.rvalue();
-    const std::string& layoutPattern    = layoutPattern_prop.rvalue();
 
     rc = true;          // prove otherwise
-    if (appender && 
-        (!layoutName.empty()))
+    if (appender)
     {
-        // \todo layout factory??
-        if (0 == layoutName.compare("basic"))
-        {
-            appender->setLayout(new log4cpp::BasicLayout());
-        }
-        else if (0 == layoutName.compare("simple"))
-        {
-            appender->setLayout(new log4cpp::SimpleLayout());
-        }
-        else if (0 == layoutName.compare("pattern")) 
+        log4cpp::Layout* layout = 0;
+        rc = createLayout(layout);
+        if (layout)
         {
-            log4cpp::PatternLayout *layout = new log4cpp::PatternLayout();
-            /// \todo ensure "" != layoutPattern?
-            layout->setConversionPattern(layoutPattern);
-			appender->setLayout(layout);
+            appender->setLayout(layout);
             // the layout is now owned by the appender, and will be deleted
             // by it when the appender is destroyed
         }
-        else 
-        {
-            RTT::log(RTT::Error) << "Invalid layout '" << layoutName
-                       << "' in configuration for category: "
-                       << getName() << RTT::endlog();
-            rc = false;
-        }
     }
 
     return rc;
 }
+
+bool Appender::createLayout(log4cpp::Layout*& layout)
+{
+    const std::string& layoutName       = layoutName_prop.rvalue();
+    const std::string& layoutPattern    = layoutPattern_prop.rvalue();
+
+    layout = 0;
+    if (layoutName.empty())
+    {
+        return true;
+    }
+
+    // \todo layout factory??
+    if (0 == layoutName.compare("basic"))
+    {
+        layout = new log4cpp::BasicLayout();
+    }
+    else if (0 == layoutName.compare("simple"))
+    {
+        layout = new log4cpp::SimpleLayout();
+    }
+    else if (0 == layoutName.compare("pattern")) 
+    {
+        log4cpp::PatternLayout *patternLayout = new log4cpp::PatternLayout();
+        /// \todo ensure "" != layoutPattern?
+        patternLayout->setConversionPattern(layoutPattern);
+        layout = patternLayout;
+    }
+    else 
+    {
+        RTT::log(RTT::Error) << "Invalid layout '" << layoutName
+                   << "' in configuration for category: "
+                   << getName() << RTT::endlog();
+        return false;
+    }
+    return true;
+}
     
+bool Appender::createNativeLayout(OCL::logging::Layout*& layout)
+{
+    const std::string& layoutName       = layoutName_prop.rvalue();
+    const std::string& layoutPattern    = layoutPattern_prop.rvalue();
+
+    layout = OCL::logging::Layout::create(layoutName.empty() ? "basic" : layoutName,
+                                          layoutPattern);
+    if (0 == layout)
+    {
+        RTT::log(RTT::Error) << "Invalid layout '" << layoutName
+                   << "' or pattern '" << layoutPattern
+                   << "' in configuration for category: "
+                   << getName() << RTT::endlog();
+        return false;
+    }
+    return true;
+}
+
 bool Appender::startHook()
 {
     /// \todo input ports must be connected?
 //    return log_port.ready();  
 
+    resetStatistics();
     return true;
 }
 
@@ -79,7 +162,7 @@ void Appender::stopHook()
 	drainBuffer();
 
 	// introduce event to log diagnostics
-	if (0 != appender)
+	if (hasOutput())
 	{
 		/* place a "#" at the front of the message, for appenders that are
 		 reporting data for post-processing. These particular appenders
@@ -88,11 +171,12 @@ void Appender::stopHook()
 		*/
 		std::stringstream	ss;
 		ss << "# countMaxPopped=" << countMaxPopped;
-		log4cpp::LoggingEvent	event("OCL.logging.Appender",
-									  ss.str(),
-									  "",
-									  log4cpp::Priority::DEBUG);
-		appender->doAppend(event);
+		const std::string	message = ss.str();
+		OCL::logging::LoggingEvent	event(CategoryNames::intern("OCL.logging.Appender"),
+										  message.c_str(),
+										  message.size(),
+										  log4cpp::Priority::DEBUG);
+		appendEvent(event);
 	}
 }
 
@@ -103,38 +187,89 @@ void Appender::drainBuffer()
 
 void Appender::processEvents(int n)
 {
-    if (!log_port.connected()) return;      // no category connected to us
-	if (!appender) return;				// no appender!?
+    // no category connected to us
+    if (!log_port.connected() && !event_queue) return;
+	if (!hasOutput()) return;			// no appender!?
 
 	// check pre-conditions
 	if (0 > n) n = 1;
 
+    if (event_queue)
+    {
+        int depth = event_queue->size();
+        if (depth > queueHighWater_prop.rvalue())
+            queueHighWater_prop.set(depth);
+    }
+
     /* Consume waiting events until
        a) the buffer is empty
-       b) we consume enough events
+       b) we consume enough events, and the drain time budget is used up
 	*/
     OCL::logging::LoggingEvent	event;
+    PooledLoggingEvent*			pooled = 0;
 	bool 						again = false;
 	int							count = 0;
+    const double                budget = drainTimeBudget_prop.rvalue();
+    RTT::os::TimeService*       ts = RTT::os::TimeService::Instance();
+    RTT::os::TimeService::ticks start = ts->getTicks();
+    double                      worst = worstLatency_prop.rvalue();
 
 	do
 	{
-        if (log_port.read( event ) == RTT::NewData)
+        const OCL::logging::LoggingEvent* e;
+        if (event_queue && event_queue->dequeue( pooled ))
 		{
-			++count;
-
-			appender->doAppend( event.toLog4cpp() );
-
-			// Consume infinite events OR up to n events
-			again = (0 == n) || (count < n);
-			if ((0 != n) && (count == n)) ++countMaxPopped;
+            e = &pooled->event;
+		}
+        else if (log_port.connected() && (log_port.read( event ) == RTT::NewData))
+		{
+            e = &event;
+            pooled = 0;
 		}
 		else
 		{
 			break;      // nothing to do
 		}
+
+        double latency = (EventClock::now() - e->timeStamp) / 1e9;
+        if (latency > worst)
+            worst = latency;
+
+        appendEvent( *e );
+        if (pooled)
+            pooled->release();
+		++count;
+
+		// Consume infinite events OR up to n events, OR more within the budget
+		again = (0 == n) || (count < n) ||
+            ((0 < budget) && (ts->secondsSince(start) < budget));
+		if (!again) ++countMaxPopped;
 	}
 	while (again);
+
+    eventsPerCycle_prop.set(count);
+    worstLatency_prop.set(worst);
+    if (event_queue)
+    {
+        queueDepth_prop.set(event_queue->size());
+        droppedEvents_prop.set(event_queue->dropped());
+    }
+}
+
+void Appender::resetStatistics()
+{
+    queueHighWater_prop.set(0);
+    worstLatency_prop.set(0.0);
+}
+
+void Appender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    appender->doAppend( event.toLog4cpp() );
+}
+
+bool Appender::hasOutput() const
+{
+    return 0 != appender;
 }
 
 // namespaces
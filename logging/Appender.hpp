@@ -4,15 +4,20 @@
 #include <rtt/TaskContext.hpp>
 #include <rtt/Port.hpp>
 #include "LoggingEvent.hpp"
+#include "LoggingEventQueue.hpp"
 
 // forward declare
 namespace log4cpp {
 class Appender;
+class Layout;
 }
     
 namespace OCL {
 namespace logging {
 
+// forward declare
+class Layout;
+
 class Appender : public RTT::TaskContext
 {
 public:
@@ -25,6 +30,19 @@ public:
         successfully, otherwise false
     */
     virtual bool configureLayout();
+    /** Create a layout according to \a layoutName_prop and \a layoutPattern_prop.
+        \param layout Set to the new layout, which the caller owns, or to 0
+        if no layout name is given
+        \return false if the layout name is invalid, otherwise true
+    */
+    bool createLayout(log4cpp::Layout*& layout);
+    /** Create a native layout according to \a layoutName_prop and
+        \a layoutPattern_prop, for appenders which format events themselves.
+        \param layout Set to the new layout, which the caller owns. This is
+        a "basic" layout if no layout name is given, like log4cpp does.
+        \return false if the layout name or pattern is invalid, otherwise true
+    */
+    bool createNativeLayout(OCL::logging::Layout*& layout);
     /// ensure port is connected before we start
     virtual bool startHook();
 	/// Drain the buffer
@@ -34,18 +52,52 @@ public:
 	 */
 	virtual void drainBuffer();
 
+    /** Get the queue categories may send events to instead of using
+        \a log_port, creating it with \a queueCapacity_prop slots
+        if needed. The queue is owned by this appender, which detaches it
+        from all categories when destroyed.
+        \warning Not real-time capable
+    */
+    LoggingEventQueue* getEventQueue();
+
+    /** Approximate number of events in the event queue, 0 without one
+        \note Real-time capable and lock-free
+    */
+    int queuedEvents() const;
+
 protected:
 	/** Process up \a n events
         @param n if 0 ==n then process events until buffer is empty, otherwise
-        process at most n events
+        process at most n events, or more while events remain and the
+        \a drainTimeBudget_prop is not used up
         @pre 0 <= n (otherwise acts as though n==1)
      */
 	virtual void processEvents(int n);
 
+    /// Reset the statistics which hold a maximum
+    void resetStatistics();
+
+    /** Write \a event to the output.
+        The default implementation converts \a event for the log4cpp
+        \a appender. Appenders which write events themselves override
+        this and hasOutput().
+        @pre hasOutput()
+    */
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+
+    /// Return true if appendEvent() can be called, ie if there is a \a appender
+    virtual bool hasOutput() const;
+
     /// Port we receive logging events on
     /// Initially unconnected. The logging service connects appenders.
     RTT::InputPort<OCL::logging::LoggingEvent> log_port;
 
+    /// Queue we receive pooled logging events on, if the logging service
+    /// uses queues (see getEventQueue())
+    LoggingEventQueue*                              event_queue;
+    /// Number of events in \a event_queue
+    RTT::Property<int>                              queueCapacity_prop;
+
     /// Appender created by derived class
     log4cpp::Appender*                              appender;
 
@@ -55,6 +107,24 @@ protected:
     /// Layout conversion pattern (for those layouts that use a pattern)
     RTT::Property<std::string>                      layoutPattern_prop;
 
+    /** Time per cycle in seconds which processEvents() may use to process
+        more than its maximum number of events when a backlog builds up.
+        0 to not process more than the maximum.
+    */
+    RTT::Property<double>                           drainTimeBudget_prop;
+
+    // statistics, updated each cycle (read-only)
+    /// Events in the event queue after the last cycle
+    RTT::Property<int>                              queueDepth_prop;
+    /// Highest number of events found in the event queue at the start of a cycle
+    RTT::Property<int>                              queueHighWater_prop;
+    /// Events processed in the last cycle
+    RTT::Property<int>                              eventsPerCycle_prop;
+    /// Events for this appender dropped by categories as the queue or the pool was full
+    RTT::Property<int>                              droppedEvents_prop;
+    /// Highest time between logging an event and processing it, in seconds
+    RTT::Property<double>                           worstLatency_prop;
+
 	// diagnostic: count number of times popped max events
 	unsigned int countMaxPopped;
 };
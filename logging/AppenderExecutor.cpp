@@ -0,0 +1,203 @@
+#include "logging/AppenderExecutor.hpp"
+#include "logging/Appender.hpp"
+
+#include <rtt/Activity.hpp>
+#include <rtt/extras/SlaveActivity.hpp>
+#include <rtt/base/RunnableInterface.hpp>
+#include <rtt/os/Mutex.hpp>
+#include <rtt/os/MutexLock.hpp>
+#include <rtt/os/Atomic.hpp>
+#include <algorithm>
+
+namespace OCL {
+namespace logging {
+
+/** Executes the slave activities of its appenders, one round per cycle.
+
+    Loggers trigger the worker through the slaves, without locking, so the
+    worker and its activity are kept until the executor and all slaves
+    released them.
+*/
+class AppenderExecutor::Worker : public RTT::base::RunnableInterface
+{
+public:
+    Worker() : first(0), users(1) {}
+
+    virtual bool initialize() { return true; }
+    virtual void step();
+    virtual void finalize() {}
+
+    /// Add a user, which must call release()
+    void use()
+    {
+        users.inc();
+    }
+
+    /// Drop a user, and delete us and our activity with the last one
+    void release()
+    {
+        if (users.dec_and_test())
+        {
+            delete getActivity();
+            delete this;
+        }
+    }
+
+    /// Held while executing a slave, and while changing \a slaves
+    RTT::os::MutexRecursive     lock;
+    std::vector<Slave*>         slaves;
+    /// Slave to execute first in the next cycle
+    unsigned int                first;
+    /// The executor plus the attached slaves
+    RTT::os::AtomicInt          users;
+};
+
+/** The activity of an attached appender. Its trigger() wakes up the worker
+    instead, and stopping it waits until the worker is done executing it.
+*/
+class AppenderExecutor::Slave : public RTT::extras::SlaveActivity
+{
+public:
+    Slave(AppenderExecutor* executor, Worker* worker, Appender* appender) :
+            executor(executor), worker(worker), appender(appender)
+    {
+        worker->use();
+        RTT::os::MutexLock lock(worker->lock);
+        worker->slaves.push_back(this);
+    }
+
+    virtual ~Slave()
+    {
+        stop();
+        detach();
+    }
+
+    virtual bool stop()
+    {
+        if (worker)
+        {
+            RTT::os::MutexLock lock(worker->lock);
+            return RTT::extras::SlaveActivity::stop();
+        }
+        return RTT::extras::SlaveActivity::stop();
+    }
+
+    /** \note Real-time capable, does not lock as loggers call this. The
+        worker is kept until we detach, which the appender only does once
+        it is destroyed or gets another activity.
+    */
+    virtual bool trigger()
+    {
+        Worker* w = worker;
+        if (w)
+            return w->getActivity()->trigger();
+        return false;
+    }
+
+    /// Stop being executed by our worker, and release it
+    void detach()
+    {
+        Worker* w = worker;
+        if (w)
+        {
+            {
+                RTT::os::MutexLock lock(w->lock);
+                w->slaves.erase(std::remove(w->slaves.begin(),
+                                            w->slaves.end(), this),
+                                w->slaves.end());
+                worker = 0;
+            }
+            w->release();
+        }
+    }
+
+    /// The executor we belong to, 0 once it is destroyed
+    AppenderExecutor*   executor;
+    /// The worker executing us, 0 once detached
+    Worker* volatile    worker;
+    Appender*           appender;
+};
+
+void AppenderExecutor::Worker::step()
+{
+    RTT::os::MutexLock lock(this->lock);
+    const unsigned int n = slaves.size();
+    if (0 == n)
+        return;
+
+    bool backlog = false;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        Slave* slave = slaves[(first + i) % n];
+        if (slave->execute() && (0 < slave->appender->queuedEvents()))
+            backlog = true;
+    }
+    first = (first + 1) % n;
+
+    // rather than draining one appender here, give the others a turn
+    if (backlog)
+        getActivity()->trigger();
+}
+
+AppenderExecutor::AppenderExecutor(unsigned int threads, RTT::Seconds period, int priority) :
+        next(0)
+{
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        workers.push_back(new Worker());
+        // owned by the worker
+        RTT::Activity* activity = new RTT::Activity(priority ? ORO_SCHED_RT : ORO_SCHED_OTHER,
+                                                    priority,
+                                                    period,
+                                                    workers.back(),
+                                                    "AppenderExecutor");
+        activity->start();
+    }
+}
+
+AppenderExecutor::~AppenderExecutor()
+{
+    for (unsigned int i = 0; i < workers.size(); ++i)
+    {
+        Worker* worker = workers[i];
+        worker->getActivity()->stop();
+        {
+            // leave the remaining appenders with a slave activity nobody
+            // executes, whose triggers are ignored
+            RTT::os::MutexLock lock(worker->lock);
+            for (unsigned int j = 0; j < worker->slaves.size(); ++j)
+            {
+                worker->slaves[j]->executor = 0;
+            }
+        }
+        worker->release();
+    }
+}
+
+bool AppenderExecutor::attach(Appender* appender)
+{
+    Slave* slave = dynamic_cast<Slave*>(appender->getActivity());
+    if (slave && (this == slave->executor))
+        return true;
+    if (appender->isRunning() || workers.empty())
+        return false;
+
+    Worker* worker = workers[next];
+    slave = new Slave(this, worker, appender);
+    if (!appender->setActivity(slave))
+    {
+        delete slave;
+        return false;
+    }
+    next = (next + 1) % workers.size();
+    return true;
+}
+
+unsigned int AppenderExecutor::threads() const
+{
+    return workers.size();
+}
+
+// namespaces
+}
+}
@@ -0,0 +1,76 @@
+#ifndef	APPENDEREXECUTOR_HPP
+#define	APPENDEREXECUTOR_HPP 1
+
+#include <rtt/Time.hpp>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+// forward declare
+class Appender;
+
+/** A fixed number of threads shared by appenders, instead of one
+    activity per appender.
+
+    An attached appender gets a slave activity, which is executed by one
+    of the worker threads. The appenders are spread over the workers in
+    order of attachment. Each cycle, a worker executes all of its running
+    appenders once, starting with another one each cycle, so that no
+    appender is always served first. An appender processes at most its
+    MaxEventsPerCycle events per cycle, plus what fits in its
+    DrainTimeBudget, which is thus its share of the worker's time. When
+    an appender still has queued events after a cycle, the worker runs
+    another cycle right away.
+
+    Workers with a period are only woken up by their period, otherwise
+    they are woken up by each event of their appenders.
+*/
+class AppenderExecutor
+{
+public:
+    /** Create and start \a threads worker threads.
+        \param period Period of the workers, or 0 to run them when their
+        appenders receive events
+        \param priority Real-time priority of the workers, or 0 to use
+        ORO_SCHED_OTHER
+        \warning Not real-time capable
+    */
+    AppenderExecutor(unsigned int threads, RTT::Seconds period, int priority);
+    /** Stop the workers. Appenders which are still attached are no
+        longer executed. The workers are deleted once these appenders are
+        destroyed or get another activity, as loggers may still trigger
+        them.
+    */
+    ~AppenderExecutor();
+
+    /** Replace the activity of \a appender with one executed by a worker.
+        Does nothing if \a appender is already attached.
+        \return false if \a appender is running, as its activity can not
+        be replaced then
+        \warning Not real-time capable
+    */
+    bool attach(Appender* appender);
+
+    /// Number of worker threads
+    unsigned int threads() const;
+
+protected:
+    class Worker;
+    class Slave;
+
+    std::vector<Worker*>            workers;
+    /// Worker of the next attached appender
+    unsigned int                    next;
+
+private:
+    /* prevent copying and assignment */
+    AppenderExecutor(const AppenderExecutor& other);
+    AppenderExecutor& operator=(const AppenderExecutor& other);
+};
+
+// namespaces
+}
+}
+
+#endif
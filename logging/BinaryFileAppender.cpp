@@ -0,0 +1,95 @@
+#include "logging/BinaryFileAppender.hpp"
+#include "ocl/Component.hpp"
+#include <rtt/Logger.hpp>
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+BinaryFileAppender::BinaryFileAppender(std::string name) :
+		OCL::logging::Appender(name),
+        filename_prop("Filename", "Name of file to log to"),
+        maxEventsPerCycle_prop("MaxEventsPerCycle", "Maximum number of log events to pop per cycle",1),
+        maxEventsPerCycle(1)
+{
+    properties()->addProperty(filename_prop);
+    properties()->addProperty(maxEventsPerCycle_prop);
+}
+
+BinaryFileAppender::~BinaryFileAppender()
+{
+}
+
+bool BinaryFileAppender::configureHook()
+{
+    // verify valid limits
+    int m = maxEventsPerCycle_prop.rvalue();
+    if ((0 > m))
+    {
+        log(Error) << "Invalid maxEventsPerCycle value of "
+                   << m << ". Value must be >= 0."
+                   << endlog();
+        return false;
+    }
+    maxEventsPerCycle = m;
+
+    if (file.is_open())
+        file.close(); // in case the filename changed...
+
+    // a new file, as the names are only written once per file
+    file.open(filename_prop.rvalue().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        log(Error) << "Could not open file " << filename_prop.rvalue() << endlog();
+        return false;
+    }
+    BinaryLog::FileHeader header;
+    BinaryLog::initHeader(header);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    encoder.reset();
+
+    return true;
+}
+
+void BinaryFileAppender::updateHook()
+{
+	processEvents(maxEventsPerCycle);
+    flushBuffer();
+}
+
+void BinaryFileAppender::stopHook()
+{
+    Appender::stopHook();
+    flushBuffer();
+}
+
+void BinaryFileAppender::cleanupHook()
+{
+    file.close();
+}
+
+void BinaryFileAppender::flushBuffer()
+{
+    if (buffer.empty())
+        return;
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    buffer.clear();
+}
+
+void BinaryFileAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    encoder.encode(event, buffer);
+}
+
+bool BinaryFileAppender::hasOutput() const
+{
+    return file.is_open();
+}
+
+// namespaces
+}
+}
+
+ORO_LIST_COMPONENT_TYPE(OCL::logging::BinaryFileAppender)
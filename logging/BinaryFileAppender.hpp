@@ -0,0 +1,66 @@
+#ifndef	BINARYFILEAPPENDER_HPP
+#define	BINARYFILEAPPENDER_HPP 1
+
+#include "Appender.hpp"
+#include "BinaryLog.hpp"
+#include <rtt/Property.hpp>
+#include <fstream>
+
+namespace OCL {
+namespace logging {
+
+/** Appender writing events in the binary log format (see BinaryLog).
+    Events logged with a BinaryFormat are written without formatting them,
+    use ocl-logdecode to convert the file to text.
+    No layout is used.
+*/
+class BinaryFileAppender : public OCL::logging::Appender
+{
+public:
+	BinaryFileAppender(std::string name);
+	virtual ~BinaryFileAppender();
+protected:
+	/// Open the file
+    virtual bool configureHook();
+	/// Process at most \a maxEventsPerCycle event
+	virtual void updateHook();
+	/// Drain the buffer and write it out
+	virtual void stopHook();
+	/// Close the file
+	virtual void cleanupHook();
+
+    /// Write out the encoded events
+    void flushBuffer();
+
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Name of file to append to
+    RTT::Property<std::string>      filename_prop;
+    /**
+     * Property to set maximum number of log events to pop per cycle
+     */
+    RTT::Property<int>              maxEventsPerCycle_prop;
+
+    /**
+     * Maximum number of log events to pop per cycle
+     *
+     * Defaults to 1.
+     *
+     * A value of 0 indicates to not limit the number of events per cycle.
+     * With enough event production, this could lead to thread
+     * starvation!
+     */
+    int                             maxEventsPerCycle;
+
+    std::ofstream                   file;
+    BinaryLogEncoder                encoder;
+    /// Encoded events of this cycle
+    std::string                     buffer;
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -0,0 +1,283 @@
+#include "BinaryFormat.hpp"
+#include "InternTable.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+// never deleted, see CategoryNames
+InternTable& formats()
+{
+    static InternTable* table = new InternTable("<overflow>");
+    return *table;
+}
+
+/// A decoded argument
+struct Arg
+{
+    char                type;
+    long long           i;
+    unsigned long long  u;
+    double              d;
+    const char*         s;
+    std::size_t         length;
+};
+
+/// Reads the encoded arguments one by one
+class ArgReader
+{
+public:
+    ArgReader(const char* data, std::size_t size) : p(data), end(data + size) {}
+
+    bool next(Arg& a)
+    {
+        if (p == end)
+            return false;
+        a.type = *p++;
+        switch (a.type)
+        {
+        case BinaryFormat::BoolArg:     { bool v;               if (!get(&v, sizeof(v))) return false; a.i = v; break; }
+        case BinaryFormat::CharArg:     { char v;               if (!get(&v, sizeof(v))) return false; a.i = v; break; }
+        case BinaryFormat::Int32Arg:    { int v;                if (!get(&v, sizeof(v))) return false; a.i = v; break; }
+        case BinaryFormat::Int64Arg:    { long long v;          if (!get(&v, sizeof(v))) return false; a.i = v; break; }
+        case BinaryFormat::UInt32Arg:   { unsigned int v;       if (!get(&v, sizeof(v))) return false; a.u = v; break; }
+        case BinaryFormat::UInt64Arg:
+        case BinaryFormat::PointerArg:  { unsigned long long v; if (!get(&v, sizeof(v))) return false; a.u = v; break; }
+        case BinaryFormat::DoubleArg:   { double v;             if (!get(&v, sizeof(v))) return false; a.d = v; break; }
+        case BinaryFormat::StringArg:
+        {
+            unsigned short length;
+            if (!get(&length, sizeof(length)) || (std::size_t)(end - p) < length)
+                return false;
+            a.s      = p;
+            a.length = length;
+            p += length;
+            break;
+        }
+        default:
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool get(void* v, std::size_t size)
+    {
+        if ((std::size_t)(end - p) < size)
+            return false;
+        memcpy(v, p, size);
+        p += size;
+        return true;
+    }
+
+    const char* p;
+    const char* end;
+};
+
+/// Append \a value formatted with the printf \a spec
+template<class T>
+void append(std::string& out, const std::string& spec, T value)
+{
+    char buffer[128];
+    int n = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    if (n < 0)
+        return;
+    if ((std::size_t)n < sizeof(buffer))
+    {
+        out.append(buffer, n);
+    }
+    else
+    {
+        std::vector<char> large(n + 1);
+        snprintf(&large[0], large.size(), spec.c_str(), value);
+        out.append(&large[0], n);
+    }
+}
+
+/// Append \a a for the conversion \a conv, with flags, width and precision in \a spec
+void appendArg(std::string& out, std::string spec, char conv, const Arg& a)
+{
+    const bool floating = (0 != strchr("eEfFgGaA", conv));
+    switch (a.type)
+    {
+    case BinaryFormat::StringArg:
+        append(out, spec + "s", std::string(a.s, a.length).c_str());
+        break;
+    case BinaryFormat::DoubleArg:
+        append(out, spec + (floating ? conv : 'g'), a.d);
+        break;
+    case BinaryFormat::PointerArg:
+        append(out, spec + "p", reinterpret_cast<void*>((std::size_t)a.u));
+        break;
+    case BinaryFormat::BoolArg:
+        if ('s' == conv)
+        {
+            append(out, spec + "s", a.i ? "true" : "false");
+            break;
+        }
+        // fall through
+    case BinaryFormat::CharArg:
+        if (('c' == conv) || ('s' == conv))
+        {
+            append(out, spec + "c", (int)a.i);
+            break;
+        }
+        // fall through
+    case BinaryFormat::Int32Arg:
+    case BinaryFormat::Int64Arg:
+        if (floating)
+            append(out, spec + conv, (double)a.i);
+        else if (strchr("ouxX", conv))
+            append(out, spec + "ll" + conv, (unsigned long long)a.i);
+        else
+            append(out, spec + "lld", a.i);
+        break;
+    case BinaryFormat::UInt32Arg:
+    case BinaryFormat::UInt64Arg:
+        if (floating)
+            append(out, spec + conv, (double)a.u);
+        else if (strchr("ouxX", conv))
+            append(out, spec + "ll" + conv, a.u);
+        else if (strchr("di", conv))
+            append(out, spec + "lld", (long long)a.u);
+        else
+            append(out, spec + "llu", a.u);
+        break;
+    }
+}
+
+}
+
+BinaryFormat::BinaryFormat(const char* format) :
+        id(formats().intern(format))
+{
+}
+
+const char* BinaryFormat::getFormat() const
+{
+    return formats().get(id);
+}
+
+const char* BinaryFormat::getFormat(unsigned int id)
+{
+    return formats().get(id);
+}
+
+void BinaryFormat::format(const char* format,
+                          const char* args,
+                          std::size_t size,
+                          bool truncated,
+                          std::string& out)
+{
+    ArgReader   reader(args, size);
+    Arg         a;
+    for (const char* p = format; *p; ++p)
+    {
+        if ('%' != *p)
+        {
+            out += *p;
+            continue;
+        }
+        if ('%' == p[1])
+        {
+            out += '%';
+            ++p;
+            continue;
+        }
+
+        // flags, width and precision are kept, length modifiers dropped
+        std::string spec("%");
+        const char* q = p + 1;
+        while (*q && strchr("-+ #0", *q))
+            spec += *q++;
+        while (*q && (isdigit(*q) || ('.' == *q)))
+            spec += *q++;
+        while (*q && strchr("hlLqjzt", *q))
+            ++q;
+        if (!*q)
+        {
+            out.append(p);
+            break;
+        }
+        p = q;
+
+        if (!reader.next(a))
+        {
+            if (truncated)
+                break;      // the rest did not fit
+            out += "<?>";
+            continue;
+        }
+        appendArg(out, spec, *p, a);
+    }
+    if (truncated)
+        out += "...";
+}
+
+BinaryEncoder::BinaryEncoder(CategoryId categoryId,
+                             const BinaryFormat& format,
+                             log4cpp::Priority::Value priority) :
+        event(categoryId, "", 0, priority)
+{
+    event.formatId = format.getId();
+}
+
+BinaryEncoder& BinaryEncoder::operator<<(const char* v)
+{
+    return putString(v, strlen(v));
+}
+
+BinaryEncoder& BinaryEncoder::put(char type, const void* value, std::size_t size)
+{
+    // keep room for the '\0' which LoggingEvent copies along
+    if (!(event.truncated & LoggingEvent::MessageTruncated) &&
+        (event.messageLength + 1 + size < (std::size_t)LoggingEvent::MessageSize))
+    {
+        event.message[event.messageLength++] = type;
+        memcpy(&event.message[event.messageLength], value, size);
+        event.messageLength += size;
+    }
+    else
+    {
+        event.truncated |= LoggingEvent::MessageTruncated;
+    }
+    event.message[event.messageLength] = '\0';
+    return *this;
+}
+
+BinaryEncoder& BinaryEncoder::putString(const char* value, std::size_t size)
+{
+    const std::size_t header = 1 + sizeof(unsigned short);
+    if (event.truncated & LoggingEvent::MessageTruncated)
+        return *this;
+    if (event.messageLength + header + 1 >= (std::size_t)LoggingEvent::MessageSize)
+    {
+        event.truncated |= LoggingEvent::MessageTruncated;
+        return *this;
+    }
+
+    // strings are truncated to the room that is left
+    std::size_t room = LoggingEvent::MessageSize - 1 - header - event.messageLength;
+    if (size > room)
+    {
+        size = room;
+        event.truncated |= LoggingEvent::MessageTruncated;
+    }
+    unsigned short length = size;
+    event.message[event.messageLength++] = BinaryFormat::StringArg;
+    memcpy(&event.message[event.messageLength], &length, sizeof(length));
+    event.messageLength += sizeof(length);
+    memcpy(&event.message[event.messageLength], value, size);
+    event.messageLength += size;
+    event.message[event.messageLength] = '\0';
+    return *this;
+}
+
+// namespaces
+}
+}
@@ -0,0 +1,110 @@
+#ifndef	BINARYFORMAT_HPP
+#define	BINARYFORMAT_HPP 1
+
+#include "LoggingEvent.hpp"
+#include <string>
+
+namespace OCL {
+namespace logging {
+
+/** A printf-like format for deferred formatting of logging events.
+
+    Instead of formatting a message in the real-time thread, a category
+    stores the id of the format and the raw bytes of the arguments in the
+    event (see BinaryEncoder). The appender formats the message when it
+    writes out the event, or writes it out as is for later decoding.
+
+    A format is interned when it is constructed, so construct it once,
+    typically as a static:
+    \code
+    static const OCL::logging::BinaryFormat fmt("Joint %d at %.3f rad");
+    category->log(log4cpp::Priority::INFO, fmt, joint, position);
+    \endcode
+
+    The length modifiers in a conversion are ignored, as the type of each
+    argument is stored with its value. Arguments of another type than the
+    conversion expects are converted, eg a double for a "%d" is printed as
+    with "%g". Field widths and precisions given as '*' are not supported.
+*/
+class BinaryFormat
+{
+public:
+    /// Argument types, as stored in front of each argument
+    enum ArgType { Int32Arg = 'i', Int64Arg = 'I', UInt32Arg = 'u', UInt64Arg = 'U',
+                   DoubleArg = 'd', CharArg = 'c', BoolArg = 'b', StringArg = 's',
+                   PointerArg = 'p' };
+
+    /** Intern \a format
+        \warning Not real-time capable
+    */
+    explicit BinaryFormat(const char* format);
+
+    /// The id of this format, which is never 0
+    unsigned int getId() const { return id; }
+
+    const char* getFormat() const;
+
+    /** Get the format with \a id
+        \return the format, or "" for an unknown id
+        \note Real-time capable and lock-free
+    */
+    static const char* getFormat(unsigned int id);
+
+    /** Format the encoded arguments in \a args of \a size bytes
+        according to \a format, and append the result to \a out.
+        \param truncated Whether the arguments were truncated, in which
+        case "..." is appended.
+        \warning Not real-time capable
+    */
+    static void format(const char* format,
+                       const char* args,
+                       std::size_t size,
+                       bool truncated,
+                       std::string& out);
+
+private:
+    unsigned int id;
+};
+
+/** Encodes a binary event for a format and its arguments, without
+    allocating. Arguments which do not fit in the event are dropped and
+    the event is marked as truncated.
+*/
+class BinaryEncoder
+{
+public:
+    BinaryEncoder(CategoryId categoryId,
+                  const BinaryFormat& format,
+                  log4cpp::Priority::Value priority);
+
+    BinaryEncoder& operator<<(bool v)               { return put(BinaryFormat::BoolArg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(char v)               { return put(BinaryFormat::CharArg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(int v)                { return put(BinaryFormat::Int32Arg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(unsigned int v)       { return put(BinaryFormat::UInt32Arg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(long v)               { return *this << (long long)v; }
+    BinaryEncoder& operator<<(unsigned long v)      { return *this << (unsigned long long)v; }
+    BinaryEncoder& operator<<(long long v)          { return put(BinaryFormat::Int64Arg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(unsigned long long v) { return put(BinaryFormat::UInt64Arg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(double v)             { return put(BinaryFormat::DoubleArg, &v, sizeof(v)); }
+    BinaryEncoder& operator<<(const void* v)        { unsigned long long p = reinterpret_cast<std::size_t>(v);
+                                                      return put(BinaryFormat::PointerArg, &p, sizeof(p)); }
+    BinaryEncoder& operator<<(const char* v);
+    template<class Alloc>
+    BinaryEncoder& operator<<(const std::basic_string<char, std::char_traits<char>, Alloc>& v)
+    {
+        return putString(v.c_str(), v.size());
+    }
+
+    /// The encoded event
+    LoggingEvent    event;
+
+private:
+    BinaryEncoder& put(char type, const void* value, std::size_t size);
+    BinaryEncoder& putString(const char* value, std::size_t size);
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "BinaryLog.hpp"
+#include "BinaryFormat.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace OCL {
+namespace logging {
+
+namespace BinaryLog
+{
+    void initHeader(FileHeader& header)
+    {
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.version  = Version;
+        header.reserved = 0;
+    }
+
+    bool checkHeader(const FileHeader& header)
+    {
+        return (0 == memcmp(header.magic, Magic, sizeof(Magic))) &&
+            (Version == header.version);
+    }
+}
+
+BinaryLogEncoder::BinaryLogEncoder()
+{
+}
+
+void BinaryLogEncoder::reset()
+{
+    categories.clear();
+    formats.clear();
+}
+
+void BinaryLogEncoder::encodeName(char type, unsigned int id, const char* name, std::string& out)
+{
+    BinaryLog::NameHeader header;
+    header.id       = id;
+    header.length   = strlen(name);
+    out += type;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(name, header.length);
+}
+
+void BinaryLogEncoder::encode(const LoggingEvent& event, std::string& out)
+{
+    if (categories.size() <= event.categoryId)
+        categories.resize(event.categoryId + 1, false);
+    if (!categories[event.categoryId])
+    {
+        encodeName(BinaryLog::CategoryRecord, event.categoryId, event.getCategoryName(), out);
+        categories[event.categoryId] = true;
+    }
+    if (0 != event.formatId)
+    {
+        if (formats.size() <= event.formatId)
+            formats.resize(event.formatId + 1, false);
+        if (!formats[event.formatId])
+        {
+            encodeName(BinaryLog::FormatRecord, event.formatId,
+                       BinaryFormat::getFormat(event.formatId), out);
+            formats[event.formatId] = true;
+        }
+    }
+
+    boost::int64_t  seconds;
+    int             microseconds;
+    EventClock::toWallTime(event.timeStamp, seconds, microseconds);
+    const char*     threadName = event.getThreadName();
+
+    BinaryLog::EventHeader header;
+    header.seconds      = seconds;
+    header.microseconds = microseconds;
+    header.priority     = event.priority;
+    header.category     = event.categoryId;
+    header.format       = event.formatId;
+    header.length       = event.messageLength;
+    header.truncated    = event.truncated;
+    header.threadLength = std::min<std::size_t>(strlen(threadName), 255);
+    out += (char)BinaryLog::EventRecord;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(threadName, header.threadLength);
+    out.append(event.message, header.length);
+}
+
+void DecodedEvent::toText(std::string& out) const
+{
+    char        buffer[64];
+    time_t      t = seconds;
+    struct tm   tm;
+    localtime_r(&t, &tm);
+    std::size_t n = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf(buffer + n, sizeof(buffer) - n, ",%03d", microseconds / 1000);
+    out += buffer;
+    out += " [";
+    out += thread;
+    out += "] ";
+    snprintf(buffer, sizeof(buffer), "%-5s ", log4cpp::Priority::getPriorityName(priority).c_str());
+    out += buffer;
+    out += category;
+    out += " - ";
+    out += message;
+    out += '\n';
+}
+
+int BinaryLogDecoder::decode(const char* data, std::size_t size, bool& isEvent, DecodedEvent& event)
+{
+    isEvent = false;
+    if (size < 1)
+        return 0;
+
+    const char type = data[0];
+    if ((BinaryLog::CategoryRecord == type) || (BinaryLog::FormatRecord == type))
+    {
+        BinaryLog::NameHeader header;
+        if (size < 1 + sizeof(header))
+            return 0;
+        memcpy(&header, data + 1, sizeof(header));
+        std::size_t total = 1 + sizeof(header) + header.length;
+        if (size < total)
+            return 0;
+        std::string name(data + 1 + sizeof(header), header.length);
+        if (BinaryLog::CategoryRecord == type)
+            categories[header.id] = name;
+        else
+            formats[header.id] = name;
+        return total;
+    }
+
+    if (BinaryLog::EventRecord == type)
+    {
+        BinaryLog::EventHeader header;
+        if (size < 1 + sizeof(header))
+            return 0;
+        memcpy(&header, data + 1, sizeof(header));
+        std::size_t total = 1 + sizeof(header) + header.threadLength + header.length;
+        if (size < total)
+            return 0;
+        const char* thread  = data + 1 + sizeof(header);
+        const char* message = thread + header.threadLength;
+
+        event.seconds       = header.seconds;
+        event.microseconds  = header.microseconds;
+        event.priority      = header.priority;
+        event.category      = categories[header.category];
+        event.thread.assign(thread, header.threadLength);
+        event.message.clear();
+        const bool truncated = 0 != (header.truncated & LoggingEvent::MessageTruncated);
+        if (0 != header.format)
+        {
+            BinaryFormat::format(formats[header.format].c_str(), message, header.length,
+                                 truncated, event.message);
+        }
+        else
+        {
+            event.message.assign(message, header.length);
+            if (truncated)
+                event.message += "...";
+        }
+        isEvent = true;
+        return total;
+    }
+
+    return -1;
+}
+
+// namespaces
+}
+}
@@ -0,0 +1,121 @@
+#ifndef	BINARYLOG_HPP
+#define	BINARYLOG_HPP 1
+
+#include "LoggingEvent.hpp"
+#include <boost/cstdint.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+/** The binary log format, as written by the BinaryFileAppender and read
+    by ocl-logdecode. All values are in host byte order.
+
+    A log file starts with a FileHeader, followed by records. Each record
+    starts with its RecordType:
+    - CategoryRecord and FormatRecord: a NameHeader followed by the name.
+      The name of a category or format id is written once per file,
+      before the first event which refers to it.
+    - EventRecord: an EventHeader, the thread name and the message, which
+      are the encoded arguments of the event's format if it is not 0.
+*/
+namespace BinaryLog
+{
+    const char Magic[8] = { 'O', 'C', 'L', 'B', 'L', 'O', 'G', '1' };
+    const boost::uint32_t Version = 1;
+
+    struct FileHeader
+    {
+        char            magic[8];
+        boost::uint32_t version;
+        boost::uint32_t reserved;
+    };
+
+    enum RecordType { CategoryRecord = 'C', FormatRecord = 'F', EventRecord = 'E' };
+
+    struct NameHeader
+    {
+        boost::uint32_t id;
+        boost::uint32_t length;
+    };
+
+    struct EventHeader
+    {
+        boost::int64_t  seconds;
+        boost::int32_t  microseconds;
+        boost::int32_t  priority;
+        boost::uint32_t category;
+        boost::uint32_t format;
+        boost::uint16_t length;
+        boost::uint8_t  truncated;
+        boost::uint8_t  threadLength;
+    };
+
+    /// Fill in a file header
+    void initHeader(FileHeader& header);
+
+    /// Check the magic and version of a file header
+    bool checkHeader(const FileHeader& header);
+}
+
+/** Encodes events in the binary log format, preceded by the names
+    they refer to which were not encoded yet.
+*/
+class BinaryLogEncoder
+{
+public:
+    BinaryLogEncoder();
+
+    /// Forget which names were encoded, eg when starting a new file
+    void reset();
+
+    /// Append \a event and the names it refers to, to \a out
+    void encode(const LoggingEvent& event, std::string& out);
+
+protected:
+    void encodeName(char type, unsigned int id, const char* name, std::string& out);
+
+    /// Which category and format ids were encoded
+    std::vector<bool>   categories;
+    std::vector<bool>   formats;
+};
+
+/// An event decoded from the binary log format
+struct DecodedEvent
+{
+    boost::int64_t              seconds;
+    int                         microseconds;
+    log4cpp::Priority::Value    priority;
+    std::string                 category;
+    std::string                 thread;
+    std::string                 message;
+
+    /// Append as "date time,ms [thread] priority category - message\n"
+    void toText(std::string& out) const;
+};
+
+/** Decodes records in the binary log format.
+*/
+class BinaryLogDecoder
+{
+public:
+    /** Decode the record at \a data of at most \a size bytes.
+        \param isEvent set to true if the record was an event, which
+        is then stored in \a event
+        \return the size of the record, or 0 if \a size is too small
+        to hold it, or -1 if it is not a valid record
+    */
+    int decode(const char* data, std::size_t size, bool& isEvent, DecodedEvent& event);
+
+protected:
+    std::map<unsigned int, std::string> categories;
+    std::map<unsigned int, std::string> formats;
+};
+
+// namespaces
+}
+}
+
+#endif
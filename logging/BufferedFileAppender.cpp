@@ -0,0 +1,246 @@
+#include "logging/BufferedFileAppender.hpp"
+#include "logging/Layout.hpp"
+#include "ocl/Component.hpp"
+#include <rtt/Logger.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+BufferedFileAppender::BufferedFileAppender(std::string name) :
+		OCL::logging::Appender(name),
+        filename_prop("Filename", "Name of file to log to"),
+        maxEventsPerCycle_prop("MaxEventsPerCycle", "Maximum number of log events to pop per cycle (0 for all)", 0),
+        bufferSize_prop("BufferSize", "Size of the write buffer in bytes", 65536),
+        flushInterval_prop("FlushInterval", "Minimum time between writes of a buffer which is not full, in seconds (0 for every cycle)", 0.1),
+        maxLatency_prop("MaxLatency", "Maximum time between logging an event and writing it, in seconds (0 to not check)", 0.0),
+        syncPolicy_prop("SyncPolicy", "When to sync the file to disk: 'none', 'write' or 'interval'", "none"),
+        syncInterval_prop("SyncInterval", "Time between syncs for the 'interval' policy, in seconds", 1.0),
+        bytesPerSecond_prop("BytesPerSecond", "Bytes written per second, over the last second (read-only)", 0.0),
+        eventsPerSecond_prop("EventsPerSecond", "Events written per second, over the last second (read-only)", 0.0),
+        maxEventsPerCycle(0),
+        syncPolicy(SyncNone),
+        fd(-1),
+        layout(0),
+        bufferSize(0),
+        oldestEvent(0),
+        lastWrite(0),
+        lastSync(0),
+        rateStart(0),
+        bytesWritten(0),
+        eventsWritten(0),
+        bufferedEvents(0)
+{
+    properties()->addProperty(filename_prop);
+    properties()->addProperty(maxEventsPerCycle_prop);
+    properties()->addProperty(bufferSize_prop);
+    properties()->addProperty(flushInterval_prop);
+    properties()->addProperty(maxLatency_prop);
+    properties()->addProperty(syncPolicy_prop);
+    properties()->addProperty(syncInterval_prop);
+    properties()->addProperty(bytesPerSecond_prop);
+    properties()->addProperty(eventsPerSecond_prop);
+}
+
+BufferedFileAppender::~BufferedFileAppender()
+{
+    cleanupHook();
+}
+
+bool BufferedFileAppender::configureHook()
+{
+    // verify valid limits
+    int m = maxEventsPerCycle_prop.rvalue();
+    if ((0 > m))
+    {
+        log(Error) << "Invalid maxEventsPerCycle value of "
+                   << m << ". Value must be >= 0."
+                   << endlog();
+        return false;
+    }
+    int size = bufferSize_prop.rvalue();
+    if ((0 >= size))
+    {
+        log(Error) << "Invalid BufferSize value of "
+                   << size << ". Value must be > 0."
+                   << endlog();
+        return false;
+    }
+    const std::string& policy = syncPolicy_prop.rvalue();
+    SyncPolicy p;
+    if (0 == policy.compare("none"))
+        p = SyncNone;
+    else if (0 == policy.compare("write"))
+        p = SyncWrite;
+    else if (0 == policy.compare("interval"))
+        p = SyncInterval;
+    else
+    {
+        log(Error) << "Invalid SyncPolicy '" << policy
+                   << "'. Value must be 'none', 'write' or 'interval'."
+                   << endlog();
+        return false;
+    }
+
+    OCL::logging::Layout* l = 0;
+    if (!createNativeLayout(l))
+        return false;
+
+    // in case the filename changed...
+    cleanupHook();
+
+    fd = ::open(filename_prop.rvalue().c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (-1 == fd)
+    {
+        log(Error) << "Could not open file " << filename_prop.rvalue()
+                   << ": " << strerror(errno) << endlog();
+        delete l;
+        return false;
+    }
+
+    maxEventsPerCycle   = m;
+    syncPolicy          = p;
+    layout              = l;
+    bufferSize          = size;
+    // the buffer never grows beyond this, unless a single event is larger
+    buffer.reserve(bufferSize);
+    return true;
+}
+
+bool BufferedFileAppender::startHook()
+{
+    os::TimeService* ts = os::TimeService::Instance();
+    lastWrite       = ts->getTicks();
+    lastSync        = lastWrite;
+    rateStart       = lastWrite;
+    bytesWritten    = 0;
+    eventsWritten   = 0;
+    return Appender::startHook();
+}
+
+void BufferedFileAppender::updateHook()
+{
+	processEvents(maxEventsPerCycle);
+
+    os::TimeService* ts = os::TimeService::Instance();
+    if (!buffer.empty())
+    {
+        bool write = ts->secondsSince(lastWrite) >= flushInterval_prop.rvalue();
+        const double maxLatency = maxLatency_prop.rvalue();
+        if (!write && (0 < maxLatency))
+        {
+            write = (EventClock::now() - oldestEvent) / 1e9 >= maxLatency;
+        }
+        if (write)
+            writeBuffer(SyncWrite == syncPolicy);
+    }
+    if ((SyncInterval == syncPolicy) && (ts->secondsSince(lastSync) >= syncInterval_prop.rvalue()))
+    {
+        ::fsync(fd);
+        lastSync = ts->getTicks();
+    }
+    updateRates();
+}
+
+void BufferedFileAppender::stopHook()
+{
+    Appender::stopHook();
+    writeBuffer(SyncNone != syncPolicy);
+    updateRates();
+}
+
+void BufferedFileAppender::cleanupHook()
+{
+    if (-1 != fd)
+    {
+        writeBuffer(SyncNone != syncPolicy);
+        ::close(fd);
+        fd = -1;
+    }
+    delete layout;
+    layout = 0;
+}
+
+void BufferedFileAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    if (buffer.empty())
+    {
+        oldestEvent = event.timeStamp;
+    }
+    layout->format(event, buffer);
+    ++bufferedEvents;
+    if (buffer.size() >= bufferSize)
+    {
+        writeBuffer(SyncWrite == syncPolicy);
+    }
+}
+
+bool BufferedFileAppender::hasOutput() const
+{
+    return -1 != fd;
+}
+
+void BufferedFileAppender::writeBuffer(bool sync)
+{
+    if (buffer.empty() || (-1 == fd))
+        return;
+
+    const char*             data = buffer.data();
+    std::string::size_type  left = buffer.size();
+    while (0 < left)
+    {
+        ssize_t n = ::write(fd, data, left);
+        if (0 > n)
+        {
+            if (EINTR == errno)
+                continue;
+            log(Error) << "Could not write to file " << filename_prop.rvalue()
+                       << ": " << strerror(errno) << ", dropped "
+                       << bufferedEvents << " events" << endlog();
+            break;
+        }
+        data += n;
+        left -= n;
+    }
+    if (0 == left)
+    {
+        bytesWritten    += buffer.size();
+        eventsWritten   += bufferedEvents;
+    }
+    buffer.clear();
+    bufferedEvents = 0;
+
+    os::TimeService* ts = os::TimeService::Instance();
+    lastWrite = ts->getTicks();
+    if (sync)
+    {
+        ::fsync(fd);
+        lastSync = lastWrite;
+    }
+}
+
+void BufferedFileAppender::updateRates()
+{
+    os::TimeService* ts = os::TimeService::Instance();
+    const os::TimeService::Seconds elapsed = ts->secondsSince(rateStart);
+    if (elapsed >= 1.0)
+    {
+        bytesPerSecond_prop.set(bytesWritten / elapsed);
+        eventsPerSecond_prop.set(eventsWritten / elapsed);
+        rateStart       = ts->getTicks();
+        bytesWritten    = 0;
+        eventsWritten   = 0;
+    }
+}
+
+// namespaces
+}
+}
+
+ORO_LIST_COMPONENT_TYPE(OCL::logging::BufferedFileAppender)
@@ -0,0 +1,105 @@
+#ifndef	BUFFEREDFILEAPPENDER_HPP
+#define	BUFFEREDFILEAPPENDER_HPP 1
+
+#include "Appender.hpp"
+#include <rtt/Property.hpp>
+#include <rtt/os/TimeService.hpp>
+
+namespace OCL {
+namespace logging {
+
+/** File appender which formats the events of a cycle into one buffer and
+    writes the buffer with a single system call, instead of writing each
+    event with its own call as the FileAppender does.
+
+    The buffer is written when it is full, at most every \a FlushInterval
+    seconds otherwise, and as soon as its oldest event was logged more than
+    \a MaxLatency seconds ago. These checks are done in updateHook(), so run
+    this appender with a periodic activity when using intervals or latencies.
+    \a SyncPolicy determines when the file is synced to disk: "none" (leave it
+    to the OS), "write" (after each write) or "interval" (every
+    \a SyncInterval seconds).
+
+    Events are formatted with a native layout (see Layout). Without a
+    layout name the "basic" layout is used, like the log4cpp file appender
+    does.
+*/
+class BufferedFileAppender : public OCL::logging::Appender
+{
+public:
+	BufferedFileAppender(std::string name);
+	virtual ~BufferedFileAppender();
+protected:
+	/// Open the file and create the layout
+    virtual bool configureHook();
+    /// Reset the statistics
+    virtual bool startHook();
+	/// Process at most \a maxEventsPerCycle events, and write as needed
+	virtual void updateHook();
+	/// Drain the buffer and write it out
+	virtual void stopHook();
+	/// Close the file
+	virtual void cleanupHook();
+
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Write out the buffer, and sync the file if \a sync
+    void writeBuffer(bool sync);
+    /// Update the statistics of the last second
+    void updateRates();
+
+    enum SyncPolicy { SyncNone, SyncWrite, SyncInterval };
+
+    /// Name of file to append to
+    RTT::Property<std::string>      filename_prop;
+    /**
+     * Property to set maximum number of log events to pop per cycle
+     */
+    RTT::Property<int>              maxEventsPerCycle_prop;
+    /// Size of the buffer in bytes
+    RTT::Property<int>              bufferSize_prop;
+    RTT::Property<double>           flushInterval_prop;
+    RTT::Property<double>           maxLatency_prop;
+    RTT::Property<std::string>      syncPolicy_prop;
+    RTT::Property<double>           syncInterval_prop;
+    /// Statistics of the last second (read-only)
+    RTT::Property<double>           bytesPerSecond_prop;
+    RTT::Property<double>           eventsPerSecond_prop;
+
+    /**
+     * Maximum number of log events to pop per cycle
+     *
+     * Defaults to 0, as events are written per batch anyway.
+     *
+     * A value of 0 indicates to not limit the number of events per cycle.
+     * With enough event production, this could lead to thread
+     * starvation!
+     */
+    int                             maxEventsPerCycle;
+    SyncPolicy                      syncPolicy;
+
+    /// File descriptor, or -1 if not open
+    int                             fd;
+    OCL::logging::Layout*           layout;
+    /// Formatted events which are not written yet
+    std::string                     buffer;
+    std::string::size_type          bufferSize;
+    /// Time stamp of the oldest event in \a buffer
+    EventClock::Nanoseconds         oldestEvent;
+
+    RTT::os::TimeService::ticks     lastWrite;
+    RTT::os::TimeService::ticks     lastSync;
+    /// Start of the current statistics period, and what was written since
+    RTT::os::TimeService::ticks     rateStart;
+    unsigned long                   bytesWritten;
+    unsigned long                   eventsWritten;
+    /// Number of events in \a buffer
+    unsigned long                   bufferedEvents;
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -1,24 +1,70 @@
 #include "logging/Category.hpp"
+#include "logging/LoggingEventQueue.hpp"
 #include <rtt/Logger.hpp>
 #include <rtt/ConnPolicy.hpp>
+#include <rtt/os/CAS.hpp>
+#include <rtt/os/Mutex.hpp>
+#include <rtt/os/MutexLock.hpp>
+#include <rtt/os/fosi.h>
 #include <log4cpp/NDC.hh>
 #include <log4cpp/HierarchyMaintainer.hh>
+#include <algorithm>
 
 using namespace RTT;
 
 namespace OCL {
 namespace logging {
 
+namespace {
+
+// Serializes building and replacing fan-out tables. Never deleted, as
+// categories may be created during static initialization and destruction
+// (see CategoryNames).
+RTT::os::Mutex& fanOutLock()
+{
+    static RTT::os::Mutex* lock = new RTT::os::Mutex();
+    return *lock;
+}
+
+/// Add \a value to \a counter atomically
+void atomicAdd(volatile int& counter, int value)
+{
+    int old;
+    do
+    {
+        old = counter;
+    }
+    while (!RTT::os::CAS(&counter, old, old + value));
+}
+
+const BinaryFormat duplicatesFormat("%d similar messages suppressed");
+const BinaryFormat limitedFormat("%d messages suppressed by the rate limit");
+
+}
+
+volatile int Category::priority_generation = 0;
+volatile int Category::fanout_epoch = 0;
+volatile int Category::fanout_readers[2] = { 0, 0 };
+
 Category::Category(const std::string& name,
                    log4cpp::Category* parent,
                    log4cpp::Priority::Value priority) :
         log4cpp::Category(name, parent, priority),
-        log_port( convertName(name) , false )
+        log_port( convertName(name) , false ),
+        category_id( CategoryNames::intern(name) ),
+        event_pool(0),
+        fanout(0),
+        filter(new CategoryFilter())
 {
+    // start with the destinations of our parents
+    RTT::os::MutexLock lock(fanOutLock());
+    fanout = buildFanOut();
 }
 
 Category::~Category()
 {
+    delete fanout;
+    delete filter;
 }
 
 void Category::log(log4cpp::Priority::Value priority,
@@ -30,6 +76,16 @@ void Category::log(log4cpp::Priority::Value priority,
     }
 }
 
+void Category::log(log4cpp::Priority::Value priority,
+                   const BinaryFormat& format) throw()
+{
+    if (isPriorityEnabled(priority) && admitFormat(priority, format))
+    {
+        BinaryEncoder encoder(category_id, format, priority);
+        callAppenders(encoder.event);
+    }
+}
+
 void Category::debug(const RTT::rt_string& message) throw()
 {
     if (isPriorityEnabled(log4cpp::Priority::DEBUG))
@@ -88,37 +144,320 @@ void Category::fatal(const RTT::rt_string& message) throw()
 void Category::_logUnconditionally2(log4cpp::Priority::Value priority,
                                     const RTT::rt_string& message) throw()
 {
-    try
+    if (!admitMessage(priority, message.c_str(), message.size()))
+    {
+        return;
+    }
+    // NDC's are not real-time
+    OCL::logging::LoggingEvent event(category_id,
+                                     message.c_str(),
+                                     message.size(),
+                                     priority);
+    callAppenders(event);
+}
+
+void Category::logStream(log4cpp::Priority::Value priority,
+                         const char* message,
+                         std::size_t length,
+                         bool truncated) throw()
+{
+    if (!admitMessage(priority, message, length))
+    {
+        return;
+    }
+    OCL::logging::LoggingEvent event(category_id,
+                                     message,
+                                     length,
+                                     priority);
+    if (truncated)
     {
-        OCL::logging::LoggingEvent event(RTT::rt_string(getName().c_str()),
-                                         RTT::rt_string(message.c_str()),
-                                         // NDC's are not real-time
-//                                     RTT::rt_string(log4cpp::NDC::get().c_str()),
-                                         RTT::rt_string(""),
-                                         priority);
-        callAppenders(event);
+        event.truncated |= LoggingEvent::MessageTruncated;
     }
-    catch (std::bad_alloc& e)
+    callAppenders(event);
+}
+
+bool Category::admit(log4cpp::Priority::Value priority, unsigned int key) throw()
+{
+    CategoryFilter::Summary summary;
+    const bool pass = filter->admit(priority, key, summary);
+    logSummary(summary);
+    return pass;
+}
+
+void Category::flushFilter()
+{
+    CategoryFilter::Summary summary;
+    if (filter->flush(summary))
     {
-        // \todo do what?
-//        std::cerr << "Failed to log event: out of real-time memory" << std::endl;
-        /// \todo ++numFailedLog
+        logSummary(summary);
+    }
+}
+
+void Category::logSummary(const CategoryFilter::Summary& summary) throw()
+{
+    if (0 != summary.duplicates)
+    {
+        BinaryEncoder encoder(category_id, duplicatesFormat, summary.priority);
+        encoder << summary.duplicates;
+        callAppenders(encoder.event);
+    }
+    if (0 != summary.limited)
+    {
+        BinaryEncoder encoder(category_id, limitedFormat, summary.priority);
+        encoder << summary.limited;
+        callAppenders(encoder.event);
     }
 }
 
 void Category::callAppenders(const OCL::logging::LoggingEvent& event) throw()
 {
-    log_port.write( event );
+    // count us as a reader of the current epoch, so that reclaimFanOut()
+    // keeps the table we use
+    int epoch;
+    for (;;)
+    {
+        epoch = fanout_epoch;
+        atomicAdd(fanout_readers[epoch & 1], 1);
+        if (epoch == fanout_epoch)
+        {
+            break;
+        }
+        atomicAdd(fanout_readers[epoch & 1], -1);
+    }
+    const FanOut* table = fanout;
+    callAppenderQueues(*table, event);
+    callAppenderPorts(*table, event);
+    atomicAdd(fanout_readers[epoch & 1], -1);
+}
+
+void Category::callAppenderQueues(const FanOut& table,
+                                  const OCL::logging::LoggingEvent& event) throw()
+{
+    // every queue holds a reference to the event
+    const unsigned int targets = table.queues.size();
+    if ((0 == targets) || (0 == table.pool))
+    {
+        return;
+    }
+
+    std::vector<LoggingEventQueue*>::const_iterator it;
+    PooledLoggingEvent* pooled = table.pool->allocate(event, targets);
+    if (0 == pooled)
+    {
+        // pool exhausted, so every queue misses this event
+        for (it = table.queues.begin(); it != table.queues.end(); ++it)
+        {
+            (*it)->drop();
+        }
+        return;
+    }
+
+    for (it = table.queues.begin(); it != table.queues.end(); ++it)
+    {
+        if (!(*it)->enqueue(pooled))
+        {
+            pooled->release();
+        }
+    }
+}
+
+void Category::callAppenderPorts(const FanOut& table,
+                                 const OCL::logging::LoggingEvent& event) throw()
+{
+    std::vector<RTT::OutputPort<OCL::logging::LoggingEvent>*>::const_iterator it;
+    for (it = table.ports.begin(); it != table.ports.end(); ++it)
+    {
+        if ((*it)->connected())
+        {
+            (*it)->write( event );
+        }
+    }
+}
 
-    // let our parent categories append (if they want to)
+Category* Category::getAdditiveParent()
+{
     if (getAdditivity() && (getParent() != NULL))
     {
-        OCL::logging::Category* parent = dynamic_cast<OCL::logging::Category*>(getParent());
-        if (parent)
+        return dynamic_cast<OCL::logging::Category*>(getParent());
+        // we don't use non-realtime parent Category's!
+    }
+    return 0;
+}
+
+void Category::addEventQueue(LoggingEventQueue* queue, LoggingEventPool* pool)
+{
+    RTT::os::MutexLock lock(fanOutLock());
+    event_queues.push_back(queue);
+    event_pool = pool;
+}
+
+void Category::clearEventQueues()
+{
+    RTT::os::MutexLock lock(fanOutLock());
+    event_queues.clear();
+    event_pool = 0;
+}
+
+CategoryFilter& Category::getFilter()
+{
+    return *filter;
+}
+
+void Category::setPriority(log4cpp::Priority::Value priority)
+    throw(std::invalid_argument)
+{
+    log4cpp::Category::setPriority(priority);
+    int old;
+    do
+    {
+        old = priority_generation;
+    }
+    while (!RTT::os::CAS(&priority_generation, old, old + 1));
+}
+
+void Category::setAdditivity(bool additivity)
+{
+    log4cpp::Category::setAdditivity(additivity);
+    updateFanOut();
+}
+
+Category::FanOut::~FanOut()
+{
+    if (pool)
+    {
+        pool->release();
+    }
+}
+
+Category::FanOut* Category::buildFanOut()
+{
+    FanOut* table = new FanOut();
+    // we don't use non-realtime parent Category's!
+    for (Category* c = this; c != 0; c = c->getAdditiveParent())
+    {
+        table->queues.insert(table->queues.end(),
+                             c->event_queues.begin(), c->event_queues.end());
+        table->ports.push_back(&c->log_port);
+        if ((0 == table->pool) && (0 != c->event_pool))
+        {
+            table->pool = c->event_pool;
+            table->pool->use();
+        }
+    }
+    return table;
+}
+
+void Category::setFanOut(FanOut* table)
+{
+    FanOut* old = fanout;
+    while (!RTT::os::CAS(&fanout, old, table))
+    {
+        old = fanout;
+    }
+    old->epoch = fanout_epoch;
+    retiredFanOut().push_back(old);
+}
+
+std::vector<Category::FanOut*>& Category::retiredFanOut()
+{
+    // never deleted, see fanOutLock()
+    static std::vector<FanOut*>* retired = new std::vector<FanOut*>();
+    return *retired;
+}
+
+void Category::updateFanOut()
+{
+    std::vector<log4cpp::Category*>* categories =
+        log4cpp::Category::getCurrentCategories();
+    RTT::os::MutexLock lock(fanOutLock());
+    reclaimFanOut();
+    std::vector<log4cpp::Category*>::iterator iter;
+    for (iter = categories->begin(); iter != categories->end(); ++iter)
+    {
+        OCL::logging::Category* category = dynamic_cast<OCL::logging::Category*>(*iter);
+        if (category)
+            category->setFanOut(category->buildFanOut());
+    }
+    delete categories;
+}
+
+void Category::reclaimFanOut()
+{
+    /* Readers of the current epoch may use any table retired in it, but
+       a reader which started in the current epoch loaded the table after
+       every table of older epochs was replaced. So once no reader of the
+       previous epoch is left, the tables retired before the current epoch
+       are unused. Readers of older epochs left before the epoch was
+       advanced the last time, as this is only done without readers of
+       the previous epoch, whose counter the next epoch reuses.
+     */
+    const int epoch = fanout_epoch;
+    if (0 != fanout_readers[(epoch + 1) & 1])
+    {
+        return;     // try again with the next update
+    }
+    std::vector<FanOut*>& retired = retiredFanOut();
+    std::vector<FanOut*>::iterator iter = retired.begin();
+    while (iter != retired.end())
+    {
+        if ((*iter)->epoch != epoch)
+        {
+            delete *iter;
+            iter = retired.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    RTT::os::CAS(&fanout_epoch, epoch, epoch + 1);
+}
+
+void Category::removeEventQueue(LoggingEventQueue* queue)
+{
+    std::vector<log4cpp::Category*>* categories =
+        log4cpp::Category::getCurrentCategories();
+    {
+        RTT::os::MutexLock lock(fanOutLock());
+        std::vector<log4cpp::Category*>::iterator iter;
+        for (iter = categories->begin(); iter != categories->end(); ++iter)
+        {
+            OCL::logging::Category* category = dynamic_cast<OCL::logging::Category*>(*iter);
+            if (category)
+            {
+                std::vector<LoggingEventQueue*>& queues = category->event_queues;
+                queues.erase(std::remove(queues.begin(), queues.end(), queue),
+                             queues.end());
+            }
+        }
+    }
+    delete categories;
+    updateFanOut();
+
+    // the tables which still refer to the queue are retired now, wait
+    // until reclaimFanOut() deleted them
+    for (;;)
+    {
         {
-            parent->callAppenders(event);
+            RTT::os::MutexLock lock(fanOutLock());
+            reclaimFanOut();
+            bool used = false;
+            std::vector<FanOut*>& retired = retiredFanOut();
+            std::vector<FanOut*>::const_iterator iter;
+            for (iter = retired.begin(); !used && (iter != retired.end()); ++iter)
+            {
+                used = (*iter)->queues.end() !=
+                    std::find((*iter)->queues.begin(), (*iter)->queues.end(), queue);
+            }
+            if (!used)
+            {
+                return;
+            }
         }
-        // else we don't use non-realtime parent Category's!
+        TIME_SPEC pause;
+        pause.tv_sec    = 0;
+        pause.tv_nsec   = 1000000;
+        rtos_nanosleep(&pause, 0);
     }
 }
 
@@ -4,7 +4,11 @@
 #include <log4cpp/Category.hh>
 #include "LoggingEvent.hpp"
 #include "CategoryStream.hpp"
+#include "BinaryFormat.hpp"
+#include "CategoryFilter.hpp"
 #include <rtt/Port.hpp>
+#include <vector>
+#include <stdexcept>
 
 // forward declare
 namespace RTT {
@@ -16,6 +20,8 @@ namespace logging {
 
 // forward declare
 class LoggingService;
+class LoggingEventPool;
+class LoggingEventQueue;
 
 /** A real-time capable category
     \warning This class uses intentionally \b private \b inheritance to 
@@ -42,6 +48,99 @@ public:
     void emerg(const RTT::rt_string& message) throw();
     void fatal(const RTT::rt_string& message) throw();
 
+    /** Log \a format with up to six arguments, which are stored in
+        binary form and only formatted by the appenders (see BinaryFormat).
+        \note Real-time capable, does not allocate
+    */
+    void log(log4cpp::Priority::Value priority,
+             const BinaryFormat& format) throw();
+    template<class A1>
+    void log(log4cpp::Priority::Value priority, const BinaryFormat& format,
+             const A1& a1) throw()
+    {
+        if (isPriorityEnabled(priority) && admitFormat(priority, format))
+        {
+            BinaryEncoder encoder(category_id, format, priority);
+            encoder << a1;
+            callAppenders(encoder.event);
+        }
+    }
+
+    template<class A1, class A2>
+    void log(log4cpp::Priority::Value priority, const BinaryFormat& format,
+             const A1& a1,
+             const A2& a2) throw()
+    {
+        if (isPriorityEnabled(priority) && admitFormat(priority, format))
+        {
+            BinaryEncoder encoder(category_id, format, priority);
+            encoder << a1 << a2;
+            callAppenders(encoder.event);
+        }
+    }
+
+    template<class A1, class A2, class A3>
+    void log(log4cpp::Priority::Value priority, const BinaryFormat& format,
+             const A1& a1,
+             const A2& a2,
+             const A3& a3) throw()
+    {
+        if (isPriorityEnabled(priority) && admitFormat(priority, format))
+        {
+            BinaryEncoder encoder(category_id, format, priority);
+            encoder << a1 << a2 << a3;
+            callAppenders(encoder.event);
+        }
+    }
+
+    template<class A1, class A2, class A3, class A4>
+    void log(log4cpp::Priority::Value priority, const BinaryFormat& format,
+             const A1& a1,
+             const A2& a2,
+             const A3& a3,
+             const A4& a4) throw()
+    {
+        if (isPriorityEnabled(priority) && admitFormat(priority, format))
+        {
+            BinaryEncoder encoder(category_id, format, priority);
+            encoder << a1 << a2 << a3 << a4;
+            callAppenders(encoder.event);
+        }
+    }
+
+    template<class A1, class A2, class A3, class A4, class A5>
+    void log(log4cpp::Priority::Value priority, const BinaryFormat& format,
+             const A1& a1,
+             const A2& a2,
+             const A3& a3,
+             const A4& a4,
+             const A5& a5) throw()
+    {
+        if (isPriorityEnabled(priority) && admitFormat(priority, format))
+        {
+            BinaryEncoder encoder(category_id, format, priority);
+            encoder << a1 << a2 << a3 << a4 << a5;
+            callAppenders(encoder.event);
+        }
+    }
+
+    template<class A1, class A2, class A3, class A4, class A5, class A6>
+    void log(log4cpp::Priority::Value priority, const BinaryFormat& format,
+             const A1& a1,
+             const A2& a2,
+             const A3& a3,
+             const A4& a4,
+             const A5& a5,
+             const A6& a6) throw()
+    {
+        if (isPriorityEnabled(priority) && admitFormat(priority, format))
+        {
+            BinaryEncoder encoder(category_id, format, priority);
+            encoder << a1 << a2 << a3 << a4 << a5 << a6;
+            callAppenders(encoder.event);
+        }
+    }
+
     /**
      * Returns a stream-like object into which you can log
      * arbitrary data which supports the operator<<().
@@ -52,15 +151,67 @@ protected:
     void _logUnconditionally2(log4cpp::Priority::Value priority, 
                               const RTT::rt_string& message) throw();
 
+    /** Log \a length characters of \a message, of a CategoryStream
+        \param truncated Whether the message was truncated
+        \note Real-time capable, does not allocate
+    */
+    void logStream(log4cpp::Priority::Value priority,
+                   const char* message,
+                   std::size_t length,
+                   bool truncated) throw();
+    friend class OCL::logging::CategoryStream;
+
+    /** Whether \a filter lets a message of \a priority with \a key
+        through, after logging the summary of suppressed messages if due.
+        \note Real-time capable, does not allocate
+    */
+    bool admit(log4cpp::Priority::Value priority, unsigned int key) throw();
+
+    /** Log the counts of \a summary, if any
+        \note Real-time capable, does not allocate
+    */
+    void logSummary(const CategoryFilter::Summary& summary) throw();
+
+    /** Log the summary of suppressed messages of \a filter, if it is due
+        \warning Not real-time capable
+    */
+    void flushFilter();
+
+    /// Whether \a filter, if enabled, lets a message with \a format through
+    bool admitFormat(log4cpp::Priority::Value priority,
+                     const BinaryFormat& format) throw()
+    {
+        return !filter->isEnabled() || admit(priority, CategoryFilter::formatKey(format.getId()));
+    }
+
+    /// Whether \a filter, if enabled, lets \a message of \a length characters through
+    bool admitMessage(log4cpp::Priority::Value priority,
+                      const char* message,
+                      std::size_t length) throw()
+    {
+        return !filter->isEnabled() || admit(priority, CategoryFilter::key(message, length));
+    }
+
 
     // real-time - available to user
 public:
-    using log4cpp::Category::setPriority;
+    /** Set the priority, and advance the priority generation as the
+        chained priority of our children may change too.
+    */
+    virtual void setPriority(log4cpp::Priority::Value priority)
+        throw(std::invalid_argument);
+    /** Incremented whenever the priority of any OCL category changes, so
+        that cached chained priorities can be checked (see CategoryHandle).
+        \note Real-time capable, a single load
+    */
+    static int getPriorityGeneration() throw()
+    {
+        return priority_generation;
+    }
     using log4cpp::Category::getPriority;
     using log4cpp::Category::getChainedPriority;
     using log4cpp::Category::isPriorityEnabled;
 
-    using log4cpp::Category::setAdditivity;
     using log4cpp::Category::getAdditivity;
     using log4cpp::Category::getParent;
 
@@ -79,6 +230,14 @@ public:
 public:
     using log4cpp::Category::getAppender;
 
+    // NOT real-time - available to user
+public:
+    /** Set the additivity, and rebuild the fan-out tables of all categories
+        as their destinations may change.
+        \warning Not real-time capable
+    */
+    virtual void setAdditivity(bool additivity);
+
 
 
     // NOT real-time and so _NOT_ available to user
@@ -140,6 +299,72 @@ protected:
     */
     virtual void callAppenders(const OCL::logging::LoggingEvent& event) throw();
 
+    /** The destinations of the events of a category: the appender queues
+        and log ports of the category and of the parents it is additive to,
+        so that logging need not walk the category hierarchy.
+        A table is never modified once it is in use.
+    */
+    struct FanOut
+    {
+        FanOut() : pool(0), epoch(0) {}
+        /// Releases \a pool
+        ~FanOut();
+
+        /// Pool to take events from when sending to \a queues, of which
+        /// the table holds a reference
+        LoggingEventPool*                                           pool;
+        /// Epoch in which the table was replaced, see reclaimFanOut()
+        int                                                         epoch;
+        std::vector<LoggingEventQueue*>                             queues;
+        std::vector<RTT::OutputPort<OCL::logging::LoggingEvent>*>   ports;
+    };
+
+    /** Send \a event to the appender queues in \a table. The event is
+        copied once into a pooled slot, and a pointer to it is queued for
+        each appender.
+        \note Real-time capable and lock-free
+    */
+    void callAppenderQueues(const FanOut& table,
+                            const OCL::logging::LoggingEvent& event) throw();
+
+    /** Write \a event to the connected log ports in \a table.
+    */
+    void callAppenderPorts(const FanOut& table,
+                           const OCL::logging::LoggingEvent& event) throw();
+
+    /// Our parent if we are additive and it is an OCL category, otherwise 0
+    Category* getAdditiveParent();
+
+    /** Create our fan-out table from the current hierarchy and queues.
+        \pre the fan-out lock is held
+    */
+    FanOut* buildFanOut();
+
+    /** Replace our fan-out table with \a table. The old table is kept
+        until reclaimFanOut() finds that no logger can use it anymore.
+        \pre the fan-out lock is held
+    */
+    void setFanOut(FanOut* table);
+
+    /** Rebuild the fan-out tables of all OCL categories, eg after
+        changing the queues or additivity of any category. Tables replaced
+        by earlier updates are deleted once unused.
+        \warning Not real-time capable
+    */
+    static void updateFanOut();
+
+    /** Delete the replaced tables which no logger can use anymore, and
+        advance the epoch. Loggers count themselves in \a fanout_readers
+        of the epoch they started in, so a table replaced in an epoch is
+        deleted by the first call after all loggers of that epoch finished.
+        \pre the fan-out lock is held
+    */
+    static void reclaimFanOut();
+
+    /// Tables replaced while loggers may still use them
+    /// \pre the fan-out lock is held
+    static std::vector<FanOut*>& retiredFanOut();
+
     /** Convert \a name into Orocos notation (e.g. "org.me.app" -> "org_me_app")
 
         \warning Not real-time capable
@@ -156,12 +381,51 @@ public:
                                                 log4cpp::Category* parent, 
                                                 log4cpp::Priority::Value priority);
 
+    /** Detach \a queue from all categories, and wait until no logger can
+        send events to it anymore, after which its owner may delete it.
+        \warning Not real-time capable, and waits for the loggers which
+        are still using an old fan-out table
+    */
+    static void removeEventQueue(LoggingEventQueue* queue);
+
 
 protected:
 //protected:
     RTT::OutputPort<OCL::logging::LoggingEvent>   log_port;
-    /// for access to \a log_port
+    /// Our interned name, stored in the events we log
+    CategoryId                                    category_id;
+    /// Queues of the appenders attached to this category, if any
+    std::vector<LoggingEventQueue*>               event_queues;
+    /// Pool to take events from when sending to \a event_queues
+    LoggingEventPool*                             event_pool;
+    /// Where our events go, replaced atomically by updateFanOut()
+    FanOut* volatile                              fanout;
+    /// Rate limit and duplicate suppression, created disabled with us as
+    /// loggers read it without synchronization
+    CategoryFilter* const                         filter;
+    /// See getPriorityGeneration()
+    static volatile int                           priority_generation;
+    /// Incremented by reclaimFanOut()
+    static volatile int                           fanout_epoch;
+    /// Number of loggers using a fan-out table, for even and odd epochs
+    static volatile int                           fanout_readers[2];
+    /// for access to \a log_port and \a event_queues
     friend class OCL::logging::LoggingService;
+
+    /** Attach an appender queue, with the pool to take events from.
+        Takes effect with the next updateFanOut().
+        \warning Not real-time capable
+    */
+    void addEventQueue(LoggingEventQueue* queue, LoggingEventPool* pool);
+
+    /// Detach all appender queues. Takes effect with the next updateFanOut().
+    /// \warning Not real-time capable
+    void clearEventQueues();
+
+    /** Get our filter, to configure it
+        \warning Not real-time capable
+    */
+    CategoryFilter& getFilter();
     
 public:
     /** Connect \a otherPort to \a log_port.
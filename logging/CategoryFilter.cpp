@@ -0,0 +1,153 @@
+#include "CategoryFilter.hpp"
+#include <rtt/os/MutexLock.hpp>
+#include <algorithm>
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+/// 32-bit FNV-1a
+unsigned int hash(const unsigned char* data, std::size_t length, unsigned int h)
+{
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+const unsigned int TextBasis   = 2166136261u;
+// another basis, to not mix up texts and format ids
+const unsigned int FormatBasis = 84696351u;
+
+}
+
+CategoryFilter::CategoryFilter() :
+        enabled(false),
+        rate(0),
+        burst(0),
+        tokens(0),
+        lastRefill(0),
+        suppressDuplicates(false),
+        havePrevious(false),
+        previousKey(0),
+        previousPriority(log4cpp::Priority::NOTSET),
+        summaryInterval(5000000000LL),
+        lastSummary(0)
+{
+}
+
+void CategoryFilter::setRateLimit(double rate, double burst)
+{
+    RTT::os::MutexLock locker(lock);
+    this->rate      = std::max(0.0, rate);
+    this->burst     = std::max(1.0, burst);
+    tokens          = this->burst;
+    lastRefill      = EventClock::now();
+    enabled         = (0 < this->rate) || suppressDuplicates;
+}
+
+void CategoryFilter::setSuppressDuplicates(bool suppress)
+{
+    RTT::os::MutexLock locker(lock);
+    suppressDuplicates  = suppress;
+    havePrevious        = false;
+    enabled             = (0 < rate) || suppressDuplicates;
+}
+
+void CategoryFilter::setSummaryInterval(double interval)
+{
+    RTT::os::MutexLock locker(lock);
+    summaryInterval = (EventClock::Nanoseconds)(interval * 1e9);
+}
+
+bool CategoryFilter::admit(log4cpp::Priority::Value priority, unsigned int key, Summary& summary)
+{
+    if (!enabled)
+        return true;
+    RTT::os::MutexTryLock locker(lock);
+    if (!locker.isSuccessful())
+        return true;
+
+    const EventClock::Nanoseconds now = EventClock::now();
+    bool pass = true;
+    bool duplicate = false;
+    if (suppressDuplicates && havePrevious &&
+        (key == previousKey) && (priority == previousPriority))
+    {
+        duplicate   = true;
+        pass        = false;
+    }
+    else if (0 < rate)
+    {
+        tokens = std::min(burst, tokens + (now - lastRefill) * 1e-9 * rate);
+        lastRefill = now;
+        if (1.0 <= tokens)
+            tokens -= 1.0;
+        else
+            pass = false;
+    }
+
+    if (!pass)
+    {
+        if ((0 == suppressed.duplicates) && (0 == suppressed.limited))
+        {
+            // the interval starts with the first suppressed message
+            lastSummary = now;
+        }
+        if (duplicate)
+            ++suppressed.duplicates;
+        else
+            ++suppressed.limited;
+        // lower values are more severe
+        if (priority < suppressed.priority)
+            suppressed.priority = priority;
+    }
+    else
+    {
+        havePrevious        = true;
+        previousKey         = key;
+        previousPriority    = priority;
+    }
+
+    // report when a series of duplicates ends, or every interval
+    if (((0 != suppressed.duplicates) && !duplicate) ||
+        (((0 != suppressed.duplicates) || (0 != suppressed.limited)) &&
+         (summaryInterval <= now - lastSummary)))
+    {
+        summary     = suppressed;
+        suppressed  = Summary();
+        lastSummary = now;
+    }
+    return pass;
+}
+
+bool CategoryFilter::flush(Summary& summary)
+{
+    RTT::os::MutexLock locker(lock);
+    if (((0 == suppressed.duplicates) && (0 == suppressed.limited)) ||
+        (EventClock::now() - lastSummary < summaryInterval))
+    {
+        return false;
+    }
+    summary     = suppressed;
+    suppressed  = Summary();
+    lastSummary = EventClock::now();
+    return true;
+}
+
+unsigned int CategoryFilter::key(const char* message, std::size_t length)
+{
+    return hash(reinterpret_cast<const unsigned char*>(message), length, TextBasis);
+}
+
+unsigned int CategoryFilter::formatKey(unsigned int formatId)
+{
+    return hash(reinterpret_cast<const unsigned char*>(&formatId), sizeof(formatId), FormatBasis);
+}
+
+// namespaces
+}
+}
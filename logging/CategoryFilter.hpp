@@ -0,0 +1,123 @@
+#ifndef	CATEGORYFILTER_HPP
+#define	CATEGORYFILTER_HPP 1
+
+#include "EventClock.hpp"
+#include <log4cpp/Priority.hh>
+#include <rtt/os/Mutex.hpp>
+#include <cstddef>
+
+namespace OCL {
+namespace logging {
+
+/** Rate limit and duplicate suppression of the messages of one category,
+    decided before an event is built.
+
+    The rate limit is a token bucket: a message takes a token, and tokens
+    are added at the rate, up to the burst size. Messages for which no
+    token is left are suppressed.
+
+    With duplicate suppression, a message which is similar to the previous
+    one logged to the category is suppressed. Messages are similar when
+    they have the same priority and the same text, or the same BinaryFormat
+    as the values of its arguments are not compared.
+
+    The number of suppressed messages is reported in a summary, when a
+    series of similar messages ends or every summary interval while
+    messages are being suppressed.
+*/
+class CategoryFilter
+{
+public:
+    /// Messages suppressed since the last summary
+    struct Summary
+    {
+        Summary() : duplicates(0), limited(0), priority(log4cpp::Priority::NOTSET) {}
+
+        /// Suppressed because similar to the previous message
+        int                         duplicates;
+        /// Suppressed by the rate limit
+        int                         limited;
+        /// Highest priority of the suppressed messages
+        log4cpp::Priority::Value    priority;
+    };
+
+    CategoryFilter();
+
+    /** Limit the messages to \a rate per second, with bursts of up to
+        \a burst messages. A \a rate of 0 disables the limit.
+        \warning Not real-time capable
+    */
+    void setRateLimit(double rate, double burst);
+
+    /// \warning Not real-time capable
+    void setSuppressDuplicates(bool suppress);
+
+    /// Set the time between summaries in seconds
+    /// \warning Not real-time capable
+    void setSummaryInterval(double interval);
+
+    /// Whether a rate limit or duplicate suppression is configured
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    /** Decide whether to log a message of \a priority, which is
+        similar to all messages with the same \a key.
+        \param summary Set when a summary is due, which is to be logged
+        before the message
+        \return false if the message is suppressed
+        \note Real-time capable and does not block. When another thread
+        holds the filter, the message is logged and not counted.
+    */
+    bool admit(log4cpp::Priority::Value priority, unsigned int key, Summary& summary);
+
+    /** Get the summary of the messages suppressed since the last one, if
+        the summary interval passed. As admit() only reports summaries
+        when messages are logged, call this periodically to report the
+        messages suppressed at the end of a flood.
+        \return true if \a summary was set
+        \warning Not real-time capable, as it waits for the filter
+    */
+    bool flush(Summary& summary);
+
+    /// The key of a message with text \a message of \a length characters
+    static unsigned int key(const char* message, std::size_t length);
+
+    /// The key of a message with the BinaryFormat of \a formatId
+    static unsigned int formatKey(unsigned int formatId);
+
+protected:
+    /// Held while deciding and configuring
+    RTT::os::Mutex              lock;
+    /// Whether any filtering is configured
+    volatile bool               enabled;
+
+    /// Messages per second, 0 for no limit
+    double                      rate;
+    double                      burst;
+    double                      tokens;
+    EventClock::Nanoseconds     lastRefill;
+
+    bool                        suppressDuplicates;
+    /// Key and priority of the previous message that was logged
+    bool                        havePrevious;
+    unsigned int                previousKey;
+    log4cpp::Priority::Value    previousPriority;
+
+    EventClock::Nanoseconds     summaryInterval;
+    EventClock::Nanoseconds     lastSummary;
+    /// Counts for the next summary
+    Summary                     suppressed;
+
+private:
+    /* prevent copying and assignment */
+    CategoryFilter(const CategoryFilter& other);
+    CategoryFilter& operator=(const CategoryFilter& other);
+};
+
+// namespaces
+}
+}
+
+#endif
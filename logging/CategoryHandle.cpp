@@ -0,0 +1,49 @@
+#include "logging/CategoryHandle.hpp"
+#include <rtt/Logger.hpp>
+#include <typeinfo>
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+CategoryHandle::CategoryHandle() :
+        category(0),
+        priority(log4cpp::Priority::NOTSET),
+        generation(0)
+{
+}
+
+CategoryHandle::CategoryHandle(const std::string& name) :
+        category(0),
+        priority(log4cpp::Priority::NOTSET),
+        generation(0)
+{
+    resolve(name);
+}
+
+bool CategoryHandle::resolve(const std::string& name)
+{
+    // "" == name implies the root category.
+    log4cpp::Category& p = log4cpp::Category::getInstance(name);
+    category = dynamic_cast<OCL::logging::Category*>(&p);
+    if (0 == category)
+    {
+        log(Error) << "Category '" << name << "' is not an OCL category: type is '"
+                   << typeid(p).name() << "'" << endlog();
+        return false;
+    }
+    refresh();
+    return true;
+}
+
+void CategoryHandle::refresh() const
+{
+    // a priority set in between only causes another refresh
+    generation  = Category::getPriorityGeneration();
+    priority    = category->getChainedPriority();
+}
+
+// namespaces
+}
+}
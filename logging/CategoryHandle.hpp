@@ -0,0 +1,103 @@
+#ifndef	CATEGORYHANDLE_HPP
+#define	CATEGORYHANDLE_HPP 1
+
+#include "Category.hpp"
+#include <string>
+
+namespace OCL {
+namespace logging {
+
+/** A category resolved once by name, with its chained priority cached.
+
+    Looking up a category by name takes the lock of the log4cpp hierarchy
+    and searches its map, so resolve a handle outside the real-time loop
+    and log through it:
+
+    \code
+    CategoryHandle logger("org.orocos.ocl.myComponent");   // not real-time
+    ...
+    if (logger.isPriorityEnabled(log4cpp::Priority::DEBUG))  // real-time
+        logger->log(log4cpp::Priority::DEBUG, format, value);
+    \endcode
+
+    isPriorityEnabled() compares against the cached chained priority, which
+    is refreshed when Category::getPriorityGeneration() shows that the
+    priority of any category changed since.
+
+    \note A handle caches without locking, so give each thread its own copy.
+*/
+class CategoryHandle
+{
+public:
+    /// An unresolved handle
+    CategoryHandle();
+    /** Resolve the OCL category \a name, creating it if needed
+        \warning Not real-time capable
+    */
+    explicit CategoryHandle(const std::string& name);
+
+    /** Resolve the OCL category \a name, creating it if needed
+        \return false if it is not an OCL category, leaving the handle
+        unresolved
+        \warning Not real-time capable
+    */
+    bool resolve(const std::string& name);
+
+    /// Whether the handle refers to a category
+    bool isValid() const
+    {
+        return 0 != category;
+    }
+
+    /// The category, or 0 if unresolved
+    Category* get() const
+    {
+        return category;
+    }
+    Category* operator->() const
+    {
+        return category;
+    }
+    Category& operator*() const
+    {
+        return *category;
+    }
+
+    /** The chained priority of the category
+        \pre isValid()
+        \note Real-time capable
+    */
+    log4cpp::Priority::Value getChainedPriority() const
+    {
+        if (generation != Category::getPriorityGeneration())
+        {
+            refresh();
+        }
+        return priority;
+    }
+
+    /** Whether a message of \a priority would be logged, like
+        Category::isPriorityEnabled() but without walking the parents
+        \pre isValid()
+        \note Real-time capable, a load and compare unless a priority changed
+    */
+    bool isPriorityEnabled(log4cpp::Priority::Value priority) const
+    {
+        return getChainedPriority() >= priority;
+    }
+
+protected:
+    /// Cache the current chained priority
+    void refresh() const;
+
+    Category*                           category;
+    mutable log4cpp::Priority::Value    priority;
+    /// Priority generation \a priority was cached at
+    mutable int                         generation;
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include "CategoryNames.hpp"
+#include "InternTable.hpp"
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+/* function local, as categories may be created during static
+   initialisation, and never deleted, as they may log during static
+   destruction */
+InternTable& names()
+{
+    static InternTable* table = new InternTable("<overflow>");
+    return *table;
+}
+
+}
+
+CategoryId CategoryNames::intern(const std::string& name)
+{
+    return names().intern(name);
+}
+
+const char* CategoryNames::name(CategoryId id)
+{
+    return names().get(id);
+}
+
+unsigned int CategoryNames::size()
+{
+    return names().size();
+}
+
+// namespaces
+}
+}
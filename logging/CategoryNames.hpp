@@ -0,0 +1,50 @@
+#ifndef	CATEGORYNAMES_HPP
+#define	CATEGORYNAMES_HPP 1
+
+#include <string>
+#include "InternTable.hpp"
+
+namespace OCL {
+namespace logging {
+
+/// Identifies an interned category name
+typedef unsigned int CategoryId;
+
+/** Interns category names, such that logging events only need to carry
+    a small id instead of a copy of the name. Names are never removed,
+    as log4cpp never deletes its categories either.
+
+    Id 0 is the empty name of the root category. Id Overflow is the name
+    "<overflow>", which is given to all categories created after Capacity
+    names were interned, such that their events do not pass for events of
+    the root category.
+*/
+class CategoryNames
+{
+public:
+    /// Maximum number of category names
+    enum { Capacity = InternTable::Capacity };
+    /// Id of the names which were interned when out of ids
+    enum { Overflow = InternTable::Overflow };
+
+    /** Get the id of \a name, adding it if it was not interned yet.
+        \return the id, or Overflow when out of ids
+        \warning Not real-time capable
+    */
+    static CategoryId intern(const std::string& name);
+
+    /** Get the name of \a id.
+        \return the name, or "" for an unknown id
+        \note Real-time capable and lock-free
+    */
+    static const char* name(CategoryId id);
+
+    /// Number of interned names
+    static unsigned int size();
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -1,12 +1,18 @@
 #include "CategoryStream.hpp"
 #include "Category.hpp"
+#include <cstdio>
+#include <cstring>
 
 namespace OCL {
 namespace logging {
 
 CategoryStream::CategoryStream(Category* rt_category, log4cpp::Priority::Value priority) :
     _category(rt_category),
-    _priority(priority)
+    _priority(priority),
+    _length(0),
+    _truncated(false),
+    _buf(*this),
+    _os(&_buf)
 {
 
 }
@@ -18,8 +24,152 @@ CategoryStream::~CategoryStream()
 
 void CategoryStream::flush()
 {
-    _category->log(_priority, oss.str());
-    oss.flush();
+    if ((_priority != log4cpp::Priority::NOTSET) && (0 != _length))
+    {
+        _category->logStream(_priority, _buffer, _length, _truncated);
+    }
+    _length = 0;
+    _truncated = false;
+}
+
+void CategoryStream::append(const char* data, std::size_t length)
+{
+    // keep room for the '\0' which the event adds
+    const std::size_t room = sizeof(_buffer) - 1 - _length;
+    if (length > room)
+    {
+        length = room;
+        _truncated = true;
+    }
+    memcpy(_buffer + _length, data, length);
+    _length += length;
+}
+
+CategoryStream& CategoryStream::operator<<(const char* t)
+{
+    if (!plain())
+    {
+        return formatted(t);
+    }
+    if (_priority != log4cpp::Priority::NOTSET)
+    {
+        append(t, strlen(t));
+    }
+    return *this;
+}
+
+CategoryStream& CategoryStream::operator<<(char t)
+{
+    if (!plain())
+    {
+        return formatted(t);
+    }
+    if (_priority != log4cpp::Priority::NOTSET)
+    {
+        append(&t, 1);
+    }
+    return *this;
+}
+
+CategoryStream& CategoryStream::operator<<(long long t)
+{
+    if (!plain())
+    {
+        return formatted(t);
+    }
+    if (_priority != log4cpp::Priority::NOTSET)
+    {
+        if (0 > t)
+        {
+            append("-", 1);
+            // negate as unsigned, as -t overflows for the minimum
+            return *this << (0ULL - (unsigned long long)t);
+        }
+        return *this << (unsigned long long)t;
+    }
+    return *this;
+}
+
+CategoryStream& CategoryStream::operator<<(unsigned long long t)
+{
+    if (!plain())
+    {
+        return formatted(t);
+    }
+    if (_priority != log4cpp::Priority::NOTSET)
+    {
+        char    digits[24];
+        char*   p = digits + sizeof(digits);
+        do
+        {
+            *--p = '0' + (t % 10);
+            t /= 10;
+        }
+        while (0 != t);
+        append(p, digits + sizeof(digits) - p);
+    }
+    return *this;
+}
+
+CategoryStream& CategoryStream::operator<<(double t)
+{
+    if (!plain())
+    {
+        return formatted(t);
+    }
+    if (_priority != log4cpp::Priority::NOTSET)
+    {
+        // as std::ostream does by default
+        char    buffer[32];
+        int     n = snprintf(buffer, sizeof(buffer), "%g", t);
+        if (0 < n)
+        {
+            append(buffer, n);
+        }
+    }
+    return *this;
+}
+
+CategoryStream& CategoryStream::operator<<(const void* t)
+{
+    if (!plain())
+    {
+        return formatted(t);
+    }
+    if (_priority != log4cpp::Priority::NOTSET)
+    {
+        char    buffer[24];
+        int     n = snprintf(buffer, sizeof(buffer), "%p", t);
+        if (0 < n)
+        {
+            append(buffer, n);
+        }
+    }
+    return *this;
+}
+
+CategoryStream::Streambuf::Streambuf(CategoryStream& stream) :
+    stream(stream)
+{
+    reset();
+}
+
+void CategoryStream::Streambuf::reset()
+{
+    setp(stream._buffer + stream._length,
+         stream._buffer + sizeof(stream._buffer) - 1);
+}
+
+int CategoryStream::Streambuf::sync()
+{
+    stream._length = pptr() - stream._buffer;
+    return 0;
+}
+
+CategoryStream::Streambuf::int_type CategoryStream::Streambuf::overflow(int_type)
+{
+    stream._truncated = true;
+    return traits_type::eof();
 }
 
 CategoryStream& eol(CategoryStream& os)
@@ -31,12 +181,18 @@ CategoryStream& eol(CategoryStream& os)
 
 CategoryStream::CategoryStream(const CategoryStream & rhs) :
     _category(rhs._category),
-    _priority(rhs._priority)
+    _priority(rhs._priority),
+    _length(rhs._length),
+    _truncated(rhs._truncated),
+    _buf(*this),
+    _os(&_buf)
 {
-    // Must copy the underlying buffer but not the output stream
-    (*this).oss.str(rhs.oss.str());
+    memcpy(_buffer, rhs._buffer, _length);
+    _os.flags(rhs._os.flags());
+    _os.width(rhs._os.width());
+    _os.precision(rhs._os.precision());
+    _os.fill(rhs._os.fill());
 }
 
 } // namespace logging
 } // namespace OCL
-
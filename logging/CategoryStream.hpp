@@ -4,6 +4,10 @@
 #include <ocl/OCL.hpp>
 #include <log4cpp/Priority.hh>
 #include <rtt/rt_string.hpp>
+#include "LoggingEvent.hpp"
+#include <ostream>
+#include <streambuf>
+#include <string>
 
 namespace OCL {
 namespace logging {
@@ -15,6 +19,18 @@ class OCL_API Category;
  * category object.
  * It provides an std::iostream like syntax using the << operator, but you
  * need to call flush() in order to do the actual write of your message.
+ *
+ * The message is formatted into a fixed-size buffer of
+ * LoggingEvent::MessageSize characters, and truncated if it does not fit,
+ * so streaming strings, characters, booleans, integers, floating point
+ * numbers and pointers never allocates. Other types are formatted with an
+ * std::ostream writing into the same buffer, which may allocate depending
+ * on their operator<<. Nothing is formatted if the priority is disabled.
+ *
+ * Manipulators such as std::hex, std::fixed, std::setprecision and
+ * std::setw apply as with an std::ostream, and last until changed, except
+ * for the width. Once the format differs from the default one, the built-in
+ * types are formatted by that std::ostream too.
  */
 class OCL_API CategoryStream
 {
@@ -29,8 +45,7 @@ public:
     CategoryStream(Category* rt_category, log4cpp::Priority::Value priority);
 
     /**
-     * Copy-constructor needed because the output string stream can't be
-     * copied. We rater have to copy the underlying (real-time) string.
+     * Copy-constructor, copying the buffered message.
      * @param rhs The CategoryStream to copy from
      */ 
     CategoryStream(const CategoryStream & rhs);
@@ -47,6 +62,43 @@ public:
      **/
     void flush();
 
+    CategoryStream& operator<<(const char* t);
+    CategoryStream& operator<<(char t);
+    CategoryStream& operator<<(signed char t)           { return *this << (char)t; }
+    CategoryStream& operator<<(unsigned char t)         { return *this << (char)t; }
+    CategoryStream& operator<<(bool t)                  { return plain() ? *this << (t ? '1' : '0') : formatted(t); }
+    CategoryStream& operator<<(short t)                 { return plain() ? *this << (long long)t : formatted(t); }
+    CategoryStream& operator<<(unsigned short t)        { return plain() ? *this << (unsigned long long)t : formatted(t); }
+    CategoryStream& operator<<(int t)                   { return plain() ? *this << (long long)t : formatted(t); }
+    CategoryStream& operator<<(unsigned int t)          { return plain() ? *this << (unsigned long long)t : formatted(t); }
+    CategoryStream& operator<<(long t)                  { return plain() ? *this << (long long)t : formatted(t); }
+    CategoryStream& operator<<(unsigned long t)         { return plain() ? *this << (unsigned long long)t : formatted(t); }
+    CategoryStream& operator<<(long long t);
+    CategoryStream& operator<<(unsigned long long t);
+    CategoryStream& operator<<(float t)                 { return plain() ? *this << (double)t : formatted(t); }
+    CategoryStream& operator<<(double t);
+    CategoryStream& operator<<(const void* t);
+
+    template<class Alloc>
+    CategoryStream& operator<<(const std::basic_string<char, std::char_traits<char>, Alloc>& t)
+    {
+        if (!plain())
+        {
+            return formatted(t);
+        }
+        if (_priority != log4cpp::Priority::NOTSET)
+        {
+            append(t.data(), t.size());
+        }
+        return *this;
+    }
+
+    /// Apply a manipulator, eg eol
+    CategoryStream& operator<<(CategoryStream& (*manipulator)(CategoryStream&))
+    {
+        return manipulator(*this);
+    }
+
     /**
      * Stream in arbitrary types and objects.  
      * @param t The value or object to stream in.
@@ -54,21 +106,62 @@ public:
      **/
     template<typename T> CategoryStream& operator<<(const T& t) 
     {
-         if (_priority != log4cpp::Priority::NOTSET) 
-         {
-             (oss) << t;
-         }
-         return *this;
-     }
+        return formatted(t);
+    }
 
 private:
+    /// Append \a length characters of \a data, truncating if needed
+    void append(const char* data, std::size_t length);
+
+    /// Whether the format of \a _os is the default one
+    bool plain() const
+    {
+        return (_os.flags() == (std::ios_base::skipws | std::ios_base::dec)) &&
+            (0 == _os.width()) && (6 == _os.precision());
+    }
+
+    /// Format \a t with \a _os, which manipulators are applied to as well
+    template<typename T> CategoryStream& formatted(const T& t)
+    {
+        if (_priority != log4cpp::Priority::NOTSET)
+        {
+            // after a truncation, or a flush
+            _os.clear();
+            _buf.reset();
+            _os << t;
+            _buf.sync();
+        }
+        return *this;
+    }
+
+    /// Writes into the buffer of a CategoryStream
+    class OCL_API Streambuf : public std::streambuf
+    {
+    public:
+        Streambuf(CategoryStream& stream);
+        /// Continue writing at the end of the message
+        void reset();
+        /// Update the length of the stream
+        virtual int sync();
+    protected:
+        virtual int_type overflow(int_type c);
+        CategoryStream& stream;
+    };
 
     Category* _category;
     log4cpp::Priority::Value _priority;
-    RTT::rt_ostringstream oss;
+    /// Message so far, not '\0'-terminated
+    char _buffer[LoggingEvent::MessageSize];
+    std::size_t _length;
+    bool _truncated;
+    /// Formats into \a _buffer, and holds the format state
+    Streambuf _buf;
+    std::ostream _os;
 
 };
 
+/// Flush \a os, eg stream << "message" << eol;
+OCL_API CategoryStream& eol(CategoryStream& os);
 
 } // namespace logging
 } // namespace OCL
@@ -0,0 +1,207 @@
+#include "EventClock.hpp"
+#include <log4cpp/TimeStamp.hh>
+#include <cstring>
+#include <fstream>
+#include <string>
+#if !defined(_WIN32)
+#include <time.h>
+#endif
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+EventClock::Nanoseconds monotonicNow()
+{
+#if defined(_WIN32)
+    // no monotonic clock, use the wall clock
+    log4cpp::TimeStamp now;
+    return now.getSeconds() * 1000000000LL + now.getMicroSeconds() * 1000LL;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/// Offset from the monotonic clock to the wall clock, and the first use
+struct Origin
+{
+    Origin()
+    {
+        log4cpp::TimeStamp wall;
+        start   = monotonicNow();
+        offset  = wall.getSeconds() * 1000000000LL + wall.getMicroSeconds() * 1000LL - start;
+    }
+    EventClock::Nanoseconds start;
+    EventClock::Nanoseconds offset;
+};
+
+// function local, as events may be logged during static initialisation
+const Origin& origin()
+{
+    static Origin o;
+    return o;
+}
+
+// otherwise set when first formatting an event
+struct SetOrigin { SetOrigin() { origin(); } } setOrigin;
+
+#if defined(__i386__) || defined(__x86_64__)
+#define OCL_LOGGING_HAS_TSC 1
+
+inline boost::uint64_t readTsc()
+{
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((boost::uint64_t)hi << 32) | lo;
+}
+
+/* The TSC calibration. Zero initialized, so that now() can be called
+   during static initialisation. \a tscUsed is only set once the other
+   values are. The base and rate are updated by resync() while readers use
+   them, so they are guarded by \a tscSequence, which is odd during an
+   update. x86 does not reorder loads with loads and stores with stores,
+   so the compiler is the only one to keep from reordering. */
+volatile bool       tscUsed;
+volatile unsigned int tscSequence;
+boost::uint64_t     tscBase;
+EventClock::Nanoseconds tscNanosecondsBase;
+double              nanosecondsPerTick;
+/// The first calibration, against which resync() measures the rate
+boost::uint64_t     tscOrigin;
+EventClock::Nanoseconds tscNanosecondsOrigin;
+
+inline void compilerBarrier()
+{
+    __asm__ __volatile__("" ::: "memory");
+}
+
+/// Read the TSC, and the monotonic clock at about the same time
+void readClocks(boost::uint64_t& ticks, EventClock::Nanoseconds& t)
+{
+    const EventClock::Nanoseconds t0 = monotonicNow();
+    ticks = readTsc();
+    const EventClock::Nanoseconds t1 = monotonicNow();
+    t = t0 + (t1 - t0) / 2;
+}
+
+/// Whether the TSC runs at a constant rate and does not stop in sleep states
+bool tscInvariant()
+{
+    std::ifstream   cpuinfo("/proc/cpuinfo");
+    std::string     line;
+    while (std::getline(cpuinfo, line))
+    {
+        if (0 == line.compare(0, 5, "flags"))
+        {
+            return (std::string::npos != line.find(" constant_tsc")) &&
+                (std::string::npos != line.find(" nonstop_tsc"));
+        }
+    }
+    return false;
+}
+#endif
+
+}
+
+EventClock::Nanoseconds EventClock::now()
+{
+#if defined(OCL_LOGGING_HAS_TSC)
+    if (tscUsed)
+    {
+        for (;;)
+        {
+            const unsigned int sequence = tscSequence;
+            compilerBarrier();
+            const boost::uint64_t   base            = tscBase;
+            const Nanoseconds       nanosecondsBase = tscNanosecondsBase;
+            const double            perTick         = nanosecondsPerTick;
+            compilerBarrier();
+            if ((0 == (sequence & 1)) && (sequence == tscSequence))
+            {
+                return nanosecondsBase + (Nanoseconds)((readTsc() - base) * perTick);
+            }
+        }
+    }
+#endif
+    return monotonicNow();
+}
+
+void EventClock::toWallTime(Nanoseconds t, boost::int64_t& seconds, int& microseconds)
+{
+    const Nanoseconds wall = t + origin().offset;
+    seconds         = wall / 1000000000LL;
+    microseconds    = (wall % 1000000000LL) / 1000;
+}
+
+EventClock::Nanoseconds EventClock::startTime()
+{
+    return origin().start;
+}
+
+bool EventClock::useTsc(bool use)
+{
+#if defined(OCL_LOGGING_HAS_TSC)
+    tscUsed = false;
+    __sync_synchronize();
+    if (!use || !tscInvariant())
+        return false;
+
+    // count ticks over a known interval
+    boost::uint64_t         c0, c1;
+    Nanoseconds             t0, t1;
+    readClocks(c0, t0);
+    struct timespec         pause = { 0, 20000000 };
+    nanosleep(&pause, 0);
+    readClocks(c1, t1);
+    if (c1 <= c0)
+        return false;
+
+    const unsigned int sequence = tscSequence & ~1u;
+    tscSequence = sequence + 1;
+    compilerBarrier();
+    nanosecondsPerTick      = double(t1 - t0) / double(c1 - c0);
+    tscBase                 = c1;
+    tscNanosecondsBase      = t1;
+    tscOrigin               = c0;
+    tscNanosecondsOrigin    = t0;
+    compilerBarrier();
+    tscSequence = sequence + 2;
+    __sync_synchronize();
+    tscUsed = true;
+    return true;
+#else
+    (void)use;
+    return false;
+#endif
+}
+
+void EventClock::resync()
+{
+#if defined(OCL_LOGGING_HAS_TSC)
+    if (!tscUsed)
+        return;
+    boost::uint64_t ticks;
+    Nanoseconds     t;
+    readClocks(ticks, t);
+    if (ticks <= tscOrigin)
+        return;
+
+    // only one update at a time
+    const unsigned int sequence = tscSequence & ~1u;
+    if (!__sync_bool_compare_and_swap(&tscSequence, sequence, sequence + 1))
+        return;
+    compilerBarrier();
+    nanosecondsPerTick  = double(t - tscNanosecondsOrigin) / double(ticks - tscOrigin);
+    tscBase             = ticks;
+    tscNanosecondsBase  = t;
+    compilerBarrier();
+    tscSequence = sequence + 2;
+#endif
+}
+
+// namespaces
+}
+}
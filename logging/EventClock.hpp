@@ -0,0 +1,58 @@
+#ifndef	EVENTCLOCK_HPP
+#define	EVENTCLOCK_HPP 1
+
+#include <boost/cstdint.hpp>
+
+namespace OCL {
+namespace logging {
+
+/** The clock of logging events: nanoseconds of the monotonic clock, which
+    is cheaper to read than the wall clock. Time stamps are converted to
+    wall time only when an event is formatted.
+
+    On x86, the clock can read the TSC instead (see useTsc()), which is
+    calibrated against the monotonic clock. As the calibration is not
+    exact, TSC time stamps drift away from the monotonic clock, by up to
+    some 50 us per second after the initial calibration. resync()
+    re-anchors the TSC and refines its rate, so call it periodically, as
+    the LoggingService does in its update. The clock may then step by the
+    drift since the previous resync, backwards too.
+*/
+class EventClock
+{
+public:
+    typedef boost::int64_t Nanoseconds;
+
+    /** The current time
+        \note Real-time capable
+    */
+    static Nanoseconds now();
+
+    /** Convert \a t to wall time, using the offset between the monotonic
+        clock and the wall clock when the clock was first used.
+    */
+    static void toWallTime(Nanoseconds t, boost::int64_t& seconds, int& microseconds);
+
+    /// The time at which the clock was first used
+    static Nanoseconds startTime();
+
+    /** Read the TSC if \a use, and if the TSC runs at a constant rate
+        on all processors, otherwise read the monotonic clock.
+        \return whether the TSC is used
+        \warning Not real-time capable, calibrating takes some 20 ms
+    */
+    static bool useTsc(bool use);
+
+    /** Re-anchor the TSC to the monotonic clock, and refine its rate over
+        the time since useTsc(). Does nothing if the TSC is not used.
+        \warning Not real-time capable, as the time stamps of events
+        logged meanwhile may be off by the correction
+    */
+    static void resync();
+};
+
+// namespaces
+}
+}
+
+#endif
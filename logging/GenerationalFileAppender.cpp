@@ -1,9 +1,8 @@
 #include "logging/GenerationalFileAppender.hpp"
+#include "logging/Layout.hpp"
 #include "ocl/Component.hpp"
 #include <rtt/Logger.hpp>
 
-#include <log4cpp/GenerationalFileAppender.hh>
-
 using namespace RTT;
 
 namespace OCL {
@@ -16,16 +15,53 @@ GenerationalFileAppender::GenerationalFileAppender(std::string name) :
     maxEventsPerCycle_prop("MaxEventsPerCycle",
                            "Maximum number of log events to pop per cycle",
                            1),
-    maxEventsPerCycle(1)
+    maxGenerations_prop("MaxGenerations",
+                        "Number of old generations to keep, 0 to keep all",
+                        0),
+    compressCommand_prop("CompressCommand",
+                         "Command compressing old generations in the background, e.g. 'gzip'. Empty to not compress.",
+                         ""),
+    compressSuffix_prop("CompressSuffix",
+                        "Suffix the CompressCommand adds to old generations",
+                        ".gz"),
+    rollovers_prop("Rollovers", "Number of generations advanced since configure (read-only)", 0),
+    deferredRollovers_prop("DeferredRollovers",
+                           "Number of times advancing was postponed as the next file was not open yet (read-only)",
+                           0),
+    rolloverTime_prop("RolloverTime",
+                      "Time the last advance stalled the appender, in seconds (read-only)",
+                      0.0),
+    worstRolloverTime_prop("WorstRolloverTime",
+                           "Highest time an advance stalled the appender, in seconds (read-only)",
+                           0.0),
+    backgroundTime_prop("BackgroundTime",
+                        "Time the background thread took for the last advance, in seconds (read-only)",
+                        0.0),
+    worstBackgroundTime_prop("WorstBackgroundTime",
+                             "Highest time the background thread took for an advance, in seconds (read-only)",
+                             0.0),
+    maxEventsPerCycle(1),
+    advancePending(false),
+    layout(0)
 {
 	provides()->addOperation(advanceGeneration_op).doc("Advance to the next logfile generation");
 
     properties()->addProperty(filename_prop);
     properties()->addProperty(maxEventsPerCycle_prop);
+    properties()->addProperty(maxGenerations_prop);
+    properties()->addProperty(compressCommand_prop);
+    properties()->addProperty(compressSuffix_prop);
+    properties()->addProperty(rollovers_prop);
+    properties()->addProperty(deferredRollovers_prop);
+    properties()->addProperty(rolloverTime_prop);
+    properties()->addProperty(worstRolloverTime_prop);
+    properties()->addProperty(backgroundTime_prop);
+    properties()->addProperty(worstBackgroundTime_prop);
 }
 
 GenerationalFileAppender::~GenerationalFileAppender()
 {
+    cleanupHook();
 }
 
 bool GenerationalFileAppender::configureHook()
@@ -39,36 +75,83 @@ bool GenerationalFileAppender::configureHook()
                    << endlog();
         return false;
     }
-    maxEventsPerCycle = m;
+    if ((0 > maxGenerations_prop.rvalue()))
+    {
+        log(Error) << "Invalid MaxGenerations value of "
+                   << maxGenerations_prop.rvalue() << ". Value must be >= 0."
+                   << endlog();
+        return false;
+    }
+
+    OCL::logging::Layout* l = 0;
+    if (!createNativeLayout(l))
+        return false;
 
-    // \todo error checking
+    // in case the filename changed...
+    cleanupHook();
 
-    appender = new log4cpp::GenerationalFileAppender(getName(),
-													 filename_prop.get());
+    if (!file.open(filename_prop.rvalue(), RolloverFile::Generational,
+                   maxGenerations_prop.rvalue(),
+                   compressCommand_prop.rvalue(), compressSuffix_prop.rvalue()))
+    {
+        delete l;
+        return false;
+    }
 
-    return configureLayout();
+    maxEventsPerCycle   = m;
+    advancePending      = false;
+    layout              = l;
+    updateStatistics();
+    return true;
 }
 
 void GenerationalFileAppender::updateHook()
 {
 	processEvents(maxEventsPerCycle);
+    writeBuffer();
+    if (advancePending && file.rollover())
+    {
+        advancePending = false;
+    }
+    updateStatistics();
+}
+
+void GenerationalFileAppender::stopHook()
+{
+    Appender::stopHook();
+    writeBuffer();
+    updateStatistics();
 }
 
 void GenerationalFileAppender::cleanupHook()
 {
-    /* normally in log4cpp the category owns the appenders and deletes them
-       itself, however we don't associate appenders and categories in the
-       same manner. Hence, you have to manually manage appenders.
-    */
-    delete appender;
-    appender = 0;
+    if (file.isOpen())
+    {
+        writeBuffer();
+        // waits until the last generation is compressed
+        file.close();
+    }
+    delete layout;
+    layout = 0;
+}
+
+void GenerationalFileAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    layout->format(event, buffer);
+}
+
+bool GenerationalFileAppender::hasOutput() const
+{
+    return (0 != layout) && file.isOpen();
 }
 
 void GenerationalFileAppender::advanceGeneration()
 {
-	if (0 != appender)
+	if (file.isOpen())
 	{
-		static_cast<log4cpp::GenerationalFileAppender*>(appender)->advanceGeneration();
+        // the events so far belong to the current generation
+        writeBuffer();
+        advancePending = !file.rollover();
 	}
 	else
 	{
@@ -76,6 +159,28 @@ void GenerationalFileAppender::advanceGeneration()
 	}
 }
 
+void GenerationalFileAppender::writeBuffer()
+{
+    if (buffer.empty())
+        return;
+    if (!file.write(buffer.data(), buffer.size()))
+    {
+        log(Error) << "Could not write to " << filename_prop.rvalue() << endlog();
+    }
+    buffer.clear();
+}
+
+void GenerationalFileAppender::updateStatistics()
+{
+    const RolloverFile::Statistics s = file.getStatistics();
+    rollovers_prop              = s.rollovers;
+    deferredRollovers_prop      = s.deferred;
+    rolloverTime_prop           = s.lastSwitch;
+    worstRolloverTime_prop      = s.worstSwitch;
+    backgroundTime_prop         = s.lastBackground;
+    worstBackgroundTime_prop    = s.worstBackground;
+}
+
 // namespaces
 }
 }
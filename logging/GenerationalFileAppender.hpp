@@ -2,6 +2,7 @@
 #define	GENERATIONALFILEAPPENDER_HPP 1
 
 #include "Appender.hpp"
+#include "RolloverFile.hpp"
 #include <rtt/Property.hpp>
 
 namespace OCL {
@@ -9,7 +10,17 @@ namespace logging {
 
 /** Appender supporting generations of log files
 
-	Each new generation is logged to a new file
+	Each new generation is logged to a new file, \a Filename.0 for the first
+	generation, \a Filename.1 for the next and so on.
+
+	The file of the next generation is opened ahead of time, so advancing
+	only switches files. Old generations are closed, compressed and deleted
+	in a background thread (see RolloverFile). The time taken is available
+	in the statistics properties.
+
+    Events are formatted with a native layout (see Layout). Without a
+    layout name the "basic" layout is used, like the log4cpp file appender
+    does.
 */
 class GenerationalFileAppender : public OCL::logging::Appender
 {
@@ -17,24 +28,48 @@ public:
 	GenerationalFileAppender(std::string name);
 	virtual ~GenerationalFileAppender();
 protected:
-	/// Create log4cpp appender
+	/// Open the file and create the layout
     virtual bool configureHook();
 	/// Process at most \a maxEventsPerCycle event
 	virtual void updateHook();
-	/// Destroy appender
+	/// Drain the buffer and write it out
+	virtual void stopHook();
+	/// Close the files
 	virtual void cleanupHook();
 
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
 	/// @copydoc OCL::logging::advanceGeneration()
 	RTT::Operation<void(void)>		advanceGeneration_op;
-	/// Advance to the next logfile generation
+	/** Advance to the next logfile generation. When its file is not open
+		yet, advance as soon as it is.
+	*/
 	void advanceGeneration();
 
+    /// Write out the buffer
+    void writeBuffer();
+    /// Copy the rollover statistics to their properties
+    void updateStatistics();
+
     /// Name of file to append to
     RTT::Property<std::string>      filename_prop;
     /**
      * Property to set maximum number of log events to pop per cycle
      */
     RTT::Property<int>              maxEventsPerCycle_prop;
+    /// Number of old generations to keep, 0 for all
+    RTT::Property<int>              maxGenerations_prop;
+    /// Command compressing old generations, and the suffix it adds
+    RTT::Property<std::string>      compressCommand_prop;
+    RTT::Property<std::string>      compressSuffix_prop;
+    /// Rollover statistics (read-only)
+    RTT::Property<int>              rollovers_prop;
+    RTT::Property<int>              deferredRollovers_prop;
+    RTT::Property<double>           rolloverTime_prop;
+    RTT::Property<double>           worstRolloverTime_prop;
+    RTT::Property<double>           backgroundTime_prop;
+    RTT::Property<double>           worstBackgroundTime_prop;
 
     /**
      * Maximum number of log events to pop per cycle
@@ -46,6 +81,13 @@ protected:
      * starvation!
      */
     int								maxEventsPerCycle;
+    /// Whether an advance waits for the next file
+    bool                            advancePending;
+
+    OCL::logging::Layout*           layout;
+    /// Formatted events of this cycle
+    std::string                     buffer;
+    RolloverFile                    file;
 };
 
 // namespaces
@@ -0,0 +1,54 @@
+#include "InternTable.hpp"
+#include <rtt/os/MutexLock.hpp>
+
+namespace OCL {
+namespace logging {
+
+InternTable::InternTable(const std::string& overflow) :
+        count(0)
+{
+    for (unsigned int i = 0; i < Chunks; ++i)
+        chunks[i] = 0;
+    intern("");
+    intern(overflow);
+}
+
+InternTable::~InternTable()
+{
+    for (unsigned int i = 0; i < Chunks; ++i)
+        delete[] chunks[i];
+}
+
+unsigned int InternTable::intern(const std::string& str)
+{
+    RTT::os::MutexLock l(lock);
+    std::map<std::string, unsigned int>::const_iterator it = ids.find(str);
+    if (it != ids.end())
+        return it->second;
+
+    unsigned int id = count.read();
+    if (Capacity == id)
+        return Overflow;
+    if (0 == chunks[id / ChunkSize])
+        chunks[id / ChunkSize] = new std::string[ChunkSize];
+    chunks[id / ChunkSize][id % ChunkSize] = str;
+    ids[str] = id;
+    count.inc();
+    return id;
+}
+
+const char* InternTable::get(unsigned int id) const
+{
+    if (id >= (unsigned int)count.read())
+        return "";
+    return chunks[id / ChunkSize][id % ChunkSize].c_str();
+}
+
+unsigned int InternTable::size() const
+{
+    return count.read();
+}
+
+// namespaces
+}
+}
@@ -0,0 +1,63 @@
+#ifndef	INTERNTABLE_HPP
+#define	INTERNTABLE_HPP 1
+
+#include <string>
+#include <map>
+#include <rtt/os/Atomic.hpp>
+#include <rtt/os/Mutex.hpp>
+
+namespace OCL {
+namespace logging {
+
+/** A table of strings which are each given a small, stable id.
+    Strings are never removed. They are stored in chunks which are never
+    moved or freed, so looking up a string by id needs no lock.
+
+    Id 0 is the empty string. Id Overflow is the string given to the
+    constructor, and is returned for strings which no longer fit.
+*/
+class InternTable
+{
+public:
+    enum { ChunkSize = 256, Chunks = 256, Capacity = ChunkSize * Chunks };
+    /// Id of the strings which were added when the table was full
+    enum { Overflow = 1 };
+
+    /** \param overflow The string of id Overflow, which must not be empty
+        \warning Not real-time capable
+    */
+    explicit InternTable(const std::string& overflow);
+    ~InternTable();
+
+    /** Get the id of \a str, adding it if needed.
+        \return the id, or Overflow when the table is full
+        \warning Not real-time capable
+    */
+    unsigned int intern(const std::string& str);
+
+    /** Get the string with \a id.
+        \return the string, or "" for an unknown id
+        \note Real-time capable and lock-free
+    */
+    const char* get(unsigned int id) const;
+
+    /// Number of strings in the table
+    unsigned int size() const;
+
+private:
+    RTT::os::Mutex                      lock;
+    std::map<std::string, unsigned int> ids;
+    std::string*                        chunks[Chunks];
+    /// Strings are published by incrementing count after they were stored
+    RTT::os::AtomicInt                  count;
+
+    /* prevent copying and assignment */
+    InternTable(const InternTable& other);
+    InternTable& operator=(const InternTable& other);
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -0,0 +1,385 @@
+#include "Layout.hpp"
+#include <log4cpp/Priority.hh>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+void appendInt(std::string& out, long value)
+{
+    char buffer[24];
+    int n = snprintf(buffer, sizeof(buffer), "%ld", value);
+    out.append(buffer, n);
+}
+
+/// The wall time of \a event in seconds
+long wallSeconds(const LoggingEvent& event)
+{
+    boost::int64_t  seconds;
+    int             microseconds;
+    EventClock::toWallTime(event.timeStamp, seconds, microseconds);
+    return seconds;
+}
+
+class LiteralComponent : public PatternLayout::Component
+{
+public:
+    LiteralComponent(const std::string& literal) : literal(literal) {}
+    virtual void append(const LoggingEvent&, std::string& out) { out += literal; }
+    std::string literal;
+};
+
+class CategoryComponent : public PatternLayout::Component
+{
+public:
+    /// \param precision Number of trailing name components to keep, or 0 for all
+    CategoryComponent(int precision) : precision(precision) {}
+    virtual void append(const LoggingEvent& event, std::string& out)
+    {
+        const char* name = event.getCategoryName();
+        if (0 < precision)
+        {
+            const char* begin = name + strlen(name);
+            int         n = 0;
+            while ((begin != name) && (n < precision))
+            {
+                --begin;
+                if (('.' == *begin) && (++n == precision))
+                {
+                    ++begin;
+                    break;
+                }
+            }
+            name = begin;
+        }
+        out += name;
+    }
+    int precision;
+};
+
+/** Formats the time stamp with strftime(), plus "%l" for milliseconds.
+    The formatted second is cached, as most events share it with the
+    previous one.
+*/
+class DateComponent : public PatternLayout::Component
+{
+public:
+    DateComponent(const std::string& format) : seconds(-1)
+    {
+        std::string f = format;
+        if (f.empty() || ("ISO8601" == f))
+            f = "%Y-%m-%d %H:%M:%S,%l";
+        else if ("ABSOLUTE" == f)
+            f = "%H:%M:%S,%l";
+        else if ("DATE" == f)
+            f = "%d %b %Y %H:%M:%S,%l";
+
+        std::string::size_type begin = 0, end;
+        while (std::string::npos != (end = f.find("%l", begin)))
+        {
+            parts.push_back(f.substr(begin, end - begin));
+            begin = end + 2;
+        }
+        parts.push_back(f.substr(begin));
+        formatted.resize(parts.size());
+    }
+
+    virtual void append(const LoggingEvent& event, std::string& out)
+    {
+        boost::int64_t  s;
+        int             us;
+        EventClock::toWallTime(event.timeStamp, s, us);
+        if (s != seconds)
+        {
+            seconds = s;
+            time_t      t = seconds;
+            struct tm   tm;
+            localtime_r(&t, &tm);
+            for (std::size_t i = 0; i < parts.size(); ++i)
+            {
+                char buffer[128];
+                std::size_t n = parts[i].empty() ? 0 :
+                    strftime(buffer, sizeof(buffer), parts[i].c_str(), &tm);
+                formatted[i].assign(buffer, n);
+            }
+        }
+
+        char ms[4];
+        snprintf(ms, sizeof(ms), "%03d", us / 1000);
+        for (std::size_t i = 0; i < formatted.size(); ++i)
+        {
+            if (0 != i)
+                out.append(ms, 3);
+            out += formatted[i];
+        }
+    }
+
+    /// The format, split at each "%l"
+    std::vector<std::string>    parts;
+    /// \a parts formatted for \a seconds
+    std::vector<std::string>    formatted;
+    boost::int64_t              seconds;
+};
+
+class MessageComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent& event, std::string& out) { event.formatMessage(out); }
+};
+
+class PriorityComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent& event, std::string& out)
+    {
+        out += log4cpp::Priority::getPriorityName(event.priority);
+    }
+};
+
+class MillisSinceStartComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent& event, std::string& out)
+    {
+        appendInt(out, (event.timeStamp - EventClock::startTime()) / 1000000);
+    }
+};
+
+class SecondsComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent& event, std::string& out)
+    {
+        appendInt(out, wallSeconds(event));
+    }
+};
+
+class ThreadComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent& event, std::string& out) { out += event.getThreadName(); }
+};
+
+class ClockComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent&, std::string& out) { appendInt(out, std::clock()); }
+};
+
+class NdcComponent : public PatternLayout::Component
+{
+public:
+    virtual void append(const LoggingEvent& event, std::string& out) { out += event.ndc; }
+};
+
+}
+
+Layout::~Layout()
+{
+}
+
+Layout* Layout::create(const std::string& name, const std::string& pattern)
+{
+    if (0 == name.compare("basic"))
+    {
+        return new BasicLayout();
+    }
+    else if (0 == name.compare("simple"))
+    {
+        return new SimpleLayout();
+    }
+    else if (0 == name.compare("pattern"))
+    {
+        PatternLayout* layout = new PatternLayout();
+        if (!pattern.empty() && !layout->setConversionPattern(pattern))
+        {
+            delete layout;
+            return 0;
+        }
+        return layout;
+    }
+    return 0;
+}
+
+void SimpleLayout::format(const OCL::logging::LoggingEvent& event, std::string& out)
+{
+    const std::string& name = log4cpp::Priority::getPriorityName(event.priority);
+    out += name;
+    if (name.size() < (std::size_t)log4cpp::Priority::MESSAGE_SIZE)
+    {
+        out.append(log4cpp::Priority::MESSAGE_SIZE - name.size(), ' ');
+    }
+    out += ": ";
+    event.formatMessage(out);
+    out += '\n';
+}
+
+void BasicLayout::format(const OCL::logging::LoggingEvent& event, std::string& out)
+{
+    appendInt(out, wallSeconds(event));
+    out += ' ';
+    out += log4cpp::Priority::getPriorityName(event.priority);
+    out += ' ';
+    out += event.getCategoryName();
+    out += ' ';
+    out += event.ndc;
+    out += ": ";
+    event.formatMessage(out);
+    out += '\n';
+}
+
+const char* PatternLayout::DefaultPattern = "%m%n";
+
+PatternLayout::PatternLayout()
+{
+    setConversionPattern(DefaultPattern);
+}
+
+PatternLayout::~PatternLayout()
+{
+    clear(components);
+}
+
+void PatternLayout::clear(std::vector<Component*>& components)
+{
+    std::vector<Component*>::iterator it;
+    for (it = components.begin(); it != components.end(); ++it)
+    {
+        delete *it;
+    }
+    components.clear();
+}
+
+bool PatternLayout::setConversionPattern(const std::string& pattern)
+{
+    std::vector<Component*> parsed;
+    std::string             literal;
+    std::string::size_type  i = 0;
+    while (i < pattern.size())
+    {
+        char c = pattern[i++];
+        if (('%' != c) || (i == pattern.size()))
+        {
+            literal += c;
+            continue;
+        }
+        if ('%' == pattern[i])
+        {
+            literal += '%';
+            ++i;
+            continue;
+        }
+        if ('n' == pattern[i])
+        {
+            literal += '\n';
+            ++i;
+            continue;
+        }
+
+        // format modifiers
+        bool        leftAlign = false;
+        std::size_t minWidth = 0, maxWidth = 0;
+        if ('-' == pattern[i])
+        {
+            leftAlign = true;
+            ++i;
+        }
+        while ((i < pattern.size()) && isdigit(pattern[i]))
+            minWidth = minWidth * 10 + (pattern[i++] - '0');
+        if ((i < pattern.size()) && ('.' == pattern[i]))
+        {
+            ++i;
+            while ((i < pattern.size()) && isdigit(pattern[i]))
+                maxWidth = maxWidth * 10 + (pattern[i++] - '0');
+        }
+        if (i == pattern.size())
+        {
+            clear(parsed);
+            return false;
+        }
+
+        char        conversion = pattern[i++];
+        std::string argument;
+        if ((i < pattern.size()) && ('{' == pattern[i]))
+        {
+            std::string::size_type end = pattern.find('}', i);
+            if (std::string::npos == end)
+            {
+                clear(parsed);
+                return false;
+            }
+            argument = pattern.substr(i + 1, end - i - 1);
+            i = end + 1;
+        }
+
+        Component* component = 0;
+        switch (conversion)
+        {
+        case 'c': component = new CategoryComponent(atoi(argument.c_str())); break;
+        case 'd': component = new DateComponent(argument); break;
+        case 'm': component = new MessageComponent(); break;
+        case 'p': component = new PriorityComponent(); break;
+        case 'r': component = new MillisSinceStartComponent(); break;
+        case 'R': component = new SecondsComponent(); break;
+        case 't': component = new ThreadComponent(); break;
+        case 'u': component = new ClockComponent(); break;
+        case 'x': component = new NdcComponent(); break;
+        default:
+            clear(parsed);
+            return false;
+        }
+        component->minWidth     = minWidth;
+        component->maxWidth     = maxWidth;
+        component->leftAlign    = leftAlign;
+
+        if (!literal.empty())
+        {
+            parsed.push_back(new LiteralComponent(literal));
+            literal.clear();
+        }
+        parsed.push_back(component);
+    }
+    if (!literal.empty())
+    {
+        parsed.push_back(new LiteralComponent(literal));
+    }
+
+    clear(components);
+    components.swap(parsed);
+    return true;
+}
+
+void PatternLayout::format(const OCL::logging::LoggingEvent& event, std::string& out)
+{
+    std::vector<Component*>::const_iterator it;
+    for (it = components.begin(); it != components.end(); ++it)
+    {
+        Component* c = *it;
+        const std::string::size_type start = out.size();
+        c->append(event, out);
+
+        std::size_t length = out.size() - start;
+        if ((0 != c->maxWidth) && (length > c->maxWidth))
+        {
+            out.erase(start + c->maxWidth);
+            length = c->maxWidth;
+        }
+        if (length < c->minWidth)
+        {
+            if (c->leftAlign)
+                out.append(c->minWidth - length, ' ');
+            else
+                out.insert(start, c->minWidth - length, ' ');
+        }
+    }
+}
+
+// namespaces
+}
+}
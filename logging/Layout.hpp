@@ -0,0 +1,95 @@
+#ifndef	LAYOUT_HPP
+#define	LAYOUT_HPP 1
+
+#include "LoggingEvent.hpp"
+#include <string>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+/** Formats OCL logging events, without converting them to log4cpp
+    events first. The output is the same as that of the log4cpp layout
+    with the same name.
+    \warning Not real-time capable. A layout is used by one appender
+    thread only.
+*/
+class Layout
+{
+public:
+    virtual ~Layout();
+
+    /// Append \a event, formatted, to \a out
+    virtual void format(const OCL::logging::LoggingEvent& event, std::string& out) = 0;
+
+    /** Create the layout named \a name ("simple", "basic" or "pattern"),
+        with \a pattern as conversion pattern for a "pattern" layout.
+        \return the layout, which the caller owns, or 0 if \a name is
+        unknown or \a pattern is invalid
+    */
+    static Layout* create(const std::string& name, const std::string& pattern);
+};
+
+/// Formats as "priority: message\n", with the priority padded to
+/// log4cpp::Priority::MESSAGE_SIZE characters as log4cpp does
+class SimpleLayout : public Layout
+{
+public:
+    virtual void format(const OCL::logging::LoggingEvent& event, std::string& out);
+};
+
+/// Formats as "seconds priority category ndc: message\n"
+class BasicLayout : public Layout
+{
+public:
+    virtual void format(const OCL::logging::LoggingEvent& event, std::string& out);
+};
+
+/** Formats according to a log4cpp conversion pattern, which is parsed
+    once when set. Supports the same conversions as log4cpp:
+    %c{n}, %d{format}, %m, %n, %p, %r, %R, %t, %u, %x and %%, with
+    optional minimum and maximum width, eg "%-5.10p".
+*/
+class PatternLayout : public Layout
+{
+public:
+    /// The pattern used if none is set
+    static const char* DefaultPattern;
+
+    PatternLayout();
+    virtual ~PatternLayout();
+
+    /** Parse and use \a pattern
+        \return false if \a pattern is invalid, in which case the
+        current pattern is kept
+    */
+    bool setConversionPattern(const std::string& pattern);
+
+    virtual void format(const OCL::logging::LoggingEvent& event, std::string& out);
+
+    /// One part of a pattern
+    class Component
+    {
+    public:
+        Component() : minWidth(0), maxWidth(0), leftAlign(false) {}
+        virtual ~Component() {}
+        /// Append the part of \a event to \a out
+        virtual void append(const OCL::logging::LoggingEvent& event, std::string& out) = 0;
+
+        std::size_t minWidth;
+        /// 0 for no maximum
+        std::size_t maxWidth;
+        bool        leftAlign;
+    };
+
+protected:
+    void clear(std::vector<Component*>& components);
+
+    std::vector<Component*> components;
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -2,6 +2,10 @@
 #include "log4cxx/spi/loggingevent.h"
 #include "rtt/Component.hpp"
 #include <rtt/Logger.hpp>
+#include <rtt/Activity.hpp>
+#include <rtt/base/RunnableInterface.hpp>
+#include <rtt/os/MutexLock.hpp>
+#include <algorithm>
 
 using namespace RTT;
 
@@ -35,27 +39,76 @@ namespace logging {
         return Level::getDebug();
     }
 
-    spi::LoggingEventPtr tolog4cxx(logging::LoggingEvent const& e, log4cxx::helpers::Pool & pool)
+    spi::LoggingEventPtr tolog4cxx(logging::LoggingEvent const& e, std::string const& message)
     {
-        return spi::LoggingEventPtr(new spi::LoggingEvent(makeString( e.categoryName ), tolog4cxxLevel(e.priority), makeString( e.message ), log4cxx::spi::LocationInfo("filename", "functionname", 0)));
+        return spi::LoggingEventPtr(new spi::LoggingEvent(e.getCategoryName(), tolog4cxxLevel(e.priority), message, log4cxx::spi::LocationInfo("filename", "functionname", 0)));
     }
 
+/**
+ * Runs sendEvents() in the sender thread.
+ */
+class Log4cxxAppender::Sender : public RTT::base::RunnableInterface
+{
+public:
+    Sender(Log4cxxAppender* owner) : owner(owner) {}
+
+    virtual bool initialize() { return true; }
+    virtual void step() {}
+    virtual void loop() { owner->sendEvents(); }
+    virtual bool breakLoop() { owner->stopSending(); return true; }
+    virtual void finalize() {}
+
+    Log4cxxAppender* owner;
+};
+
 Log4cxxAppender::Log4cxxAppender(std::string name) :
     RTT::TaskContext(name,RTT::TaskContext::PreOperational),
         socketAppender(0),
         hostname_prop("localhost"), port_prop(4560),
         maxEventsPerCycle_prop(0),
-        maxEventsPerCycle(0)
+        maxEventsPerCycle(0),
+        queueCapacity_prop(1000),
+        batchSize_prop(100),
+        overflowPolicy_prop("drop-newest"),
+        dropOldest(false),
+        queueDepth_prop(0),
+        droppedEvents_prop(0),
+        eventsSent_prop(0),
+        sendLatency_prop(0.0),
+        worstSendLatency_prop(0.0),
+        sender(0),
+        sender_activity(0),
+        queue_head(0),
+        queue_size(0),
+        stopping(false),
+        dropped(0),
+        sent(0),
+        lastLatency(0.0),
+        worstLatency(0.0)
 {
 
     ports()->addEventPort("LogPort", log_port );
     properties()->addProperty("Hostname",hostname_prop).doc("Host name where ChainSaw or other logging server runs.");
     properties()->addProperty("MaxEventsPerCycle",maxEventsPerCycle_prop).doc("Maximum number of log events to pop per cycle");
     properties()->addProperty("Port", port_prop).doc("Logging server port to use on Hostname. ChainSaw uses port 4560.");
+    properties()->addProperty("QueueCapacity", queueCapacity_prop).doc("Number of events in the queue of the sender thread.");
+    properties()->addProperty("BatchSize", batchSize_prop).doc("Maximum number of events the sender thread sends at once.");
+    properties()->addProperty("OverflowPolicy", overflowPolicy_prop).doc("What to drop when the queue of the sender thread is full: 'drop-newest' or 'drop-oldest'.");
+    properties()->addProperty("QueueDepth", queueDepth_prop).doc("Events in the queue of the sender thread after the last cycle (read-only).");
+    properties()->addProperty("DroppedEvents", droppedEvents_prop).doc("Events dropped as the queue of the sender thread was full (read-only).");
+    properties()->addProperty("EventsSent", eventsSent_prop).doc("Events sent since start (read-only).");
+    properties()->addProperty("SendLatency", sendLatency_prop).doc("Average time between logging and sending the events of the last batch, in seconds (read-only).");
+    properties()->addProperty("WorstSendLatency", worstSendLatency_prop).doc("Highest time between logging and sending an event since start, in seconds (read-only).");
 }
 
 Log4cxxAppender::~Log4cxxAppender()
 {
+    if (sender_activity)
+    {
+        sender_activity->stop();
+    }
+    delete sender_activity;
+    delete sender;
 }
 
 bool Log4cxxAppender::configureHook()
@@ -71,6 +124,37 @@ bool Log4cxxAppender::configureHook()
     }
     maxEventsPerCycle = m;
 
+    if ((0 >= queueCapacity_prop) || (0 >= batchSize_prop))
+    {
+        log(Error) << "Invalid QueueCapacity or BatchSize value of "
+                   << queueCapacity_prop << " or " << batchSize_prop
+                   << ". Values must be > 0." << endlog();
+        return false;
+    }
+    if ("drop-newest" == overflowPolicy_prop)
+    {
+        dropOldest = false;
+    }
+    else if ("drop-oldest" == overflowPolicy_prop)
+    {
+        dropOldest = true;
+    }
+    else
+    {
+        log(Error) << "Invalid OverflowPolicy '" << overflowPolicy_prop
+                   << "'. Value must be 'drop-newest' or 'drop-oldest'." << endlog();
+        return false;
+    }
+    queue.resize(queueCapacity_prop);
+    batch.resize(batchSize_prop);
+    queue_head = queue_size = 0;
+
+    if (!sender)
+    {
+        sender          = new Sender(this);
+        sender_activity = new RTT::Activity(ORO_SCHED_OTHER, 0, 0, sender, getName() + ".Sender");
+    }
+
     // \todo error checking
     if ( hostname_prop == "localhost")
         address = helpers::InetAddress::getLocalHost();
@@ -92,7 +176,44 @@ bool Log4cxxAppender::configureHook()
     return true;
 }
 
+bool Log4cxxAppender::startHook()
+{
+    {
+        RTT::os::MutexLock lock(queue_lock);
+        stopping        = false;
+        dropped         = 0;
+        sent            = 0;
+        lastLatency     = 0.0;
+        worstLatency    = 0.0;
+    }
+    return sender_activity->start();
+}
+
 void Log4cxxAppender::updateHook()
+{
+    queueEvents(maxEventsPerCycle);
+    updateStatistics();
+}
+
+void Log4cxxAppender::stopHook()
+{
+    queueEvents(0);
+    // returns once the queued events are sent
+    sender_activity->stop();
+    updateStatistics();
+}
+
+void Log4cxxAppender::updateStatistics()
+{
+    RTT::os::MutexLock lock(queue_lock);
+    queueDepth_prop         = queue_size;
+    droppedEvents_prop      = dropped;
+    eventsSent_prop         = sent;
+    sendLatency_prop        = lastLatency;
+    worstSendLatency_prop   = worstLatency;
+}
+
+void Log4cxxAppender::queueEvents(int n)
 {
     if (!log_port.connected()) return;      // no category connected to us
 
@@ -101,46 +222,78 @@ void Log4cxxAppender::updateHook()
        b) we consume too many events on one cycle
      */
     OCL::logging::LoggingEvent   event;
-    assert(socketAppender);
-    assert(0 <= maxEventsPerCycle);
-    if (0 == maxEventsPerCycle)
+    assert(0 <= n);
+    int count = 0;
+    while (((0 == n) || (count < n)) && (log_port.read( event ) == NewData))
     {
-        // consume infinite events
-        for (;;)
+        ++count;
+        RTT::os::MutexLock lock(queue_lock);
+        if (queue_size == queue.size())
         {
-            if (log_port.read( event ) == NewData)
-            {
-                spi::LoggingEventPtr e2 = tolog4cxx( event, p );
-                socketAppender->doAppend(e2, p);
-            }
-            else
+            ++dropped;
+            if (!dropOldest)
             {
-                break;      // nothing to do
+                continue;
             }
+            queue_head = (queue_head + 1) % queue.size();
+            --queue_size;
         }
+        queue[(queue_head + queue_size) % queue.size()] = event;
+        ++queue_size;
+        queue_cond.broadcast();
     }
-    else
-    {
+}
 
-        // consume up to maxEventsPerCycle events
-        int n       = maxEventsPerCycle;
-        do
+void Log4cxxAppender::sendEvents()
+{
+    std::string message;
+    for (;;)
+    {
+        unsigned int n = 0;
         {
-            if (log_port.read( event ) == NewData)
+            RTT::os::MutexLock lock(queue_lock);
+            while ((0 == queue_size) && !stopping)
             {
-                spi::LoggingEventPtr e2 = tolog4cxx( event, p );
-                socketAppender->doAppend(e2, p);
+                queue_cond.wait(queue_lock);
             }
-            else
+            if (0 == queue_size)
             {
-                break;      // nothing to do
+                return;     // stopping, and all events are sent
             }
-            --n;
+            while ((n < batch.size()) && (0 < queue_size))
+            {
+                batch[n++] = queue[queue_head];
+                queue_head = (queue_head + 1) % queue.size();
+                --queue_size;
+            }
+        }
+
+        double total = 0.0;
+        double worst = 0.0;
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            message.clear();
+            batch[i].formatMessage(message);
+            socketAppender->doAppend(tolog4cxx(batch[i], message), p);
+            double latency = (EventClock::now() - batch[i].timeStamp) / 1e9;
+            total += latency;
+            worst = std::max(worst, latency);
         }
-        while (0 < n);
+
+        RTT::os::MutexLock lock(queue_lock);
+        sent        += n;
+        lastLatency  = total / n;
+        worstLatency = std::max(worstLatency, worst);
     }
 }
 
+void Log4cxxAppender::stopSending()
+{
+    RTT::os::MutexLock lock(queue_lock);
+    stopping = true;
+    queue_cond.broadcast();
+}
+
 void Log4cxxAppender::cleanupHook()
 {
     /* normally in log4cpp the category owns the appenders and deletes them
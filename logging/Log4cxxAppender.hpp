@@ -5,6 +5,9 @@
 #include <rtt/Property.hpp>
 #include <rtt/InputPort.hpp>
 #include "LoggingEvent.hpp"
+#include <rtt/os/Mutex.hpp>
+#include <rtt/os/Condition.hpp>
+#include <vector>
 #include <log4cxx/logger.h>
 #include <log4cxx/helpers/pool.h>
 #include <log4cxx/basicconfigurator.h>
@@ -30,12 +33,23 @@ log4cxx::Log4cxxAppender(log4cxx::LayoutPtr(new log4cxx::SimpleLayout()),
 }
 #endif
 
+// forward declare
+namespace RTT {
+class Activity;
+}
+
 namespace OCL {
 namespace logging {
 
 /**
  * Interoperability component which translates our log4cpp events to
  * log4cxx events and sends them to a network/socket appender.
+ *
+ * The component only copies the events it receives into a bounded send
+ * queue, and never waits for the network. A sender thread takes the
+ * queued events in batches, converts them and sends them. When the queue
+ * is full, the OverflowPolicy decides whether the newest or the oldest
+ * events are dropped.
  */
 class Log4cxxAppender
     : public RTT::TaskContext
@@ -45,9 +59,24 @@ public:
 	virtual ~Log4cxxAppender();
 protected:
     virtual bool configureHook();
+    /// Start the sender thread
+    virtual bool startHook();
 	virtual void updateHook();
+    /// Queue the remaining events, and stop the sender once they are sent
+    virtual void stopHook();
 	virtual void cleanupHook();
 
+    /** Move at most \a n events from \a log_port to the send queue,
+        or all events if \a n is 0.
+    */
+    void queueEvents(int n);
+    /// Send the queued events until stopped, in the sender thread
+    void sendEvents();
+    /// Copy the statistics of the sender to their properties
+    void updateStatistics();
+    /// Make sendEvents() return once the queue is empty
+    void stopSending();
+
 	log4cxx::helpers::Pool p;
 	log4cxx::net::SocketAppender * socketAppender;
 	log4cxx::helpers::InetAddressPtr address;
@@ -76,6 +105,47 @@ protected:
      * starvation!
      */
     int                           maxEventsPerCycle;
+
+    /// Number of events in the send queue
+    int              queueCapacity_prop;
+    /// Maximum number of events the sender takes from the queue at once
+    int              batchSize_prop;
+    /// What to drop when the send queue is full: "drop-newest" or "drop-oldest"
+    std::string      overflowPolicy_prop;
+    bool             dropOldest;
+
+    // statistics, updated each cycle (read-only)
+    /// Events in the send queue after the last cycle
+    int              queueDepth_prop;
+    /// Events dropped as the send queue was full
+    int              droppedEvents_prop;
+    /// Events sent since start
+    int              eventsSent_prop;
+    /// Average time between logging and sending the events of the last batch, in seconds
+    double           sendLatency_prop;
+    /// Highest time between logging and sending an event since start, in seconds
+    double           worstSendLatency_prop;
+
+    class Sender;
+    Sender*          sender;
+    RTT::Activity*   sender_activity;
+
+    /// Guards the send queue, \a stopping and the sender statistics
+    RTT::os::Mutex                          queue_lock;
+    /// Signalled when events are queued, or when stopping
+    RTT::os::Condition                      queue_cond;
+    /// Ring of queued events, starting at \a queue_head
+    std::vector<OCL::logging::LoggingEvent> queue;
+    unsigned int                            queue_head;
+    unsigned int                            queue_size;
+    /// Events taken from the queue by the sender, reused for every batch
+    std::vector<OCL::logging::LoggingEvent> batch;
+    bool                                    stopping;
+    // statistics of the sender
+    int                                     dropped;
+    int                                     sent;
+    double                                  lastLatency;
+    double                                  worstLatency;
 };
 
 // namespaces
@@ -0,0 +1,764 @@
+#include "LogIndex.hpp"
+#include "BinaryLog.hpp"
+#include "RingLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+const char IndexMagic[8] = { 'O', 'C', 'L', 'L', 'I', 'D', 'X', '1' };
+const boost::uint32_t IndexVersion = 1;
+
+/// Start of an index file, followed by the category names, the binary log
+/// category ids and formats, and the blocks. All values in host byte order.
+struct IndexHeader
+{
+    char            magic[8];
+    boost::uint32_t version;
+    boost::uint32_t format;
+    boost::uint64_t indexedSize;
+    boost::uint64_t hash;
+    boost::uint32_t hashSize;
+    boost::uint32_t reserved;
+};
+
+/// A block in an index file, followed by its category indexes
+struct BlockHeader
+{
+    boost::uint64_t offset;
+    boost::uint64_t size;
+    boost::int64_t  first;
+    boost::int64_t  last;
+    boost::uint32_t events;
+    boost::uint32_t priorities;
+    boost::uint32_t categoryCount;
+    boost::uint32_t reserved;
+};
+
+/// Number of bytes at the start of a file which identify it
+const boost::uint32_t HashSize = 4096;
+
+/// Names of the priorities 0, 100, .. 800, as log4cpp names them
+const char* const PriorityNames[] = {
+    "FATAL", "ALERT", "CRIT", "ERROR", "WARN", "NOTICE", "INFO", "DEBUG", "NOTSET"
+};
+
+int seekTo(std::FILE* file, boost::uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, SEEK_SET);
+#else
+    return fseeko(file, offset, SEEK_SET);
+#endif
+}
+
+boost::uint64_t fileSize(std::FILE* file)
+{
+#ifdef _WIN32
+    _fseeki64(file, 0, SEEK_END);
+    return _ftelli64(file);
+#else
+    fseeko(file, 0, SEEK_END);
+    return ftello(file);
+#endif
+}
+
+template<class T>
+void append(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& s)
+{
+    append(out, (boost::uint32_t)s.size());
+    out += s;
+}
+
+/// Reads the values written with append() from an index file
+class Reader
+{
+public:
+    Reader(const std::vector<char>& data) : data(data), pos(0) {}
+
+    template<class T>
+    bool read(T& value)
+    {
+        if (data.size() - pos < sizeof(value))
+            return false;
+        memcpy(&value, &data[pos], sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    bool readString(std::string& s)
+    {
+        boost::uint32_t size;
+        if (!read(size) || (data.size() - pos < size))
+            return false;
+        s.assign(data.begin() + pos, data.begin() + pos + size);
+        pos += size;
+        return true;
+    }
+
+    bool atEnd() const { return pos == data.size(); }
+
+private:
+    const std::vector<char>&    data;
+    std::size_t                 pos;
+};
+
+/// Parse \a n digits at \a p into \a value
+bool parseDigits(const char* p, int n, int& value)
+{
+    value = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if ((p[i] < '0') || ('9' < p[i]))
+            return false;
+        value = 10 * value + (p[i] - '0');
+    }
+    return true;
+}
+
+/** Parse a time at \a p, of at most \a size bytes, as "YYYY-MM-DD
+    HH:MM:SS" in local time or as seconds since the epoch
+    \return the number of bytes parsed, 0 if not a time
+*/
+std::size_t parseTimeAt(const char* p, std::size_t size, boost::int64_t& seconds)
+{
+    struct tm   tm;
+    memset(&tm, 0, sizeof(tm));
+    if ((19 <= size) && ('-' == p[4]) && ('-' == p[7]) &&
+        ((' ' == p[10]) || ('T' == p[10])) && (':' == p[13]) && (':' == p[16]) &&
+        parseDigits(p, 4, tm.tm_year) && parseDigits(p + 5, 2, tm.tm_mon) &&
+        parseDigits(p + 8, 2, tm.tm_mday) && parseDigits(p + 11, 2, tm.tm_hour) &&
+        parseDigits(p + 14, 2, tm.tm_min) && parseDigits(p + 17, 2, tm.tm_sec))
+    {
+        tm.tm_year  -= 1900;
+        tm.tm_mon   -= 1;
+        tm.tm_isdst = -1;
+        seconds     = mktime(&tm);
+        return 19;
+    }
+
+    std::size_t n = 0;
+    seconds = 0;
+    while ((n < size) && ('0' <= p[n]) && (p[n] <= '9'))
+    {
+        seconds = 10 * seconds + (p[n] - '0');
+        ++n;
+    }
+    return n;
+}
+
+}
+
+const std::size_t LogIndex::DefaultBlockSize = 1024 * 1024;
+
+LogIndex::Block::Block() :
+        offset(0),
+        size(0),
+        events(0),
+        first(0),
+        last(0),
+        priorities(0)
+{
+}
+
+LogIndex::Query::Query() :
+        from(0),
+        to(0x7fffffffffffffffLL),
+        priority(0x7fffffff)
+{
+}
+
+bool LogIndex::Query::matches(boost::int64_t seconds, int priority,
+                              const std::string& category) const
+{
+    return (from <= seconds) && (seconds <= to) && (priority <= this->priority) &&
+        matchesCategory(category);
+}
+
+bool LogIndex::Query::matchesCategory(const std::string& category) const
+{
+    if (categories.empty())
+        return true;
+    std::vector<std::string>::const_iterator it;
+    for (it = categories.begin(); it != categories.end(); ++it)
+    {
+        if ((0 == category.compare(0, it->size(), *it)) &&
+            ((category.size() == it->size()) || ('.' == category[it->size()])))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+LogIndex::LogIndex() :
+        format(TextFile),
+        indexedSize(0),
+        hash(0),
+        hashSize(0),
+        modified(false)
+{
+}
+
+std::string LogIndex::indexPath(const std::string& path)
+{
+    return path + ".idx";
+}
+
+boost::uint32_t LogIndex::priorityBit(int priority)
+{
+    const int bit = (priority < 0) ? 0 : std::min(priority / 100, 31);
+    return (boost::uint32_t)1 << bit;
+}
+
+bool LogIndex::parseTime(const std::string& time, boost::int64_t& seconds)
+{
+    return !time.empty() && (time.size() == parseTimeAt(time.data(), time.size(), seconds));
+}
+
+bool LogIndex::parseLine(const char* line, std::size_t size, boost::int64_t& seconds,
+                         int& priority, std::string& category)
+{
+    const char* end = line + size;
+    std::size_t n   = parseTimeAt(line, size, seconds);
+    if (0 == n)
+        return false;
+    const char* p = line + n;
+    // milliseconds of "%d"
+    if ((p < end) && ((',' == *p) || ('.' == *p)))
+    {
+        for (++p; (p < end) && ('0' <= *p) && (*p <= '9'); ++p)
+            ;
+    }
+    if ((p == end) || (' ' != *p))
+        return false;
+    ++p;
+    if ((p < end) && ('[' == *p))
+    {
+        p = std::find(p, end, ']');
+        if (p == end)
+            return false;
+        for (++p; (p < end) && (' ' == *p); ++p)
+            ;
+    }
+
+    const char* name = p;
+    p = std::find(p, end, ' ');
+    priority = -1;
+    for (unsigned int i = 0; i < sizeof(PriorityNames) / sizeof(PriorityNames[0]); ++i)
+    {
+        if (((std::size_t)(p - name) == strlen(PriorityNames[i])) &&
+            (0 == memcmp(name, PriorityNames[i], p - name)))
+        {
+            priority = 100 * i;
+            break;
+        }
+    }
+    if ((-1 == priority) && (5 == p - name) && (0 == memcmp(name, "EMERG", 5)))
+        priority = 0;
+    if (-1 == priority)
+        return false;
+
+    // "%-5p" pads the priority
+    for (; (p < end) && (' ' == *p); ++p)
+        ;
+    const char* c = p;
+    for (; (p < end) && (' ' != *p) && ('\n' != *p) && ('\r' != *p); ++p)
+        ;
+    if (p == c)
+        return false;
+    category.assign(c, p);
+    return true;
+}
+
+bool LogIndex::update(const std::string& path, std::size_t blockSize)
+{
+    error.clear();
+    modified = false;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (0 == file)
+    {
+        error = std::string("could not open file: ") + strerror(errno);
+        return false;
+    }
+    const boost::uint64_t size = fileSize(file);
+
+    // the binary formats start with their magic
+    BinaryLog::FileHeader header;
+    memset(&header, 0, sizeof(header));
+    seekTo(file, 0);
+    const std::size_t n = std::fread(&header, 1, sizeof(header), file);
+    const unsigned char* magic = reinterpret_cast<const unsigned char*>(header.magic);
+    FileFormat fileFormat = TextFile;
+    if ((sizeof(header) == n) && BinaryLog::checkHeader(header))
+    {
+        fileFormat = BinaryFile;
+    }
+    else if ((sizeof(header.magic) <= n) &&
+             (0 == memcmp(header.magic, RingLog::Magic, sizeof(RingLog::Magic))))
+    {
+        error = "ring files can not be indexed, use ocl-logdecode";
+    }
+    else if (((2 <= n) && (0x1f == magic[0]) && (0x8b == magic[1])) ||
+             ((6 <= n) && (0 == memcmp(magic, "\xfd" "7zXZ", 6))))
+    {
+        error = "compressed files can not be indexed, decompress it first";
+    }
+    if (!error.empty())
+    {
+        std::fclose(file);
+        return false;
+    }
+
+    this->path = path;
+    const boost::uint64_t oldSize = indexedSize;
+    if (!load(file, size) || (fileFormat != format))
+    {
+        clear(fileFormat);
+        modified = true;
+    }
+
+    // the last block may have grown, index it again
+    boost::uint64_t offset = (BinaryFile == format) ? sizeof(header) : 0;
+    if (!blocks.empty())
+    {
+        offset = blocks.back().offset;
+        blocks.pop_back();
+    }
+    bool ok = scan(file, offset, std::max<std::size_t>(blockSize, 1));
+    modified = modified || (oldSize != indexedSize);
+
+    // identifies the file, also once it is renamed
+    const boost::uint32_t newSize = (boost::uint32_t)std::min<boost::uint64_t>(size, HashSize);
+    boost::uint64_t newHash = 0;
+    ok = fingerprint(file, newSize, newHash) && ok;
+    if ((newSize != hashSize) || (newHash != hash))
+    {
+        hashSize    = newSize;
+        hash        = newHash;
+        modified    = true;
+    }
+    std::fclose(file);
+    return ok;
+}
+
+void LogIndex::clear(FileFormat format)
+{
+    this->format = format;
+    blocks.clear();
+    categories.clear();
+    categoryIndexes.clear();
+    binaryCategories.clear();
+    formats.clear();
+    indexedSize = 0;
+    hash        = 0;
+    hashSize    = 0;
+}
+
+bool LogIndex::fingerprint(std::FILE* file, boost::uint32_t size, boost::uint64_t& hash)
+{
+    std::vector<char> data(size);
+    if ((0 != seekTo(file, 0)) ||
+        ((0 != size) && (size != std::fread(&data[0], 1, size, file))))
+    {
+        return false;
+    }
+    // FNV-1a
+    hash = 14695981039346656037ULL;
+    for (boost::uint32_t i = 0; i < size; ++i)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return true;
+}
+
+bool LogIndex::load(std::FILE* file, boost::uint64_t fileSize)
+{
+    clear(TextFile);
+    std::FILE* in = std::fopen(indexPath(path).c_str(), "rb");
+    if (0 == in)
+        return false;
+    std::vector<char> data;
+    char chunk[64 * 1024];
+    std::size_t n;
+    while (0 < (n = std::fread(chunk, 1, sizeof(chunk), in)))
+        data.insert(data.end(), chunk, chunk + n);
+    std::fclose(in);
+
+    Reader          reader(data);
+    IndexHeader     header;
+    boost::uint32_t count;
+    if (!reader.read(header) ||
+        (0 != memcmp(header.magic, IndexMagic, sizeof(IndexMagic))) ||
+        (IndexVersion != header.version) ||
+        (fileSize < header.indexedSize) ||
+        (fileSize < header.hashSize))
+    {
+        return false;
+    }
+    // everything indexed is in the hashed part, or the hash is of
+    // HashSize bytes, so a matching hash means the same file
+    boost::uint64_t h;
+    if (!fingerprint(file, header.hashSize, h) || (h != header.hash))
+        return false;
+    format      = (FileFormat)header.format;
+    indexedSize = header.indexedSize;
+    hash        = header.hash;
+    hashSize    = header.hashSize;
+
+    bool ok = reader.read(count);
+    for (boost::uint32_t i = 0; ok && (i < count); ++i)
+    {
+        std::string name;
+        ok = reader.readString(name);
+        categoryIndex(name);
+    }
+    ok = ok && reader.read(count);
+    for (boost::uint32_t i = 0; ok && (i < count); ++i)
+    {
+        boost::uint32_t id, index;
+        ok = reader.read(id) && reader.read(index) && (index < categories.size());
+        binaryCategories[id] = index;
+    }
+    ok = ok && reader.read(count);
+    for (boost::uint32_t i = 0; ok && (i < count); ++i)
+    {
+        boost::uint32_t id;
+        ok = reader.read(id) && reader.readString(formats[id]);
+    }
+    ok = ok && reader.read(count);
+    for (boost::uint32_t i = 0; ok && (i < count); ++i)
+    {
+        BlockHeader h;
+        ok = reader.read(h);
+        Block block;
+        block.offset        = h.offset;
+        block.size          = h.size;
+        block.first         = h.first;
+        block.last          = h.last;
+        block.events        = h.events;
+        block.priorities    = h.priorities;
+        block.categories.resize(ok ? h.categoryCount : 0);
+        for (boost::uint32_t j = 0; ok && (j < h.categoryCount); ++j)
+        {
+            ok = reader.read(block.categories[j]) && (block.categories[j] < categories.size());
+        }
+        blocks.push_back(block);
+    }
+    if (!ok || !reader.atEnd())
+    {
+        clear(TextFile);
+        return false;
+    }
+    return true;
+}
+
+bool LogIndex::save() const
+{
+    std::string out;
+    IndexHeader header;
+    memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+    header.version      = IndexVersion;
+    header.format       = format;
+    header.indexedSize  = indexedSize;
+    header.hash         = hash;
+    header.hashSize     = hashSize;
+    header.reserved     = 0;
+    append(out, header);
+
+    append(out, (boost::uint32_t)categories.size());
+    std::vector<std::string>::const_iterator c;
+    for (c = categories.begin(); c != categories.end(); ++c)
+        appendString(out, *c);
+    append(out, (boost::uint32_t)binaryCategories.size());
+    std::map<boost::uint32_t, boost::uint32_t>::const_iterator b;
+    for (b = binaryCategories.begin(); b != binaryCategories.end(); ++b)
+    {
+        append(out, b->first);
+        append(out, b->second);
+    }
+    append(out, (boost::uint32_t)formats.size());
+    std::map<boost::uint32_t, std::string>::const_iterator f;
+    for (f = formats.begin(); f != formats.end(); ++f)
+    {
+        append(out, f->first);
+        appendString(out, f->second);
+    }
+    append(out, (boost::uint32_t)blocks.size());
+    std::vector<Block>::const_iterator it;
+    for (it = blocks.begin(); it != blocks.end(); ++it)
+    {
+        BlockHeader h;
+        h.offset        = it->offset;
+        h.size          = it->size;
+        h.first         = it->first;
+        h.last          = it->last;
+        h.events        = it->events;
+        h.priorities    = it->priorities;
+        h.categoryCount = it->categories.size();
+        h.reserved      = 0;
+        append(out, h);
+        for (std::size_t j = 0; j < it->categories.size(); ++j)
+            append(out, it->categories[j]);
+    }
+
+    const std::string name      = indexPath(path);
+    const std::string temporary = name + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (0 == file)
+        return false;
+    bool ok = (out.size() == std::fwrite(out.data(), 1, out.size(), file));
+    ok = (0 == std::fclose(file)) && ok;
+#ifdef _WIN32
+    // rename() does not replace an existing file
+    std::remove(name.c_str());
+#endif
+    ok = ok && (0 == std::rename(temporary.c_str(), name.c_str()));
+    if (!ok)
+        std::remove(temporary.c_str());
+    return ok;
+}
+
+bool LogIndex::isModified() const
+{
+    return modified;
+}
+
+bool LogIndex::scan(std::FILE* file, boost::uint64_t offset, std::size_t blockSize)
+{
+    if (0 != seekTo(file, offset))
+    {
+        error = std::string("could not seek: ") + strerror(errno);
+        return false;
+    }
+
+    std::vector<char>   data;
+    std::size_t         begin = 0;
+    char                chunk[64 * 1024];
+    bool                more = true;
+    Block               block;
+    block.offset = offset;
+    while (more && error.empty())
+    {
+        std::size_t n = std::fread(chunk, 1, sizeof(chunk), file);
+        more = (n == sizeof(chunk));
+        data.erase(data.begin(), data.begin() + begin);
+        data.insert(data.end(), chunk, chunk + n);
+        begin = 0;
+
+        bool    isEvent;
+        Event   event;
+        long    size;
+        while (begin < data.size())
+        {
+            size = (BinaryFile == format) ?
+                scanRecord(&data[begin], data.size() - begin, isEvent, event) :
+                scanLine(&data[begin], data.size() - begin, isEvent, event);
+            if (0 == size)
+                break;
+            if (0 > size)
+            {
+                // eg a partly written file, index up to here
+                error = "invalid record";
+                break;
+            }
+            // text blocks start with an event, so that the lines of an
+            // event are in one block
+            if ((blockSize <= block.size) && (isEvent || (BinaryFile == format)))
+            {
+                blocks.push_back(block);
+                block           = Block();
+                block.offset    = blocks.back().offset + blocks.back().size;
+            }
+            block.size += size;
+            begin      += size;
+            if (isEvent)
+            {
+                if ((0 == block.events) || (event.seconds < block.first))
+                    block.first = event.seconds;
+                if ((0 == block.events) || (block.last < event.seconds))
+                    block.last = event.seconds;
+                ++block.events;
+                block.priorities |= priorityBit(event.priority);
+                if ((0 <= event.category) &&
+                    (block.categories.end() == std::find(block.categories.begin(),
+                                                         block.categories.end(),
+                                                         (boost::uint32_t)event.category)))
+                {
+                    block.categories.push_back(event.category);
+                }
+            }
+        }
+    }
+    if (0 != block.size)
+        blocks.push_back(block);
+    indexedSize = blocks.empty() ? offset : blocks.back().offset + blocks.back().size;
+    return error.empty();
+}
+
+long LogIndex::scanRecord(const char* data, std::size_t size, bool& isEvent, Event& event)
+{
+    isEvent = false;
+    const char type = data[0];
+    if ((BinaryLog::CategoryRecord == type) || (BinaryLog::FormatRecord == type))
+    {
+        BinaryLog::NameHeader header;
+        if (size < 1 + sizeof(header))
+            return 0;
+        memcpy(&header, data + 1, sizeof(header));
+        const std::size_t total = 1 + sizeof(header) + header.length;
+        if (size < total)
+            return 0;
+        const std::string name(data + 1 + sizeof(header), header.length);
+        if (BinaryLog::CategoryRecord == type)
+            binaryCategories[header.id] = categoryIndex(name);
+        else
+            formats[header.id] = name;
+        return total;
+    }
+
+    if (BinaryLog::EventRecord == type)
+    {
+        BinaryLog::EventHeader header;
+        if (size < 1 + sizeof(header))
+            return 0;
+        memcpy(&header, data + 1, sizeof(header));
+        const std::size_t total = 1 + sizeof(header) + header.threadLength + header.length;
+        if (size < total)
+            return 0;
+        std::map<boost::uint32_t, boost::uint32_t>::const_iterator it =
+            binaryCategories.find(header.category);
+        event.seconds   = header.seconds;
+        event.priority  = header.priority;
+        event.category  = (binaryCategories.end() == it) ? -1 : (int)it->second;
+        isEvent         = true;
+        return total;
+    }
+
+    return -1;
+}
+
+long LogIndex::scanLine(const char* data, std::size_t size, bool& isEvent, Event& event)
+{
+    const char* end = (const char*)memchr(data, '\n', size);
+    if (0 == end)
+        return 0;
+    const std::size_t length = end - data + 1;
+    std::string category;
+    isEvent = parseLine(data, length, event.seconds, event.priority, category);
+    if (isEvent)
+        event.category = categoryIndex(category);
+    return length;
+}
+
+boost::uint32_t LogIndex::categoryIndex(const std::string& category)
+{
+    std::map<std::string, boost::uint32_t>::const_iterator it = categoryIndexes.find(category);
+    if (categoryIndexes.end() != it)
+        return it->second;
+    categories.push_back(category);
+    categoryIndexes[category] = categories.size() - 1;
+    return categories.size() - 1;
+}
+
+void LogIndex::find(const Query& query, std::vector<std::size_t>& found) const
+{
+    // the bits of the priorities up to the queried one
+    const boost::uint32_t priorities = (query.priority < 0) ? 0 :
+        (priorityBit(query.priority) << 1) - 1;
+    std::vector<bool> categoryMatches(categories.size());
+    for (std::size_t i = 0; i < categories.size(); ++i)
+        categoryMatches[i] = query.matchesCategory(categories[i]);
+
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        const Block& block = blocks[i];
+        bool match = (0 == block.events) ||
+            ((query.from <= block.last) && (block.first <= query.to) &&
+             (0 != (block.priorities & priorities)));
+        if (match && (0 != block.events) && !query.categories.empty())
+        {
+            match = false;
+            for (std::size_t j = 0; !match && (j < block.categories.size()); ++j)
+                match = categoryMatches[block.categories[j]];
+        }
+        if (match)
+            found.push_back(i);
+    }
+}
+
+bool LogIndex::readBlock(std::FILE* file, const Block& block, std::vector<char>& data) const
+{
+    data.resize(block.size);
+    return (0 == seekTo(file, block.offset)) &&
+        ((0 == block.size) || (block.size == std::fread(&data[0], 1, block.size, file)));
+}
+
+void LogIndex::getNameRecords(std::string& out) const
+{
+    BinaryLog::NameHeader header;
+    std::map<boost::uint32_t, boost::uint32_t>::const_iterator c;
+    for (c = binaryCategories.begin(); c != binaryCategories.end(); ++c)
+    {
+        header.id       = c->first;
+        header.length   = categories[c->second].size();
+        out += (char)BinaryLog::CategoryRecord;
+        append(out, header);
+        out += categories[c->second];
+    }
+    std::map<boost::uint32_t, std::string>::const_iterator f;
+    for (f = formats.begin(); f != formats.end(); ++f)
+    {
+        header.id       = f->first;
+        header.length   = f->second.size();
+        out += (char)BinaryLog::FormatRecord;
+        append(out, header);
+        out += f->second;
+    }
+}
+
+const std::string& LogIndex::getPath() const
+{
+    return path;
+}
+
+LogIndex::FileFormat LogIndex::getFormat() const
+{
+    return format;
+}
+
+const std::vector<LogIndex::Block>& LogIndex::getBlocks() const
+{
+    return blocks;
+}
+
+const std::vector<std::string>& LogIndex::getCategories() const
+{
+    return categories;
+}
+
+boost::uint64_t LogIndex::getIndexedSize() const
+{
+    return indexedSize;
+}
+
+const std::string& LogIndex::getError() const
+{
+    return error;
+}
+
+// namespaces
+}
+}
@@ -0,0 +1,191 @@
+#ifndef	LOGINDEX_HPP
+#define	LOGINDEX_HPP 1
+
+#include <boost/cstdint.hpp>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+/** A sidecar index of a log file written by the OCL file appenders, so
+    that a search for a time range, categories or priorities reads only
+    the parts of the file which may hold matching events.
+
+    The file is split in blocks of about \a blockSize bytes, on record
+    boundaries for binary logs (see BinaryLog) and before an event line for
+    text logs. Per block the index holds the range of the event times, and
+    the categories and priorities present. It is kept in \a file.idx, see
+    indexPath(). update() indexes only what was appended to the file since
+    the index was saved, and rebuilds the index when it belongs to another
+    file, eg after a rolling appender renamed \a file to \a file.1.
+
+    Text lines are parsed as written by the basic layout ("seconds priority
+    category ndc: message"), or by a pattern layout starting with
+    "%d %p %c" or "%d [%t] %p %c", which is also what ocl-logdecode writes.
+    Other lines, eg those of multi-line messages, belong to the event
+    before them. A block without any event that can be parsed matches every
+    query. Compressed files and ring files can not be indexed.
+
+    See ocl-logsearch (logsearch.cpp) for searching indexed file sets.
+    \warning Not real-time capable
+*/
+class LogIndex
+{
+public:
+    enum FileFormat { TextFile = 0, BinaryFile = 1 };
+
+    /// Default size of a block, in bytes
+    static const std::size_t DefaultBlockSize;
+
+    /// The summary of a part of the file
+    struct Block
+    {
+        Block();
+
+        /// Position and size of the block in the file, in bytes
+        boost::uint64_t                 offset;
+        boost::uint64_t                 size;
+        /// Number of events parsed, and the range of their times in
+        /// seconds since the epoch
+        boost::uint32_t                 events;
+        boost::int64_t                  first;
+        boost::int64_t                  last;
+        /// Bit n is set when an event with a priority from n*100 up to
+        /// (n+1)*100 is present, see priorityBit()
+        boost::uint32_t                 priorities;
+        /// The categories present, as indexes in getCategories()
+        std::vector<boost::uint32_t>    categories;
+    };
+
+    /// What to search for
+    struct Query
+    {
+        /// Matches all events
+        Query();
+
+        /// Whether an event with these values matches
+        bool matches(boost::int64_t seconds, int priority, const std::string& category) const;
+        /// Whether \a category or one of its parents is queried
+        bool matchesCategory(const std::string& category) const;
+
+        /// Time range in seconds since the epoch, both inclusive
+        boost::int64_t                  from;
+        boost::int64_t                  to;
+        /// Least severe priority to match, eg log4cpp::Priority::WARN
+        /// matches WARN, ERROR, CRIT, ALERT and FATAL
+        int                             priority;
+        /// Categories to match, together with their descendants. All
+        /// categories match if empty.
+        std::vector<std::string>        categories;
+    };
+
+    LogIndex();
+
+    /** Index the log file \a path. The saved index of \a path is used if
+        it is of this file, after which only what was appended since is
+        indexed.
+        \param blockSize Size of new blocks in bytes
+        \return false if \a path can not be read or indexed, see getError()
+    */
+    bool update(const std::string& path, std::size_t blockSize = DefaultBlockSize);
+    /** Write the index to indexPath(), through a temporary file so that
+        readers never see a partial index
+        \return false if it could not be written
+    */
+    bool save() const;
+    /// Whether update() changed the saved index
+    bool isModified() const;
+
+    /** Append to \a blocks the indexes in getBlocks() of the blocks which
+        may hold events that match \a query
+    */
+    void find(const Query& query, std::vector<std::size_t>& blocks) const;
+
+    /** Read \a block of the log file from \a file, which is the indexed
+        file opened in binary mode
+        \return false if the block could not be read
+    */
+    bool readBlock(std::FILE* file, const Block& block, std::vector<char>& data) const;
+    /** Append the category and format records of a binary log to \a out.
+        Decode them before any block with a BinaryLogDecoder, as a block
+        may refer to names defined in an earlier block.
+    */
+    void getNameRecords(std::string& out) const;
+
+    const std::string& getPath() const;
+    FileFormat getFormat() const;
+    const std::vector<Block>& getBlocks() const;
+    const std::vector<std::string>& getCategories() const;
+    /// Bytes of the file which are indexed, which excludes an incomplete
+    /// last record or line
+    boost::uint64_t getIndexedSize() const;
+    /// Why the last update() failed
+    const std::string& getError() const;
+
+    /// Name of the index file of \a path
+    static std::string indexPath(const std::string& path);
+    /// Bit for \a priority in Block::priorities
+    static boost::uint32_t priorityBit(int priority);
+
+    /** Parse the start of a text log line of \a size bytes, see LogIndex.
+        \return false if it is not the first line of an event
+    */
+    static bool parseLine(const char* line, std::size_t size, boost::int64_t& seconds,
+                          int& priority, std::string& category);
+    /** Parse \a time as "YYYY-MM-DD HH:MM:SS" in local time, or as seconds
+        since the epoch, into \a seconds
+        \return false if \a time is neither
+    */
+    static bool parseTime(const std::string& time, boost::int64_t& seconds);
+
+protected:
+    /// An event, as far as the index is concerned
+    struct Event
+    {
+        boost::int64_t  seconds;
+        int             priority;
+        /// Index in categories, or -1 when unknown
+        int             category;
+    };
+
+    /// Reset to an empty index of \a format
+    void clear(FileFormat format);
+    /// Load the saved index, if it is of \a file
+    bool load(std::FILE* file, boost::uint64_t fileSize);
+    /// Index \a file from \a offset onwards
+    bool scan(std::FILE* file, boost::uint64_t offset, std::size_t blockSize);
+    /** Scan the record or line at \a data of at most \a size bytes
+        \param isEvent set to true if it starts an event, stored in \a event
+        \return its size, 0 if incomplete or -1 if invalid
+    */
+    long scanRecord(const char* data, std::size_t size, bool& isEvent, Event& event);
+    long scanLine(const char* data, std::size_t size, bool& isEvent, Event& event);
+    /// Index of \a category in categories, added if new
+    boost::uint32_t categoryIndex(const std::string& category);
+    /// Hash of the first \a size bytes of \a file, identifying the file
+    static bool fingerprint(std::FILE* file, boost::uint32_t size, boost::uint64_t& hash);
+
+    std::string                                 path;
+    FileFormat                                  format;
+    std::vector<Block>                          blocks;
+    std::vector<std::string>                    categories;
+    std::map<std::string, boost::uint32_t>      categoryIndexes;
+    /// Binary log category id to index in categories
+    std::map<boost::uint32_t, boost::uint32_t>  binaryCategories;
+    /// Binary log format id to format
+    std::map<boost::uint32_t, std::string>      formats;
+    boost::uint64_t                             indexedSize;
+    boost::uint64_t                             hash;
+    boost::uint32_t                             hashSize;
+    bool                                        modified;
+    std::string                                 error;
+};
+
+// namespaces
+}
+}
+
+#endif
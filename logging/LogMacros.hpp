@@ -0,0 +1,199 @@
+#ifndef	LOGMACROS_HPP
+#define	LOGMACROS_HPP 1
+
+#include "CategoryHandle.hpp"
+
+/** \file
+    Macros which log to an OCL category only when the priority is enabled,
+    and otherwise do not evaluate their message arguments. Building an
+    rt_string for a disabled debug message allocates and copies for
+    nothing, so prefer
+
+    \code
+    OCL_LOG_DEBUG(logger, "Got " + RTT::rt_string(name.c_str()));
+    OCL_LOG_FORMAT(logger, log4cpp::Priority::INFO, (format, x, y));
+    OCL_LOG_STREAM(logger, log4cpp::Priority::INFO) << "x is " << x;
+    \endcode
+
+    over calling the category directly. The \a logger is a CategoryHandle,
+    which checks its cached priority, or a Category pointer or reference,
+    which check the priority of the category and its parents.
+
+    Messages less severe than OCL_LOGGING_COMPILE_PRIORITY, which the CMake
+    option OCL_LOGGING_COMPILE_LEVEL sets, are compiled out: OCL_LOG_DEBUG()
+    and friends expand to nothing, and the other macros test a constant
+    which the compiler removes with the call.
+*/
+
+/// Whether messages of \a priority are compiled in
+#define OCL_LOG_COMPILED(priority)                                      \
+    ((priority) <= OCL_LOGGING_COMPILE_PRIORITY)
+
+/// Whether messages of \a priority are compiled in and enabled in \a logger
+#define OCL_LOG_ENABLED(logger, priority)                               \
+    (OCL_LOG_COMPILED(priority) &&                                      \
+     OCL::logging::isLogEnabled((logger), (priority)))
+
+/// Log the rt_string \a message at \a priority
+#define OCL_LOG(logger, priority, message)                              \
+    do {                                                                \
+        if (OCL_LOG_ENABLED(logger, priority))                          \
+            OCL::logging::logCategory(logger)->log((priority), (message)); \
+    } while (0)
+
+/** Log a BinaryFormat and its arguments at \a priority, with \a args
+    the parenthesized format and arguments, e.g. (format, x, y)
+*/
+#define OCL_LOG_FORMAT(logger, priority, args)                          \
+    do {                                                                \
+        if (OCL_LOG_ENABLED(logger, priority))                          \
+            OCL::logging::FormatLogger(OCL::logging::logCategory(logger), \
+                                       (priority)) args;                \
+    } while (0)
+
+/// A CategoryStream to log at \a priority, which is not streamed into
+/// when disabled
+#define OCL_LOG_STREAM(logger, priority)                                \
+    if (!OCL_LOG_ENABLED(logger, priority)) {}                          \
+    else OCL::logging::logCategory(logger)->getRTStream(priority)
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 700
+#define OCL_LOG_DEBUG(logger, message)  OCL_LOG(logger, log4cpp::Priority::DEBUG, message)
+#else
+#define OCL_LOG_DEBUG(logger, message)  do {} while (0)
+#endif
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 600
+#define OCL_LOG_INFO(logger, message)   OCL_LOG(logger, log4cpp::Priority::INFO, message)
+#else
+#define OCL_LOG_INFO(logger, message)   do {} while (0)
+#endif
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 500
+#define OCL_LOG_NOTICE(logger, message) OCL_LOG(logger, log4cpp::Priority::NOTICE, message)
+#else
+#define OCL_LOG_NOTICE(logger, message) do {} while (0)
+#endif
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 400
+#define OCL_LOG_WARN(logger, message)   OCL_LOG(logger, log4cpp::Priority::WARN, message)
+#else
+#define OCL_LOG_WARN(logger, message)   do {} while (0)
+#endif
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 300
+#define OCL_LOG_ERROR(logger, message)  OCL_LOG(logger, log4cpp::Priority::ERROR, message)
+#else
+#define OCL_LOG_ERROR(logger, message)  do {} while (0)
+#endif
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 200
+#define OCL_LOG_CRIT(logger, message)   OCL_LOG(logger, log4cpp::Priority::CRIT, message)
+#else
+#define OCL_LOG_CRIT(logger, message)   do {} while (0)
+#endif
+
+#if OCL_LOGGING_COMPILE_PRIORITY >= 100
+#define OCL_LOG_ALERT(logger, message)  OCL_LOG(logger, log4cpp::Priority::ALERT, message)
+#else
+#define OCL_LOG_ALERT(logger, message)  do {} while (0)
+#endif
+
+// never compiled out
+#define OCL_LOG_FATAL(logger, message)  OCL_LOG(logger, log4cpp::Priority::FATAL, message)
+
+namespace OCL {
+namespace logging {
+
+/// Whether \a logger logs messages of \a priority, for the OCL_LOG macros
+inline bool isLogEnabled(const CategoryHandle& logger, log4cpp::Priority::Value priority)
+{
+    return logger.isPriorityEnabled(priority);
+}
+inline bool isLogEnabled(Category* logger, log4cpp::Priority::Value priority)
+{
+    return logger->isPriorityEnabled(priority);
+}
+inline bool isLogEnabled(Category& logger, log4cpp::Priority::Value priority)
+{
+    return logger.isPriorityEnabled(priority);
+}
+
+/// The category of \a logger, for the OCL_LOG macros
+inline Category* logCategory(const CategoryHandle& logger)
+{
+    return logger.get();
+}
+inline Category* logCategory(Category* logger)
+{
+    return logger;
+}
+inline Category* logCategory(Category& logger)
+{
+    return &logger;
+}
+
+/** Logs a BinaryFormat with its arguments to a category, so that
+    OCL_LOG_FORMAT() can pass the arguments as one parenthesized list.
+*/
+class FormatLogger
+{
+public:
+    FormatLogger(Category* category, log4cpp::Priority::Value priority) :
+            category(category), priority(priority)
+    {}
+
+    void operator()(const BinaryFormat& format) const
+    {
+        category->log(priority, format);
+    }
+    template<class A1>
+    void operator()(const BinaryFormat& format,
+                    const A1& a1) const
+    {
+        category->log(priority, format, a1);
+    }
+    template<class A1, class A2>
+    void operator()(const BinaryFormat& format,
+                    const A1& a1, const A2& a2) const
+    {
+        category->log(priority, format, a1, a2);
+    }
+    template<class A1, class A2, class A3>
+    void operator()(const BinaryFormat& format,
+                    const A1& a1, const A2& a2, const A3& a3) const
+    {
+        category->log(priority, format, a1, a2, a3);
+    }
+    template<class A1, class A2, class A3, class A4>
+    void operator()(const BinaryFormat& format,
+                    const A1& a1, const A2& a2, const A3& a3,
+                    const A4& a4) const
+    {
+        category->log(priority, format, a1, a2, a3, a4);
+    }
+    template<class A1, class A2, class A3, class A4, class A5>
+    void operator()(const BinaryFormat& format,
+                    const A1& a1, const A2& a2, const A3& a3,
+                    const A4& a4, const A5& a5) const
+    {
+        category->log(priority, format, a1, a2, a3, a4, a5);
+    }
+    template<class A1, class A2, class A3, class A4, class A5, class A6>
+    void operator()(const BinaryFormat& format,
+                    const A1& a1, const A2& a2, const A3& a3,
+                    const A4& a4, const A5& a5, const A6& a6) const
+    {
+        category->log(priority, format, a1, a2, a3, a4, a5, a6);
+    }
+
+protected:
+    Category*                   category;
+    log4cpp::Priority::Value    priority;
+};
+
+// namespaces
+}
+}
+
+#endif
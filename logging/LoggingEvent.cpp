@@ -1,58 +1,101 @@
 #include "LoggingEvent.hpp"
+#include "BinaryFormat.hpp"
 #include <log4cpp/Priority.hh>
-#include <log4cpp/threading/Threading.hh>
 #include <cstdio>
+#include <cstring>
 
 using namespace RTT;
 
 namespace OCL {
 namespace logging {
     
+namespace {
+
+/// Copy \a length characters of \a src to \a dest of \a size, and '\0'-terminate it
+/// \return the number of characters copied
+std::size_t copyString(char* dest, std::size_t size, const char* src, std::size_t length)
+{
+    if (length >= size)
+        length = size - 1;
+    memcpy(dest, src, length);
+    dest[length] = '\0';
+    return length;
+}
+
+}
+
 LoggingEvent::LoggingEvent() :
-        categoryName(""),
-        message(""),
-        ndc(""),
+        categoryId(0),
+        formatId(0),
+        messageLength(0),
         priority(log4cpp::Priority::NOTSET),
-        threadName(""),
-        timeStamp()
+        threadId(0),
+        timeStamp(0),
+        truncated(0)
 {
+    message[0]      = '\0';
+    ndc[0]          = '\0';
 }
 
 LoggingEvent::LoggingEvent(const LoggingEvent& toCopy) :
-        categoryName(toCopy.categoryName),
-        message(toCopy.message),
-        ndc(toCopy.ndc),
+        categoryId(toCopy.categoryId),
+        formatId(toCopy.formatId),
+        messageLength(toCopy.messageLength),
         priority(toCopy.priority),
-        threadName(toCopy.threadName),
-        timeStamp(toCopy.timeStamp)
+        threadId(toCopy.threadId),
+        timeStamp(toCopy.timeStamp),
+        truncated(toCopy.truncated)
 {
+    // only copy the used part of the strings
+    memcpy(message, toCopy.message, messageLength + 1);
+    strcpy(ndc, toCopy.ndc);
+}
+
+LoggingEvent::LoggingEvent(CategoryId categoryId,
+                           const char* message,
+                           std::size_t length,
+                           log4cpp::Priority::Value priority) :
+        categoryId(categoryId),
+        formatId(0),
+        messageLength(0),
+        priority(priority),
+        threadId(ThreadNames::current()),
+        timeStamp(EventClock::now()),
+        truncated(0)
+{
+    setMessage(message, length);
+    ndc[0] = '\0';
 }
 
 LoggingEvent::LoggingEvent(const rt_string& categoryName, 
                            const rt_string& message,
                            const rt_string& ndc, 
                            log4cpp::Priority::Value priority) :
-        categoryName(categoryName),
-        message(message),
-        ndc(ndc),
+        categoryId(CategoryNames::intern(categoryName.c_str())),
+        formatId(0),
+        messageLength(0),
         priority(priority),
-        threadName(""),
-        timeStamp()
+        threadId(ThreadNames::current()),
+        timeStamp(EventClock::now()),
+        truncated(0)
 {
-    char    buffer[16];
-    threadName = log4cpp::threading::getThreadId(&buffer[0]);
+    setMessage(message.c_str(), message.size());
+    setNdc(ndc.c_str());
 }
 
 const LoggingEvent& LoggingEvent::operator=(const LoggingEvent& rhs)
 {
     if (&rhs != this)   // prevent self-copy
     {
-        categoryName    = rhs.categoryName;
-        message         = rhs.message;
-        ndc             = rhs.ndc;
+        categoryId      = rhs.categoryId;
+        formatId        = rhs.formatId;
+        messageLength   = rhs.messageLength;
+        memcpy(message, rhs.message, messageLength + 1);
+        strcpy(ndc, rhs.ndc);
         priority        = rhs.priority;
-        threadName      = rhs.threadName;
+        threadId        = rhs.threadId;
         timeStamp		= rhs.timeStamp;
+        truncated       = rhs.truncated;
     }
     return *this;
 }
@@ -61,14 +104,64 @@ LoggingEvent::~LoggingEvent()
 {
 }
 
-log4cpp::LoggingEvent LoggingEvent::toLog4cpp()
+const char* LoggingEvent::getCategoryName() const
+{
+    return CategoryNames::name(categoryId);
+}
+
+const char* LoggingEvent::getThreadName() const
+{
+    return ThreadNames::name(threadId);
+}
+
+void LoggingEvent::setMessage(const char* message, std::size_t length)
+{
+    messageLength = copyString(this->message, MessageSize, message, length);
+    if (messageLength < length)
+        truncated |= MessageTruncated;
+    else
+        truncated &= ~MessageTruncated;
+}
+
+void LoggingEvent::setNdc(const char* ndc)
+{
+    std::size_t length = strlen(ndc);
+    if (copyString(this->ndc, NdcSize, ndc, length) < length)
+        truncated |= NdcTruncated;
+    else
+        truncated &= ~NdcTruncated;
+}
+
+void LoggingEvent::formatMessage(std::string& out) const
+{
+    if (0 != this->formatId)
+    {
+        BinaryFormat::format(BinaryFormat::getFormat(this->formatId),
+                             this->message, this->messageLength,
+                             0 != (this->truncated & MessageTruncated),
+                             out);
+    }
+    else
+    {
+        out.append(this->message, this->messageLength);
+        if (this->truncated & MessageTruncated)
+            out += "...";
+    }
+}
+
+log4cpp::LoggingEvent LoggingEvent::toLog4cpp() const
 {   
-    return log4cpp::LoggingEvent(makeString(this->categoryName),
-                                 makeString(this->message),
-                                 makeString(this->ndc),
+    std::string msg;
+    formatMessage(msg);
+    boost::int64_t  seconds;
+    int             microseconds;
+    EventClock::toWallTime(this->timeStamp, seconds, microseconds);
+    return log4cpp::LoggingEvent(getCategoryName(),
+                                 msg,
+                                 this->ndc,
                                  this->priority,
-                                 makeString(this->threadName),
-                                 this->timeStamp);
+                                 getThreadName(),
+                                 log4cpp::TimeStamp(seconds, microseconds));
 }
         
 
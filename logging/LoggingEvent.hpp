@@ -1,19 +1,48 @@
-#ifndef _LOGGINGEVENT_HPP 
+#ifndef _LOGGINGEVENT_HPP
 #define _LOGGINGEVENT_HPP 1
 
+#include <ocl/OCL.hpp>
 #include <rtt/rt_string.hpp>
 #include <log4cpp/LoggingEvent.hh>
+#include "CategoryNames.hpp"
+#include "EventClock.hpp"
+#include "ThreadNames.hpp"
+#include <cstddef>
 
 namespace OCL {
 namespace logging {
 
-/// A mirror of log4cpp::LoggingEvent, except using real-time capable strings
-struct LoggingEvent 
+/** A mirror of log4cpp::LoggingEvent, except that it never allocates:
+    the category and thread are interned ids (see CategoryNames and
+    ThreadNames) and all strings are stored inline. Strings which do not
+    fit are truncated, which is recorded in \a truncated. The time stamp
+    is read from the EventClock.
+*/
+struct LoggingEvent
 {
 public:
-    LoggingEvent(const RTT::rt_string& category, 
-                 const RTT::rt_string& message, 
-                 const RTT::rt_string& ndc, 
+    /// Capacity of the inline strings, including the terminating '\0'
+    enum { MessageSize    = OCL_LOGGING_MESSAGE_SIZE,
+           NdcSize        = 32 };
+
+    /// Flags in \a truncated
+    enum { MessageTruncated     = 0x01,
+           NdcTruncated         = 0x02 };
+
+    /** Create an event for \a length characters of \a message
+        \note Real-time capable, does not allocate, except on the first
+        event of a thread (see ThreadNames)
+    */
+    LoggingEvent(CategoryId categoryId,
+                 const char* message,
+                 std::size_t length,
+                 log4cpp::Priority::Value priority);
+    /** Create an event for the category named \a category
+        \warning not realtime, as the category name is interned
+    */
+    LoggingEvent(const RTT::rt_string& category,
+                 const RTT::rt_string& message,
+                 const RTT::rt_string& ndc,
                  log4cpp::Priority::Value priority);
     /// Create with empty values
     LoggingEvent();
@@ -23,21 +52,50 @@ public:
     const LoggingEvent& operator=(const LoggingEvent& rhs);
     ~LoggingEvent();
 
-    /*const */RTT::rt_string       categoryName;
+    CategoryId                  categoryId;
 
-    /*const */RTT::rt_string       message;
+    /// The BinaryFormat of \a message, or 0 if it is text
+    unsigned int                formatId;
 
-    /*const */RTT::rt_string       ndc;
+    /** '\0'-terminated message of \a messageLength characters, or the
+        encoded arguments of \a formatId
+    */
+    char                        message[MessageSize];
+
+    unsigned int                messageLength;
+
+    char                        ndc[NdcSize];
 
     log4cpp::Priority::Value    priority;
 
-    /*const */RTT::rt_string       threadName;
+    ThreadId                    threadId;
+
+    EventClock::Nanoseconds     timeStamp;
 
-    log4cpp::TimeStamp          timeStamp;
+    /// Which strings were truncated, a combination of the flags above
+    unsigned char               truncated;
+
+    /// The name of the category this event was logged to
+    const char* getCategoryName() const;
+
+    /// The name of the thread which logged this event
+    const char* getThreadName() const;
+
+    /// Copy \a length characters of \a message, truncating if needed
+    void setMessage(const char* message, std::size_t length);
+
+    /// Copy \a ndc, truncating if needed
+    void setNdc(const char* ndc);
+
+    /** Append the message to \a out, formatting it if it is binary.
+        Truncated messages end in "..."
+        \warning not realtime
+    */
+    void formatMessage(std::string& out) const;
 
     /// Convert to log4cpp class
     /// \warning not realtime
-    log4cpp::LoggingEvent toLog4cpp();
+    log4cpp::LoggingEvent toLog4cpp() const;
 };
 
 // namespaces
@@ -45,4 +103,3 @@ public:
 }
 
 #endif
-
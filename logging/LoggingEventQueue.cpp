@@ -0,0 +1,151 @@
+#include "LoggingEventQueue.hpp"
+#include <rtt/base/TaskCore.hpp>
+
+namespace OCL {
+namespace logging {
+
+void PooledLoggingEvent::release()
+{
+    if (refs.dec_and_test())
+    {
+        pool->deallocate(this);
+    }
+}
+
+LoggingEventPool::LoggingEventPool(unsigned int capacity) :
+        pool(capacity),
+        users(1)
+{
+}
+
+LoggingEventPool::~LoggingEventPool()
+{
+}
+
+void LoggingEventPool::destroy()
+{
+    unref();
+}
+
+void LoggingEventPool::use()
+{
+    users.inc();
+}
+
+void LoggingEventPool::release()
+{
+    unref();
+}
+
+void LoggingEventPool::unref()
+{
+    if (users.dec_and_test())
+    {
+        delete this;
+    }
+}
+
+PooledLoggingEvent* LoggingEventPool::allocate(const LoggingEvent& event,
+                                               int refs)
+{
+    PooledLoggingEvent* p = pool.allocate();
+    if (0 != p)
+    {
+        users.inc();
+        p->event = event;
+        p->refs.set(refs);
+        p->pool = this;
+    }
+    return p;
+}
+
+void LoggingEventPool::deallocate(PooledLoggingEvent* event)
+{
+    pool.deallocate(event);
+    // may delete this pool
+    unref();
+}
+
+unsigned int LoggingEventPool::capacity()
+{
+    return pool.capacity();
+}
+
+unsigned int LoggingEventPool::size()
+{
+    return pool.size();
+}
+
+LoggingEventQueue::LoggingEventQueue(unsigned int capacity,
+                                     RTT::base::TaskCore* owner) :
+        queue(capacity),
+        owner(owner),
+        depth(0),
+        drops(0)
+{
+}
+
+LoggingEventQueue::~LoggingEventQueue()
+{
+    clear();
+}
+
+bool LoggingEventQueue::enqueue(PooledLoggingEvent* event)
+{
+    // count first, so that the depth never becomes negative
+    depth.inc();
+    if (!queue.enqueue(event))
+    {
+        depth.dec();
+        drops.inc();
+        return false;
+    }
+    if (owner)
+    {
+        owner->trigger();
+    }
+    return true;
+}
+
+bool LoggingEventQueue::dequeue(PooledLoggingEvent*& event)
+{
+    if (!queue.dequeue(event))
+    {
+        return false;
+    }
+    depth.dec();
+    return true;
+}
+
+void LoggingEventQueue::clear()
+{
+    PooledLoggingEvent* event;
+    while (dequeue(event))
+    {
+        event->release();
+    }
+}
+
+unsigned int LoggingEventQueue::capacity() const
+{
+    return queue.capacity();
+}
+
+int LoggingEventQueue::size() const
+{
+    return depth.read();
+}
+
+void LoggingEventQueue::drop()
+{
+    drops.inc();
+}
+
+int LoggingEventQueue::dropped() const
+{
+    return drops.read();
+}
+
+// namespaces
+}
+}
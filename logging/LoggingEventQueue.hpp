@@ -0,0 +1,163 @@
+#ifndef	LOGGINGEVENTQUEUE_HPP
+#define	LOGGINGEVENTQUEUE_HPP 1
+
+#include "LoggingEvent.hpp"
+#include <rtt/os/Atomic.hpp>
+#include <rtt/internal/TsPool.hpp>
+#include <rtt/internal/AtomicMWSRQueue.hpp>
+
+// forward declare
+namespace RTT {
+namespace base {
+class TaskCore;
+}
+}
+
+namespace OCL {
+namespace logging {
+
+// forward declare
+class LoggingEventPool;
+
+/** A logging event shared by all appenders it is sent to.
+    The event is not modified once queued. Each appender releases
+    its reference when done, and the last one returns the slot to the pool.
+*/
+struct PooledLoggingEvent
+{
+    PooledLoggingEvent() : refs(0), pool(0) {}
+
+    LoggingEvent                event;
+    /// Number of appender queues still holding this event
+    RTT::os::AtomicInt          refs;
+    /// The pool this event is returned to
+    LoggingEventPool*           pool;
+
+    /// Drop one reference
+    /// \note Real-time and lock-free
+    void release();
+};
+
+/** A fixed-size pool of logging events, shared by all categories
+    which send their events to appender queues.
+
+    The pool is not deleted by its owner, but released with destroy(). It
+    deletes itself once the last allocated event is returned and the last
+    fan-out table using it is deleted, as the queues of appenders may still
+    hold events, and loggers may still allocate events, after the owner is
+    gone.
+    \note allocate() and release() are real-time and lock-free.
+*/
+class LoggingEventPool
+{
+public:
+    /// Create a pool of \a capacity events
+    /// \warning Not real-time capable
+    LoggingEventPool(unsigned int capacity);
+
+    /** Release the owner's reference. The pool is deleted now if no event
+        is allocated, else when the last one is returned.
+        \warning Not real-time capable
+    */
+    void destroy();
+
+    /** Take a reference for another user than the owner, eg a fan-out
+        table of a category, which releases it with release().
+        \warning Not real-time capable
+    */
+    void use();
+
+    /// Release a reference taken with use(). May delete the pool.
+    void release();
+
+    /** Get a slot from the pool, holding a copy of \a event and
+        \a refs references.
+        \return 0 if the pool is exhausted
+    */
+    PooledLoggingEvent* allocate(const LoggingEvent& event, int refs);
+
+    /// Return \a event to the pool
+    void deallocate(PooledLoggingEvent* event);
+
+    /// Total number of events in the pool
+    unsigned int capacity();
+
+    /// Number of free events in the pool
+    /// \warning Not real-time capable
+    unsigned int size();
+
+protected:
+    /// Use destroy()
+    ~LoggingEventPool();
+
+    /// Drop one reference, and delete the pool with the last one
+    void unref();
+
+    RTT::internal::TsPool<PooledLoggingEvent>   pool;
+    /// One for the owner, plus one per user and per allocated event
+    RTT::os::AtomicInt                          users;
+
+private:
+    /* prevent copying and assignment */
+    LoggingEventPool(const LoggingEventPool& other);
+    LoggingEventPool& operator=(const LoggingEventPool& other);
+};
+
+/** A bounded, lock-free multi-producer queue of pooled events,
+    owned by a single appender.
+*/
+class LoggingEventQueue
+{
+public:
+    /** Create a queue of \a capacity events.
+        \param owner Triggered each time an event is queued. May be 0.
+        \warning Not real-time capable
+    */
+    LoggingEventQueue(unsigned int capacity, RTT::base::TaskCore* owner);
+    /// Releases all queued events
+    ~LoggingEventQueue();
+
+    /** Queue \a event and trigger the owner.
+        \return false if the queue is full, in which case the event is
+        counted as dropped. The caller still holds its reference then.
+    */
+    bool enqueue(PooledLoggingEvent* event);
+
+    /// Get the oldest event, which must be released by the caller
+    bool dequeue(PooledLoggingEvent*& event);
+
+    /// Release all queued events
+    void clear();
+
+    unsigned int capacity() const;
+
+    /// Approximate number of queued events
+    /// \note Real-time and lock-free
+    int size() const;
+
+    /// Count an event for this queue which was dropped before queueing it,
+    /// eg because the pool was exhausted
+    void drop();
+
+    /// Number of events dropped since this queue was created
+    int dropped() const;
+
+protected:
+    RTT::internal::AtomicMWSRQueue<PooledLoggingEvent*> queue;
+    RTT::base::TaskCore*                                owner;
+    /// Number of queued events
+    RTT::os::AtomicInt                                  depth;
+    /// Number of dropped events
+    RTT::os::AtomicInt                                  drops;
+
+private:
+    /* prevent copying and assignment */
+    LoggingEventQueue(const LoggingEventQueue& other);
+    LoggingEventQueue& operator=(const LoggingEventQueue& other);
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "logging/LoggingService.hpp"
 #include "logging/Category.hpp"
+#include "logging/Appender.hpp"
+#include "logging/LoggingEventQueue.hpp"
+#include "logging/AppenderExecutor.hpp"
+#include "logging/EventClock.hpp"
 #include "ocl/Component.hpp"
 
 #include <boost/algorithm/string.hpp>
@@ -21,22 +25,88 @@ LoggingService::LoggingService(std::string name) :
         levels_prop("Levels","A PropertyBag defining the level of each category of interest."),
         additivity_prop("Additivity","A PropertyBag defining the additivity of each category of interest."),
         appenders_prop("Appenders","A PropertyBag defining the appenders for each category of interest."),
+        rateLimits_prop("RateLimits","A PropertyBag defining the maximum messages per second of each category of interest."),
+        suppressDuplicates_prop("SuppressDuplicates","A PropertyBag defining which categories suppress similar consecutive messages."),
+        rateLimitBurst_prop("RateLimitBurst","Number of messages a rate limited category may log at once, 0 for one second's worth.",0.0),
+        summaryInterval_prop("SummaryInterval","Time between the summaries of suppressed messages, in seconds.",5.0),
+        useEventQueues_prop("UseEventQueues","Send events to OCL appenders through lock-free queues instead of ports.",false),
+        eventPoolSize_prop("EventPoolSize","Number of events shared by the appender queues.",1000),
+        useTscClock_prop("UseTscClock","Time stamp events with the TSC, if it runs at a constant rate, instead of the monotonic clock.",false),
+        event_pool(0),
+        ioThreads_prop("IOThreads","Number of threads shared by the OCL appenders, 0 to keep an activity per appender.",0),
+        ioPeriod_prop("IOPeriod","Period of the appender threads in seconds, 0 to run them when events arrive.",0.0),
+        ioPriority_prop("IOPriority","Real-time priority of the appender threads, 0 to not run them real-time.",0),
+        executor(0),
         logCategories_mtd("logCategories", &LoggingService::logCategories, this)
 {
     this->properties()->addProperty( levels_prop );
     this->properties()->addProperty( additivity_prop );
     this->properties()->addProperty( appenders_prop );
+    this->properties()->addProperty( rateLimits_prop );
+    this->properties()->addProperty( suppressDuplicates_prop );
+    this->properties()->addProperty( rateLimitBurst_prop );
+    this->properties()->addProperty( summaryInterval_prop );
+    this->properties()->addProperty( useEventQueues_prop );
+    this->properties()->addProperty( eventPoolSize_prop );
+    this->properties()->addProperty( useTscClock_prop );
+    this->properties()->addProperty( ioThreads_prop );
+    this->properties()->addProperty( ioPeriod_prop );
+    this->properties()->addProperty( ioPriority_prop );
     this->provides()->addOperation( logCategories_mtd ).doc("Log category hierarchy (not realtime!)");
 }
 
 LoggingService::~LoggingService()
 {
+    clearEventQueues();
+    delete executor;
+    // appender queues may still hold events, and loggers may still use
+    // the replaced fan-out tables, which release the pool later
+    if (event_pool)
+    {
+        event_pool->destroy();
+    }
+}
+
+void LoggingService::updateHook()
+{
+    EventClock::resync();
+
+    // categories only report suppressed messages when they log, so report
+    // the end of a flood here
+    std::set<OCL::logging::Category*>::iterator iter;
+    for (iter = filtered_categories.begin(); iter != filtered_categories.end(); ++iter)
+    {
+        (*iter)->flushFilter();
+    }
+}
+
+// NOT realtime
+void LoggingService::clearEventQueues()
+{
+    if (!event_pool)
+        return;
+    std::vector<log4cpp::Category*>* categories =
+        log4cpp::Category::getCurrentCategories();
+    std::vector<log4cpp::Category*>::iterator iter;
+    for (iter = categories->begin(); iter != categories->end(); ++iter)
+    {
+        OCL::logging::Category* category = dynamic_cast<OCL::logging::Category*>(*iter);
+        if (category)
+            category->clearEventQueues();
+    }
+    delete categories;
+    Category::updateFanOut();
 }
 
 bool LoggingService::configureHook()
 {
     log(Debug) << "Configuring LoggingService" << endlog();
 
+    if ( useTscClock_prop.value() != EventClock::useTsc( useTscClock_prop.value() ) )
+    {
+        log(Warning) << "The TSC does not run at a constant rate, using the monotonic clock." << endlog();
+    }
+
     // set the priority/level for each category
 
     PropertyBag bag = levels_prop.value();  // an empty bag is ok
@@ -77,8 +147,7 @@ bool LoggingService::configureHook()
             }
             
             log(Debug) << "Getting category '" << categoryName << "'" << endlog();
-            log4cpp::Category& category =
-                log4cpp::Category::getInstance(categoryName);
+            log4cpp::Category& category = *getCategory(categoryName, true);
 
             category.setPriority(priority);
             log(Info) << "Category '" << categoryName 
@@ -94,6 +163,7 @@ bool LoggingService::configureHook()
         if (appender && (port = appender->ports()->getPort("LogPort")) )
             port->disconnect();
     }
+    clearEventQueues();
     if ( !active_appenders.empty() ) 
         log(Warning) <<"Reconfiguring LoggingService '"<<getName() << "': I've removed all existing Appender connections and will now rebuild them."<<endlog();
     active_appenders.clear();
@@ -118,8 +188,7 @@ bool LoggingService::configureHook()
             // "" == categoryName implies the root category.
 
             log(Debug) << "Getting category '" << categoryName << "'" << endlog();
-            log4cpp::Category& category =
-            log4cpp::Category::getInstance(categoryName);
+            log4cpp::Category& category = *getCategory(categoryName, true);
 
             category.setAdditivity(additivity);
             log(Info) << "Category '" << categoryName
@@ -128,6 +197,119 @@ bool LoggingService::configureHook()
         }
     }
 
+    // turn off the filters of a previous configuration, as categories may
+    // have been dropped from it
+
+    std::set<OCL::logging::Category*>::iterator iter;
+    for (iter = filtered_categories.begin(); iter != filtered_categories.end(); ++iter)
+    {
+        CategoryFilter& filter = (*iter)->getFilter();
+        filter.setRateLimit( 0, 0 );
+        filter.setSuppressDuplicates( false );
+    }
+    filtered_categories.clear();
+
+    // set the rate limit of each category
+
+    if ( 0 >= summaryInterval_prop.value() )
+    {
+        log(Error) << "Invalid SummaryInterval value of "
+                   << summaryInterval_prop.value() << ". Value must be > 0." << endlog();
+        return false;
+    }
+
+    bag = rateLimits_prop.value();  // an empty bag is ok
+
+    for (it=bag.getProperties().begin(); it != bag.getProperties().end(); ++it)
+    {
+        Property<double>* limit = dynamic_cast<Property<double>* >( *it );
+        if ( !limit )
+        {
+            log(Error) << "Expected Property '"
+                       << (*it)->getName() << "' to be of type double." << endlog();
+            continue;
+        }
+        OCL::logging::Category* category = getOCLCategory( limit->getName() );
+        if ( !category )
+        {
+            ok = false;
+            continue;
+        }
+        double rate  = limit->value();
+        double burst = 0 < rateLimitBurst_prop.value() ? rateLimitBurst_prop.value() : rate;
+        CategoryFilter& filter = category->getFilter();
+        filter.setSummaryInterval( summaryInterval_prop.value() );
+        filter.setRateLimit( rate, burst );
+        filtered_categories.insert( category );
+        log(Info) << "Category '" << limit->getName()
+                  << "' has rate limit '" << rate << "' messages per second"
+                  << endlog();
+    }
+
+    // set the duplicate suppression of each category
+
+    bag = suppressDuplicates_prop.value();  // an empty bag is ok
+
+    for (it=bag.getProperties().begin(); it != bag.getProperties().end(); ++it)
+    {
+        Property<bool>* suppress = dynamic_cast<Property<bool>* >( *it );
+        if ( !suppress )
+        {
+            log(Error) << "Expected Property '"
+                       << (*it)->getName() << "' to be of type boolean." << endlog();
+            continue;
+        }
+        OCL::logging::Category* category = getOCLCategory( suppress->getName() );
+        if ( !category )
+        {
+            ok = false;
+            continue;
+        }
+        CategoryFilter& filter = category->getFilter();
+        filter.setSummaryInterval( summaryInterval_prop.value() );
+        filter.setSuppressDuplicates( suppress->value() );
+        filtered_categories.insert( category );
+        log(Info) << "Category '" << suppress->getName()
+                  << "' has duplicate suppression '" << std::string(suppress->value() ? "on":"off") << "'"
+                  << endlog();
+    }
+    if ( !ok )
+    {
+        return false;
+    }
+
+    if ( useEventQueues_prop.value() && !event_pool )
+    {
+        if ( 0 >= eventPoolSize_prop.value() )
+        {
+            log(Error) << "Invalid EventPoolSize value of "
+                       << eventPoolSize_prop.value() << ". Value must be > 0." << endlog();
+            return false;
+        }
+        event_pool = new LoggingEventPool( eventPoolSize_prop.value() );
+    }
+    else if ( event_pool && ((int)event_pool->capacity() != eventPoolSize_prop.value()) )
+    {
+        log(Warning) << "EventPoolSize can not be changed once the pool is in use, keeping "
+                     << event_pool->capacity() << " events." << endlog();
+    }
+
+    if ( 0 < ioThreads_prop.value() && !executor )
+    {
+        if ( 0 > ioPeriod_prop.value() )
+        {
+            log(Error) << "Invalid IOPeriod value of "
+                       << ioPeriod_prop.value() << ". Value must be >= 0." << endlog();
+            return false;
+        }
+        executor = new AppenderExecutor( ioThreads_prop.value(), ioPeriod_prop.value(), ioPriority_prop.value() );
+    }
+    else if ( executor && ((int)executor->threads() != ioThreads_prop.value()) )
+    {
+        log(Warning) << "IOThreads can not be changed once the threads are running, keeping "
+                     << executor->threads() << " threads." << endlog();
+    }
+
     // create a port for each appender, and associate category/appender
 
     bag = appenders_prop.value();           // an empty bag is ok
@@ -148,7 +330,7 @@ bool LoggingService::configureHook()
             std::string appenderName    = association->value();
             
             // find category 
-            log4cpp::Category* p = log4cpp::HierarchyMaintainer::getDefaultMaintainer().getExistingInstance(categoryName);
+            log4cpp::Category* p = getCategory(categoryName, false);
             OCL::logging::Category* category =
                 dynamic_cast<OCL::logging::Category*>(p);
             if (0 == category)
@@ -167,7 +349,35 @@ bool LoggingService::configureHook()
             
             // find appender
             RTT::TaskContext* appender	= getPeer(appenderName);
-            if (appender)
+            OCL::logging::Appender* oclAppender =
+                dynamic_cast<OCL::logging::Appender*>(appender);
+            if (oclAppender && executor && !executor->attach(oclAppender))
+            {
+                log(Warning) << "Appender '" << appenderName
+                             << "' is running, it keeps its own activity." << endlog();
+            }
+            if (appender && oclAppender && useEventQueues_prop.value())
+            {
+                // attach appender queue to category
+                LoggingEventQueue* queue = oclAppender->getEventQueue();
+                if (queue)
+                {
+                    category->addEventQueue(queue, event_pool);
+                    log(Info) << "Category '" << categoryName
+                              << "' has appender queue '" << appenderName << "'"
+                              << " with level "
+                              << log4cpp::Priority::getPriorityName(category->getPriority())
+                              << endlog();
+                    active_appenders.push_back(appenderName);
+                }
+                else
+                {
+                    log(Error) << "Failed to create event queue of appender '" << appenderName << "'" << endlog();
+                    ok = false;
+                    break;
+                }
+            }
+            else if (appender)
             {
                 // connect category port with appender port
                 RTT::base::PortInterface* appenderPort = 0;
@@ -210,10 +420,44 @@ bool LoggingService::configureHook()
             }
         }
     }
-    
+
+    // flatten the appenders of each category, with respect to additivity
+    Category::updateFanOut();
+
     return ok;
 }
 
+// NOT realtime
+log4cpp::Category* LoggingService::getCategory(const std::string& categoryName, bool create)
+{
+    std::map<std::string, log4cpp::Category*>::const_iterator it = categories.find(categoryName);
+    if (it != categories.end())
+    {
+        return it->second;
+    }
+    // "" == categoryName implies the root category.
+    log4cpp::Category* p = create ?
+        &log4cpp::Category::getInstance(categoryName) :
+        log4cpp::HierarchyMaintainer::getDefaultMaintainer().getExistingInstance(categoryName);
+    if (0 != p)
+    {
+        categories[categoryName] = p;
+    }
+    return p;
+}
+
+// NOT realtime
+OCL::logging::Category* LoggingService::getOCLCategory(const std::string& categoryName)
+{
+    log4cpp::Category& p = *getCategory(categoryName, true);
+    OCL::logging::Category* category = dynamic_cast<OCL::logging::Category*>(&p);
+    if (0 == category)
+    {
+        log(Error) << "Category '" << categoryName << "' is not an OCL category: type is '" << typeid(p).name() << "'" << endlog();
+    }
+    return category;
+}
+
 // NOT realtime
 void LoggingService::logCategories()
 {
@@ -4,10 +4,22 @@
 #include <rtt/TaskContext.hpp>
 #include <rtt/PropertyBag.hpp>
 #include <rtt/Operation.hpp>
+#include <map>
+#include <set>
+#include <string>
+
+namespace log4cpp {
+    class Category;
+}
 
 namespace OCL {
 namespace logging {
 
+// forward declare
+class Category;
+class LoggingEventPool;
+class AppenderExecutor;
+
 /**
  * This component is responsible for reading the logging configuration
  * setting up the logging categories and connecting to the appenders.
@@ -18,6 +30,23 @@ namespace logging {
 \* Adding an Appender to the LoggingService is done with the addPeer()
  * method of the TaskContext class, ie loggingservice->addPeer(fileappender)
  *
+ * When UseEventQueues is set, OCL appenders are not connected through
+ * their LogPort, but each one gets a lock-free queue in which
+ * categories put a pointer to a single, pooled copy of each event.
+ * Appenders which are not OCL::logging::Appender's (eg the
+ * Log4cxxAppender) are still connected through their port.
+ *
+ * The RateLimits and SuppressDuplicates bags limit the messages of a
+ * category before events are built (see CategoryFilter). Unlike levels,
+ * they only apply to the category itself, not to its children. The
+ * summaries of suppressed messages are reported by the categories when
+ * they log, and by the update of this component once a category stopped
+ * logging, so give it a periodic activity.
+ *
+ * When IOThreads is set, the OCL appenders of the Appenders bag do not
+ * run in their own activity, but are executed by a fixed number of
+ * threads shared by all of them (see AppenderExecutor).
+ *
  * @see http://www.orocos.org/wiki/rtt/examples-and-tutorials/using-real-time-logging
  */
 class LoggingService : public RTT::TaskContext
@@ -27,6 +56,10 @@ public:
 	virtual ~LoggingService();
     
     virtual bool configureHook();
+    /** Log the summaries of suppressed messages which are due, and
+        resync the TSC when UseTscClock is set (see EventClock)
+    */
+    virtual void updateHook();
 
     /* \todo
 
@@ -47,8 +80,52 @@ protected:
     RTT::Property<RTT::PropertyBag>     additivity_prop;
     // list of appenders per category
     RTT::Property<RTT::PropertyBag>     appenders_prop;
+    // list of rate limits per category, in messages per second (0 == no limit)
+    RTT::Property<RTT::PropertyBag>     rateLimits_prop;
+    // list of categories which suppress similar consecutive messages
+    RTT::Property<RTT::PropertyBag>     suppressDuplicates_prop;
+    // messages a rate limited category may log at once (0 == one second's worth)
+    RTT::Property<double>               rateLimitBurst_prop;
+    // time between summaries of suppressed messages, in seconds
+    RTT::Property<double>               summaryInterval_prop;
     // list of all active appenders
     std::vector<std::string>            active_appenders;
+    // send events through appender queues instead of ports
+    RTT::Property<bool>                 useEventQueues_prop;
+    // number of events in the pool shared by the appender queues
+    RTT::Property<int>                  eventPoolSize_prop;
+    // time stamp events with the TSC instead of the monotonic clock
+    RTT::Property<bool>                 useTscClock_prop;
+    // pool of events for the appender queues, created when first needed
+    LoggingEventPool*                   event_pool;
+    // number of threads executing the appenders, 0 for an activity per appender
+    RTT::Property<int>                  ioThreads_prop;
+    // period of the appender threads, 0 to run them on events
+    RTT::Property<double>               ioPeriod_prop;
+    // real-time priority of the appender threads, 0 for ORO_SCHED_OTHER
+    RTT::Property<int>                  ioPriority_prop;
+    // threads executing the appenders, created when first needed
+    AppenderExecutor*                   executor;
+    // categories looked up by name so far
+    std::map<std::string, log4cpp::Category*>   categories;
+    // categories with a rate limit or duplicate suppression
+    std::set<OCL::logging::Category*>   filtered_categories;
+    /** Detach the appender queues from all categories
+     * \warning Not realtime!
+     */
+    void clearEventQueues();
+    /** Get the category \a categoryName, looking it up only once. Categories
+     * live until log4cpp shuts down, so the pointers are kept.
+     * \param create Whether to create the category if it does not exist
+     * \return 0 if it does not exist and \a create is false
+     * \warning Not realtime!
+     */
+    log4cpp::Category* getCategory(const std::string& categoryName, bool create);
+    /** Get the OCL category \a categoryName, creating it if needed
+     * \return 0 if it is not an OCL category, which is logged
+     * \warning Not realtime!
+     */
+    OCL::logging::Category* getOCLCategory(const std::string& categoryName);
     /** Log all categories
      * \warning Not realtime!
      */
@@ -1,7 +1,8 @@
 #include "logging/OstreamAppender.hpp"
+#include "logging/Layout.hpp"
 #include "ocl/Component.hpp"
 
-#include <log4cpp/OstreamAppender.hh>
+#include <iostream>
 
 using namespace RTT;
 
@@ -11,13 +12,15 @@ namespace logging {
 OstreamAppender::OstreamAppender(std::string name) :
     OCL::logging::Appender(name),
     maxEventsPerCycle_prop("MaxEventsPerCycle", "Maximum number of log events to pop per cycle",1),
-    maxEventsPerCycle(1)
+    maxEventsPerCycle(1),
+    layout(0)
 {
     properties()->addProperty(maxEventsPerCycle_prop);
 }
 
 OstreamAppender::~OstreamAppender()
 {
+    delete layout;
 }
 
 bool OstreamAppender::configureHook()
@@ -33,25 +36,46 @@ bool OstreamAppender::configureHook()
     }
     maxEventsPerCycle = m;
 
-    if (!appender)
-        appender = new log4cpp::OstreamAppender(getName(), &std::cout);
-
-    return configureLayout();
+    // in case the layout changed...
+    delete layout;
+    return createNativeLayout(layout);
 }
 
 void OstreamAppender::updateHook()
 {
 	processEvents(1);
+    writeBuffer();
+}
+
+void OstreamAppender::stopHook()
+{
+    Appender::stopHook();
+    writeBuffer();
 }
 
 void OstreamAppender::cleanupHook()
 {
-    /* normally in log4cpp the category owns the appenders and deletes them
-     itself, however we don't associate appenders and categories in the
-     same manner. Hence, you have to manually manage appenders.
-     */
-    delete appender;
-    appender = 0;
+    delete layout;
+    layout = 0;
+}
+
+void OstreamAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    layout->format(event, buffer);
+}
+
+bool OstreamAppender::hasOutput() const
+{
+    return 0 != layout;
+}
+
+void OstreamAppender::writeBuffer()
+{
+    if (buffer.empty())
+        return;
+    std::cout.write(buffer.data(), buffer.size());
+    std::cout.flush();
+    buffer.clear();
 }
 
 // namespaces
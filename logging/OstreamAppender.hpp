@@ -7,6 +7,10 @@
 namespace OCL {
 namespace logging {
 
+/** Appender writing to standard output. Events are formatted with a
+    native layout (see Layout), and the events of a cycle are written
+    at once.
+*/
 class OstreamAppender : public OCL::logging::Appender
 {
 public:
@@ -14,13 +18,21 @@ public:
 	virtual ~OstreamAppender();
 
 protected:
-	/// Create log4cpp appender
+	/// Create layout
     virtual bool configureHook();
 	/// Process at most one (1) event
 	virtual void updateHook();
-	/// Destroy appender
+	/// Drain the buffer and write it out
+	virtual void stopHook();
+	/// Destroy layout
 	virtual void cleanupHook();
 
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Write out the formatted events
+    void writeBuffer();
+
     /** 
      * Property to set maximum number of log events to pop per cycle
      */
@@ -36,6 +48,10 @@ protected:
      * starvation!
      */
     int                           maxEventsPerCycle;
+
+    OCL::logging::Layout*         layout;
+    /// Formatted events of this cycle
+    std::string                   buffer;
 };
 
 // namespaces
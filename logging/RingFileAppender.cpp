@@ -0,0 +1,179 @@
+#include "logging/RingFileAppender.hpp"
+#include "logging/Layout.hpp"
+#include "ocl/Component.hpp"
+#include <rtt/Logger.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+RingFileAppender::RingFileAppender(std::string name) :
+		OCL::logging::Appender(name),
+        filename_prop("Filename", "Name of file to log to"),
+        size_prop("Size", "Size of the circular data in the file, in bytes", 1024 * 1024),
+        format_prop("Format", "Format of the events: 'text' or 'binary'", "text"),
+        maxEventsPerCycle_prop("MaxEventsPerCycle", "Maximum number of log events to pop per cycle (0 for all)", 0),
+        maxEventsPerCycle(0),
+        map(0),
+        mapSize(0),
+        header(0),
+        data(0),
+        layout(0)
+{
+    properties()->addProperty(filename_prop);
+    properties()->addProperty(size_prop);
+    properties()->addProperty(format_prop);
+    properties()->addProperty(maxEventsPerCycle_prop);
+}
+
+RingFileAppender::~RingFileAppender()
+{
+    cleanupHook();
+}
+
+bool RingFileAppender::configureHook()
+{
+    // verify valid limits
+    int m = maxEventsPerCycle_prop.rvalue();
+    if ((0 > m))
+    {
+        log(Error) << "Invalid maxEventsPerCycle value of "
+                   << m << ". Value must be >= 0."
+                   << endlog();
+        return false;
+    }
+    int size = size_prop.rvalue();
+    if ((0 >= size))
+    {
+        log(Error) << "Invalid Size value of "
+                   << size << ". Value must be > 0."
+                   << endlog();
+        return false;
+    }
+    RingLog::Format format;
+    if (0 == format_prop.rvalue().compare("text"))
+        format = RingLog::TextFormat;
+    else if (0 == format_prop.rvalue().compare("binary"))
+        format = RingLog::BinaryFormat;
+    else
+    {
+        log(Error) << "Invalid Format '" << format_prop.rvalue()
+                   << "'. Value must be 'text' or 'binary'." << endlog();
+        return false;
+    }
+
+    OCL::logging::Layout* l = 0;
+    if ((RingLog::TextFormat == format) && !createNativeLayout(l))
+        return false;
+
+    // in case the filename changed...
+    cleanupHook();
+    layout              = l;
+    maxEventsPerCycle   = m;
+
+    const std::string& filename = filename_prop.rvalue();
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (-1 == fd)
+    {
+        log(Error) << "Could not open file " << filename
+                   << ": " << strerror(errno) << endlog();
+        return false;
+    }
+
+    // keep the events of an existing ring, eg of before a crash
+    RingLog::RingHeader existing;
+    bool keep = (sizeof(existing) == ::pread(fd, &existing, sizeof(existing), 0)) &&
+        RingLog::checkHeader(existing) &&
+        (existing.capacity == (boost::uint64_t)size) &&
+        (existing.format == (boost::uint32_t)format);
+
+    mapSize = sizeof(RingLog::RingHeader) + size;
+    if (!keep && (0 != ::ftruncate(fd, 0)))
+    {
+        log(Error) << "Could not truncate file " << filename
+                   << ": " << strerror(errno) << endlog();
+        ::close(fd);
+        return false;
+    }
+    if (0 != ::ftruncate(fd, mapSize))
+    {
+        log(Error) << "Could not resize file " << filename
+                   << ": " << strerror(errno) << endlog();
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(0, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);    // the mapping stays
+    if (MAP_FAILED == p)
+    {
+        log(Error) << "Could not map file " << filename
+                   << ": " << strerror(errno) << endlog();
+        return false;
+    }
+
+    map     = static_cast<char*>(p);
+    header  = reinterpret_cast<RingLog::RingHeader*>(map);
+    data    = map + sizeof(RingLog::RingHeader);
+    if (!keep)
+    {
+        RingLog::initHeader(*header, format, size);
+    }
+    else
+    {
+        log(Info) << "Appending to existing ring file " << filename << endlog();
+    }
+    return true;
+}
+
+void RingFileAppender::updateHook()
+{
+	processEvents(maxEventsPerCycle);
+}
+
+void RingFileAppender::cleanupHook()
+{
+    if (map)
+    {
+        ::munmap(map, mapSize);
+        map     = 0;
+        header  = 0;
+        data    = 0;
+    }
+    delete layout;
+    layout = 0;
+}
+
+void RingFileAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    buffer.clear();
+    if (layout)
+    {
+        layout->format(event, buffer);
+    }
+    else
+    {
+        // every record carries its names, as earlier ones may be overwritten
+        encoder.reset();
+        encoder.encode(event, buffer);
+    }
+    RingLog::appendRecord(*header, data, buffer.data(), buffer.size(), 0);
+}
+
+bool RingFileAppender::hasOutput() const
+{
+    return 0 != map;
+}
+
+// namespaces
+}
+}
+
+ORO_LIST_COMPONENT_TYPE(OCL::logging::RingFileAppender)
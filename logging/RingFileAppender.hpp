@@ -0,0 +1,81 @@
+#ifndef	RINGFILEAPPENDER_HPP
+#define	RINGFILEAPPENDER_HPP 1
+
+#include "Appender.hpp"
+#include "BinaryLog.hpp"
+#include "RingLog.hpp"
+#include <rtt/Property.hpp>
+
+namespace OCL {
+namespace logging {
+
+/** Appender writing events into a fixed-size, memory-mapped circular file
+    (see RingLog), which always holds the most recent events.
+
+    As the file is mapped, each event is in the kernel's page cache as soon
+    as it is appended, so the events survive a crash of the process (but not
+    of the system). Use ocl-logdecode to read the file, oldest event first.
+
+    An existing ring file of the same size and format is appended to, so
+    that restarting after a crash does not overwrite the events of interest.
+
+    With \a Format "text", events are formatted with a native layout (see
+    Layout). With "binary", each event is written as BinaryLog records,
+    including the names it refers to, as older records may be overwritten.
+*/
+class RingFileAppender : public OCL::logging::Appender
+{
+public:
+	RingFileAppender(std::string name);
+	virtual ~RingFileAppender();
+protected:
+	/// Map the file and create the layout
+    virtual bool configureHook();
+	/// Process at most \a maxEventsPerCycle events
+	virtual void updateHook();
+	/// Unmap the file
+	virtual void cleanupHook();
+
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Name of file to write to
+    RTT::Property<std::string>      filename_prop;
+    /// Size of the data in the file in bytes
+    RTT::Property<int>              size_prop;
+    /// "text" or "binary"
+    RTT::Property<std::string>      format_prop;
+    /**
+     * Property to set maximum number of log events to pop per cycle
+     */
+    RTT::Property<int>              maxEventsPerCycle_prop;
+
+    /**
+     * Maximum number of log events to pop per cycle
+     *
+     * Defaults to 0, to get the events in the file as soon as possible.
+     *
+     * A value of 0 indicates to not limit the number of events per cycle.
+     * With enough event production, this could lead to thread
+     * starvation!
+     */
+    int                             maxEventsPerCycle;
+
+    /// The mapped file, or 0
+    char*                           map;
+    std::size_t                     mapSize;
+    /// Header and data in \a map
+    RingLog::RingHeader*            header;
+    char*                           data;
+
+    OCL::logging::Layout*           layout;
+    BinaryLogEncoder                encoder;
+    /// Record being encoded
+    std::string                     buffer;
+};
+
+// namespaces
+}
+}
+
+#endif
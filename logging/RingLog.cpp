@@ -0,0 +1,159 @@
+#include "RingLog.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace OCL {
+namespace logging {
+
+namespace RingLog
+{
+    void initHeader(RingHeader& header, Format format, boost::uint64_t capacity)
+    {
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.version  = Version;
+        header.format   = format;
+        header.capacity = capacity;
+        header.begin    = 0;
+        header.end      = 0;
+    }
+
+    bool checkHeader(const RingHeader& header)
+    {
+        return (0 == memcmp(header.magic, Magic, sizeof(Magic))) &&
+            (Version == header.version) &&
+            (0 < header.capacity) &&
+            (header.begin <= header.end) &&
+            (header.end - header.begin <= header.capacity);
+    }
+
+    void initTrailer(LiveTrailer& trailer)
+    {
+        trailer.sequence    = 0;
+        trailer.beginRecord = 0;
+        trailer.endRecord   = 0;
+    }
+
+    std::size_t liveTrailerOffset(boost::uint64_t capacity)
+    {
+        // aligned for the 64 bit counters
+        const std::size_t end = sizeof(RingHeader) + capacity;
+        return (end + 7) & ~(std::size_t)7;
+    }
+
+    void copyOut(const char* data, boost::uint64_t capacity,
+                 boost::uint64_t offset, char* dest, std::size_t size)
+    {
+        std::size_t pos   = offset % capacity;
+        std::size_t first = std::min<boost::uint64_t>(size, capacity - pos);
+        memcpy(dest, data + pos, first);
+        memcpy(dest + first, data, size - first);
+    }
+
+    namespace
+    {
+        /// Copy \a size bytes of \a src into the ring \a data at \a offset
+        void copyIn(char* data, boost::uint64_t capacity,
+                    boost::uint64_t offset, const char* src, std::size_t size)
+        {
+            const std::size_t pos   = offset % capacity;
+            const std::size_t first = std::min<boost::uint64_t>(size, capacity - pos);
+            memcpy(data + pos, src, first);
+            memcpy(data, src + first, size - first);
+        }
+
+        /// Start updating the offsets, see LiveTrailer
+        void beginUpdate(LiveTrailer* trailer)
+        {
+            if (trailer)
+            {
+                ++trailer->sequence;
+                __sync_synchronize();
+            }
+        }
+
+        /// Finish updating the offsets, see LiveTrailer
+        void endUpdate(LiveTrailer* trailer)
+        {
+            __sync_synchronize();
+            if (trailer)
+            {
+                ++trailer->sequence;
+                __sync_synchronize();
+            }
+        }
+    }
+
+    bool appendRecord(RingHeader& header, char* data, const char* record, std::size_t size,
+                      LiveTrailer* trailer)
+    {
+        const boost::uint64_t   capacity    = header.capacity;
+        const boost::uint32_t   length      = size;
+        const boost::uint64_t   total       = sizeof(length) + size;
+        if (total > capacity)
+        {
+            return false;       // can never fit
+        }
+
+        // drop the oldest records which will be overwritten, before overwriting them
+        const boost::uint64_t   end         = header.end;
+        boost::uint64_t         begin       = header.begin;
+        boost::uint64_t         dropped     = 0;
+        while (begin + capacity < end + total)
+        {
+            boost::uint32_t oldLength;
+            copyOut(data, capacity, begin, reinterpret_cast<char*>(&oldLength), sizeof(oldLength));
+            begin += sizeof(oldLength) + oldLength;
+            ++dropped;
+        }
+        if (begin != header.begin)
+        {
+            beginUpdate(trailer);
+            header.begin = begin;
+            if (trailer)
+                trailer->beginRecord += dropped;
+            endUpdate(trailer);
+        }
+
+        copyIn(data, capacity, end, reinterpret_cast<const char*>(&length), sizeof(length));
+        copyIn(data, capacity, end + sizeof(length), record, size);
+        // only make the record visible once it is complete
+        __sync_synchronize();
+        beginUpdate(trailer);
+        header.end = end + total;
+        if (trailer)
+            ++trailer->endRecord;
+        endUpdate(trailer);
+        return true;
+    }
+
+    bool readRecords(const char* data, std::size_t size, std::vector<std::string>& records)
+    {
+        RingHeader header;
+        if (size < sizeof(header))
+            return false;
+        memcpy(&header, data, sizeof(header));
+        if (!checkHeader(header) || (size < sizeof(header) + header.capacity))
+            return false;
+
+        const char*     ring = data + sizeof(header);
+        boost::uint64_t offset = header.begin;
+        while (offset + sizeof(boost::uint32_t) <= header.end)
+        {
+            boost::uint32_t length;
+            copyOut(ring, header.capacity, offset, reinterpret_cast<char*>(&length), sizeof(length));
+            offset += sizeof(length);
+            if (offset + length > header.end)
+                return false;
+            std::string record(length, '\0');
+            if (0 < length)
+                copyOut(ring, header.capacity, offset, &record[0], length);
+            records.push_back(record);
+            offset += length;
+        }
+        return true;
+    }
+}
+
+// namespaces
+}
+}
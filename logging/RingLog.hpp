@@ -0,0 +1,104 @@
+#ifndef	RINGLOG_HPP
+#define	RINGLOG_HPP 1
+
+#include <boost/cstdint.hpp>
+#include <string>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+/** The circular log format, as written by the RingFileAppender and read
+    by ocl-logdecode. All values are in host byte order.
+
+    A ring file starts with a RingHeader, followed by \a capacity bytes of
+    data. Records are written one after the other into the data, wrapping
+    around at the end, and each record is its length as a uint32 followed
+    by the record itself. The records are either formatted text or
+    BinaryLog records, see RingHeader::format.
+
+    Offsets in the header count the bytes written since the file was
+    created, so the position of an offset in the data is offset % capacity.
+    The writer moves \a begin past the records it is going to overwrite
+    before writing, and moves \a end after a record once it is complete.
+    Hence the records between \a begin and \a end are always complete,
+    even after a crash of the writer.
+
+    A ring in shared memory, as written by the SharedMemoryAppender, is
+    followed by a LiveTrailer at liveTrailerOffset(), so that readers can
+    follow it while it is written (see SharedMemoryReader).
+*/
+namespace RingLog
+{
+    const char Magic[8] = { 'O', 'C', 'L', 'R', 'I', 'N', 'G', '1' };
+    const boost::uint32_t Version = 1;
+
+    enum Format { TextFormat = 0, BinaryFormat = 1 };
+
+    struct RingHeader
+    {
+        char            magic[8];
+        boost::uint32_t version;
+        /// See Format
+        boost::uint32_t format;
+        /// Size of the data following the header
+        boost::uint64_t capacity;
+        /// Offset of the oldest complete record
+        boost::uint64_t begin;
+        /// Offset after the newest complete record
+        boost::uint64_t end;
+    };
+
+    /** Follows the data of a ring in shared memory. The writer increments
+        \a sequence before and after it moves the offsets in the RingHeader
+        and the counters below, so a reader which reads the same, even,
+        sequence before and after reading them, got a consistent copy.
+    */
+    struct LiveTrailer
+    {
+        /// Odd while the writer updates the offsets and counters
+        boost::uint64_t sequence;
+        /// Number of records written before RingHeader::begin, and before
+        /// RingHeader::end
+        boost::uint64_t beginRecord;
+        boost::uint64_t endRecord;
+    };
+
+    /// Fill in a header for an empty ring
+    void initHeader(RingHeader& header, Format format, boost::uint64_t capacity);
+
+    /// Fill in a trailer for an empty ring
+    void initTrailer(LiveTrailer& trailer);
+
+    /// Offset of the LiveTrailer of a ring of \a capacity, from the start
+    /// of the header
+    std::size_t liveTrailerOffset(boost::uint64_t capacity);
+
+    /// Check the magic, version and offsets of a header
+    bool checkHeader(const RingHeader& header);
+
+    /** Get the records of the ring file in \a data of \a size bytes, oldest first.
+        \return false if \a data is not a valid ring file
+    */
+    bool readRecords(const char* data, std::size_t size, std::vector<std::string>& records);
+
+    /** Append \a size bytes of \a record to the ring with \a header and
+        \a data, after moving \a begin past the oldest records which are
+        overwritten. Updates \a trailer too, if not 0.
+        \return false if the record can never fit, in which case it is
+        dropped
+    */
+    bool appendRecord(RingHeader& header, char* data, const char* record, std::size_t size,
+                      LiveTrailer* trailer);
+
+    /// Copy \a size bytes at \a offset out of the ring \a data of
+    /// \a capacity bytes
+    void copyOut(const char* data, boost::uint64_t capacity,
+                 boost::uint64_t offset, char* dest, std::size_t size);
+}
+
+// namespaces
+}
+}
+
+#endif
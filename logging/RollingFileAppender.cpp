@@ -1,9 +1,8 @@
 #include "logging/RollingFileAppender.hpp"
+#include "logging/Layout.hpp"
 #include "ocl/Component.hpp"
 #include <rtt/Logger.hpp>
 
-#include <log4cpp/RollingFileAppender.hh>
-
 using namespace RTT;
 
 namespace OCL {
@@ -21,16 +20,50 @@ RollingFileAppender::RollingFileAppender(std::string name) :
         maxEventsPerCycle_prop("MaxEventsPerCycle", 
 							   "Maximum number of log events to pop per cycle",
 							   1),
-        maxEventsPerCycle(1)
+        compressCommand_prop("CompressCommand",
+                             "Command compressing backups in the background, e.g. 'gzip'. Empty to not compress.",
+                             ""),
+        compressSuffix_prop("CompressSuffix",
+                            "Suffix the CompressCommand adds to the backups",
+                            ".gz"),
+        rollovers_prop("Rollovers", "Number of rollovers since configure (read-only)", 0),
+        deferredRollovers_prop("DeferredRollovers",
+                               "Number of times a rollover was postponed as the next file was not open yet (read-only)",
+                               0),
+        rolloverTime_prop("RolloverTime",
+                          "Time the last rollover stalled the appender, in seconds (read-only)",
+                          0.0),
+        worstRolloverTime_prop("WorstRolloverTime",
+                               "Highest time a rollover stalled the appender, in seconds (read-only)",
+                               0.0),
+        backgroundTime_prop("BackgroundTime",
+                            "Time the background thread took for the last rollover, in seconds (read-only)",
+                            0.0),
+        worstBackgroundTime_prop("WorstBackgroundTime",
+                                 "Highest time the background thread took for a rollover, in seconds (read-only)",
+                                 0.0),
+        maxEventsPerCycle(1),
+        maxFileSize(0),
+        rolloverPending(false),
+        layout(0)
 {
     properties()->addProperty(filename_prop);
     properties()->addProperty(maxEventsPerCycle_prop);
     properties()->addProperty(maxFileSize_prop);
     properties()->addProperty(maxBackupIndex_prop);
+    properties()->addProperty(compressCommand_prop);
+    properties()->addProperty(compressSuffix_prop);
+    properties()->addProperty(rollovers_prop);
+    properties()->addProperty(deferredRollovers_prop);
+    properties()->addProperty(rolloverTime_prop);
+    properties()->addProperty(worstRolloverTime_prop);
+    properties()->addProperty(backgroundTime_prop);
+    properties()->addProperty(worstBackgroundTime_prop);
 }
 
 RollingFileAppender::~RollingFileAppender()
 {
+    cleanupHook();
 }
 
 bool RollingFileAppender::configureHook()
@@ -44,33 +77,106 @@ bool RollingFileAppender::configureHook()
                    << endlog();
         return false;
     }
-    maxEventsPerCycle = m;
+    if ((0 >= maxFileSize_prop.rvalue()) || (0 > maxBackupIndex_prop.rvalue()))
+    {
+        log(Error) << "Invalid MaxFileSize or MaxBackupIndex value of "
+                   << maxFileSize_prop.rvalue() << " or " << maxBackupIndex_prop.rvalue()
+                   << ". Values must be > 0 and >= 0." << endlog();
+        return false;
+    }
 
-    // \todo error checking
+    OCL::logging::Layout* l = 0;
+    if (!createNativeLayout(l))
+        return false;
+
+    // in case the filename changed...
+    cleanupHook();
 
 	log(Info) << "maxfilesize " << maxFileSize_prop.get() 
-			  << " maxbackupindex " << maxBackupIndex_prop.get() << std::endl;
-    appender = new log4cpp::RollingFileAppender(getName(), 
-												filename_prop.get(),
-												maxFileSize_prop.get(),
-												maxBackupIndex_prop.get());
-    
-    return configureLayout();
+			  << " maxbackupindex " << maxBackupIndex_prop.get() << endlog();
+    if (!file.open(filename_prop.rvalue(), RolloverFile::Rolling,
+                   maxBackupIndex_prop.rvalue(),
+                   compressCommand_prop.rvalue(), compressSuffix_prop.rvalue()))
+    {
+        delete l;
+        return false;
+    }
+
+    maxEventsPerCycle   = m;
+    maxFileSize         = maxFileSize_prop.rvalue();
+    rolloverPending     = false;
+    layout              = l;
+    updateStatistics();
+    return true;
 }
 
 void RollingFileAppender::updateHook()
 {
 	processEvents(maxEventsPerCycle);
+    writeBuffer();
+    if (rolloverPending && file.rollover())
+    {
+        rolloverPending = false;
+    }
+    updateStatistics();
+}
+
+void RollingFileAppender::stopHook()
+{
+    Appender::stopHook();
+    writeBuffer();
+    updateStatistics();
 }
 
 void RollingFileAppender::cleanupHook()
 {
-    /* normally in log4cpp the category owns the appenders and deletes them
-       itself, however we don't associate appenders and categories in the
-       same manner. Hence, you have to manually manage appenders.
-    */
-    delete appender;
-    appender = 0;
+    if (file.isOpen())
+    {
+        writeBuffer();
+        // waits until the last backup is renamed
+        file.close();
+    }
+    delete layout;
+    layout = 0;
+}
+
+void RollingFileAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    layout->format(event, buffer);
+    if (!rolloverPending && (maxFileSize <= file.size() + (long)buffer.size()))
+    {
+        // the events so far complete the current file
+        writeBuffer();
+        // else the next file is not open yet, retry in updateHook()
+        rolloverPending = !file.rollover();
+    }
+}
+
+bool RollingFileAppender::hasOutput() const
+{
+    return (0 != layout) && file.isOpen();
+}
+
+void RollingFileAppender::writeBuffer()
+{
+    if (buffer.empty())
+        return;
+    if (!file.write(buffer.data(), buffer.size()))
+    {
+        log(Error) << "Could not write to " << filename_prop.rvalue() << endlog();
+    }
+    buffer.clear();
+}
+
+void RollingFileAppender::updateStatistics()
+{
+    const RolloverFile::Statistics s = file.getStatistics();
+    rollovers_prop              = s.rollovers;
+    deferredRollovers_prop      = s.deferred;
+    rolloverTime_prop           = s.lastSwitch;
+    worstRolloverTime_prop      = s.worstSwitch;
+    backgroundTime_prop         = s.lastBackground;
+    worstBackgroundTime_prop    = s.worstBackground;
 }
 
 // namespaces
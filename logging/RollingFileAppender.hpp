@@ -2,24 +2,47 @@
 #define	ROLLINGFILEAPPENDER_HPP 1
 
 #include "Appender.hpp"
+#include "RolloverFile.hpp"
 #include <rtt/Property.hpp>
 
 namespace OCL {
 namespace logging {
 
+/** File appender which rolls over to a new file when the file reaches
+	\a MaxFileSize bytes, keeping \a MaxBackupIndex backups like the log4cpp
+	rolling file appender does.
+
+	Rolling over only switches to a file which was opened ahead of time, the
+	backups are renamed, compressed and deleted in a background thread (see
+	RolloverFile). The time taken is available in the statistics properties.
+
+    Events are formatted with a native layout (see Layout). Without a
+    layout name the "basic" layout is used, like the log4cpp file appender
+    does.
+*/
 class RollingFileAppender : public OCL::logging::Appender
 {
 public:
 	RollingFileAppender(std::string name);
 	virtual ~RollingFileAppender();
 protected:
-	/// Create log4cpp appender
+	/// Open the file and create the layout
     virtual bool configureHook();
 	/// Process at most \a maxEventsPerCycle event
 	virtual void updateHook();
-	/// Destroy appender
+	/// Drain the buffer and write it out
+	virtual void stopHook();
+	/// Close the files
 	virtual void cleanupHook();
-    
+
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Write out the buffer
+    void writeBuffer();
+    /// Copy the rollover statistics to their properties
+    void updateStatistics();
+
     /// Name of file to append to
     RTT::Property<std::string>      filename_prop;
     /// Maximum file size (in bytes) before rolling over
@@ -30,6 +53,16 @@ protected:
      * Property to set maximum number of log events to pop per cycle
      */
     RTT::Property<int>              maxEventsPerCycle_prop;
+    /// Command compressing the backups, and the suffix it adds
+    RTT::Property<std::string>      compressCommand_prop;
+    RTT::Property<std::string>      compressSuffix_prop;
+    /// Rollover statistics (read-only)
+    RTT::Property<int>              rollovers_prop;
+    RTT::Property<int>              deferredRollovers_prop;
+    RTT::Property<double>           rolloverTime_prop;
+    RTT::Property<double>           worstRolloverTime_prop;
+    RTT::Property<double>           backgroundTime_prop;
+    RTT::Property<double>           worstBackgroundTime_prop;
 
     /** 
      * Maximum number of log events to pop per cycle
@@ -41,6 +74,14 @@ protected:
      * starvation!
      */
     int                           maxEventsPerCycle;
+    long                          maxFileSize;
+    /// Whether a rollover was postponed, as the next file was not open yet
+    bool                          rolloverPending;
+
+    OCL::logging::Layout*         layout;
+    /// Formatted events of this cycle
+    std::string                   buffer;
+    RolloverFile                  file;
 };
 
 // namespaces
@@ -0,0 +1,374 @@
+#include "logging/RolloverFile.hpp"
+#include "logging/EventClock.hpp"
+
+#include <rtt/Activity.hpp>
+#include <rtt/Logger.hpp>
+#include <rtt/base/RunnableInterface.hpp>
+#include <rtt/os/MutexLock.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+/// Quote \a path as one argument for the shell std::system() runs
+std::string quote(const std::string& path)
+{
+#ifdef _WIN32
+    return "\"" + path + "\"";
+#else
+    std::string quoted = "'";
+    for (std::string::size_type i = 0; i < path.size(); ++i)
+    {
+        if ('\'' == path[i])
+            quoted += "'\\''";
+        else
+            quoted += path[i];
+    }
+    return quoted + "'";
+#endif
+}
+
+}
+
+/**
+ * Runs work() in the background thread.
+ */
+class RolloverFile::Worker : public RTT::base::RunnableInterface
+{
+public:
+    Worker(RolloverFile* owner) : owner(owner) {}
+
+    virtual bool initialize() { return true; }
+    virtual void step() {}
+    virtual void loop() { owner->work(); }
+    virtual bool breakLoop() { owner->stopWork(); return true; }
+    virtual void finalize() {}
+
+    RolloverFile* owner;
+};
+
+RolloverFile::Statistics::Statistics() :
+        rollovers(0),
+        deferred(0),
+        lastSwitch(0.0),
+        worstSwitch(0.0),
+        lastBackground(0.0),
+        worstBackground(0.0)
+{
+}
+
+RolloverFile::RolloverFile() :
+        naming(Rolling),
+        maxFiles(0),
+        worker(0),
+        activity(0),
+        current(0),
+        currentSize(0),
+        generation(0),
+        next(0),
+        nextSize(0),
+        retired(0),
+        retiredGeneration(0),
+        wantNext(false),
+        stopping(false)
+{
+}
+
+RolloverFile::~RolloverFile()
+{
+    close();
+    delete activity;
+    delete worker;
+}
+
+bool RolloverFile::open(const std::string& filename, Naming naming, int maxFiles,
+                        const std::string& compressCommand,
+                        const std::string& compressSuffix)
+{
+    close();
+
+    this->filename          = filename;
+    this->naming            = naming;
+    this->maxFiles          = maxFiles;
+    this->compressCommand   = compressCommand;
+    this->compressSuffix    = compressSuffix;
+    generation              = 0;
+
+    const std::string first = path(0, false);
+    current = std::fopen(first.c_str(), "a");
+    if (0 == current)
+    {
+        log(Error) << "Could not open file " << first
+                   << ": " << strerror(errno) << endlog();
+        return false;
+    }
+    std::fseek(current, 0, SEEK_END);
+    currentSize = std::ftell(current);
+
+    {
+        RTT::os::MutexLock locker(lock);
+        next        = 0;
+        retired     = 0;
+        wantNext    = true;
+        stopping    = false;
+        stats       = Statistics();
+    }
+    if (0 == worker)
+    {
+        worker      = new Worker(this);
+        activity    = new RTT::Activity(ORO_SCHED_OTHER, 0, 0, worker, "RolloverFile");
+    }
+    return activity->start();
+}
+
+void RolloverFile::close()
+{
+    // returns once the last file is retired
+    if (activity)
+    {
+        activity->stop();
+    }
+    if (current)
+    {
+        std::fclose(current);
+        current = 0;
+    }
+    if (next)
+    {
+        std::fclose(next);
+        next = 0;
+        // nothing was written to it
+        if ((Rolling == naming) || (0 == nextSize))
+        {
+            std::remove(nextPath(generation + 1).c_str());
+        }
+    }
+}
+
+bool RolloverFile::isOpen() const
+{
+    return 0 != current;
+}
+
+bool RolloverFile::write(const char* data, std::size_t size)
+{
+    if (0 == current)
+        return false;
+    std::size_t n = std::fwrite(data, 1, size, current);
+    std::fflush(current);
+    currentSize += n;
+    return n == size;
+}
+
+long RolloverFile::size() const
+{
+    return currentSize;
+}
+
+bool RolloverFile::rollover()
+{
+    const EventClock::Nanoseconds start = EventClock::now();
+    RTT::os::MutexLock locker(lock);
+    if (0 == next)
+    {
+        ++stats.deferred;
+        // the background thread gave up opening it, try again
+        if (!wantNext && (0 == retired))
+        {
+            wantNext = true;
+            cond.broadcast();
+        }
+        return false;
+    }
+
+    retired             = current;
+    retiredGeneration   = generation;
+    current             = next;
+    currentSize         = nextSize;
+    next                = 0;
+    ++generation;
+    wantNext            = true;
+    cond.broadcast();
+
+    ++stats.rollovers;
+    stats.lastSwitch    = (EventClock::now() - start) / 1e9;
+    stats.worstSwitch   = std::max(stats.worstSwitch, stats.lastSwitch);
+    return true;
+}
+
+RolloverFile::Statistics RolloverFile::getStatistics()
+{
+    RTT::os::MutexLock locker(lock);
+    return stats;
+}
+
+void RolloverFile::work()
+{
+    for (;;)
+    {
+        FILE* old;
+        int oldGeneration;
+        int nextGeneration;
+        bool open;
+        {
+            RTT::os::MutexLock locker(lock);
+            while ((0 == retired) && !wantNext && !stopping)
+            {
+                cond.wait(lock);
+            }
+            old             = retired;
+            oldGeneration   = retiredGeneration;
+            nextGeneration  = generation + 1;
+            open            = wantNext && !stopping;
+            if ((0 == old) && !open)
+            {
+                return;     // stopping, and the last file is retired
+            }
+        }
+
+        const EventClock::Nanoseconds start = EventClock::now();
+        if (old)
+        {
+            retire(old, oldGeneration);
+        }
+        FILE* file  = 0;
+        long size   = 0;
+        if (open && (0 != (file = openNext(nextGeneration))))
+        {
+            std::fseek(file, 0, SEEK_END);
+            size = std::ftell(file);
+        }
+
+        RTT::os::MutexLock locker(lock);
+        retired = 0;
+        if (open)
+        {
+            next        = file;
+            nextSize    = size;
+            wantNext    = false;
+        }
+        stats.lastBackground    = (EventClock::now() - start) / 1e9;
+        stats.worstBackground   = std::max(stats.worstBackground, stats.lastBackground);
+    }
+}
+
+void RolloverFile::stopWork()
+{
+    RTT::os::MutexLock locker(lock);
+    stopping = true;
+    cond.broadcast();
+}
+
+void RolloverFile::retire(FILE* file, int generation)
+{
+    std::fclose(file);
+    const bool compressed = !compressCommand.empty();
+
+    if (Rolling == naming)
+    {
+        if (0 < maxFiles)
+        {
+            // backups which do not exist yet fail to rename, which is fine
+            std::remove(path(maxFiles, compressed).c_str());
+            for (int i = maxFiles - 1; 0 < i; --i)
+            {
+                std::rename(path(i, compressed).c_str(), path(i + 1, compressed).c_str());
+            }
+            // left over if compressing failed
+            std::remove(path(1, false).c_str());
+            std::rename(filename.c_str(), path(1, false).c_str());
+            if (compressed)
+            {
+                compress(path(1, false));
+            }
+        }
+        else
+        {
+            std::remove(filename.c_str());
+        }
+        // the current file takes the place of the previous one
+        const std::string p = nextPath(generation + 1);
+        if (0 != std::rename(p.c_str(), filename.c_str()))
+        {
+            log(Error) << "Could not rename " << p << " to " << filename
+                       << ": " << strerror(errno) << endlog();
+        }
+    }
+    else
+    {
+        if (compressed)
+        {
+            compress(path(generation, false));
+        }
+        if ((0 < maxFiles) && (0 <= generation - maxFiles))
+        {
+            std::remove(path(generation - maxFiles, false).c_str());
+            std::remove(path(generation - maxFiles, true).c_str());
+        }
+    }
+}
+
+FILE* RolloverFile::openNext(int generation)
+{
+    const std::string p = nextPath(generation);
+    // a pre-opened Rolling file is always new
+    FILE* file = std::fopen(p.c_str(), (Rolling == naming) ? "w" : "a");
+    if (0 == file)
+    {
+        log(Error) << "Could not open file " << p
+                   << ": " << strerror(errno) << endlog();
+    }
+    return file;
+}
+
+bool RolloverFile::compress(const std::string& path)
+{
+    const std::string command = compressCommand + " " + quote(path);
+    if (0 != std::system(command.c_str()))
+    {
+        log(Warning) << "Could not compress " << path << " with '"
+                     << command << "', keeping it uncompressed." << endlog();
+        return false;
+    }
+    return true;
+}
+
+std::string RolloverFile::path(int generation, bool compressed) const
+{
+    std::stringstream s;
+    s << filename;
+    if (Generational == naming)
+    {
+        s << "." << generation;
+    }
+    else if (0 != generation)
+    {
+        s << "." << generation;
+    }
+    if (compressed)
+    {
+        s << compressSuffix;
+    }
+    return s.str();
+}
+
+std::string RolloverFile::nextPath(int generation) const
+{
+    if (Rolling == naming)
+    {
+        return filename + ".next";
+    }
+    return path(generation, false);
+}
+
+// namespaces
+}
+}
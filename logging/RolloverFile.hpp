@@ -0,0 +1,164 @@
+#ifndef	ROLLOVERFILE_HPP
+#define	ROLLOVERFILE_HPP 1
+
+#include <rtt/os/Mutex.hpp>
+#include <rtt/os/Condition.hpp>
+#include <cstdio>
+#include <string>
+
+namespace RTT {
+    class Activity;
+}
+
+namespace OCL {
+namespace logging {
+
+/** A set of log files which is rolled over without stalling the writer.
+
+    A background thread opens the next file of the set ahead of time, so
+    rollover() only swaps the current file for the next one. The background
+    thread then closes the previous file, renames it, compresses it and
+    deletes the files which are no longer kept, and opens the file after
+    that.
+
+    Files are named according to \a Naming:
+    - Rolling: events are written to \a filename. On rollover it becomes
+      \a filename.1, after \a filename.1 became \a filename.2 and so on,
+      up to \a filename.N for N backups. The next file is pre-opened as
+      \a filename.next, and renamed to \a filename once the previous file
+      is moved out of the way.
+    - Generational: generation g is written to \a filename.g, starting at
+      generation 0. All generations are kept, or the last N before the
+      current one.
+
+    Closed files are compressed by running the compress command with the
+    file name as argument, in the background thread. The command must
+    replace the file with one that has the compress suffix appended, as
+    "gzip" and "xz" do.
+
+    write() and rollover() are called by the appender thread only.
+*/
+class RolloverFile
+{
+public:
+    /// How the files of the set are named, see RolloverFile
+    enum Naming { Rolling, Generational };
+
+    /// Rollover statistics, times in seconds
+    struct Statistics
+    {
+        Statistics();
+
+        /// Number of rollovers
+        int         rollovers;
+        /// Number of rollovers postponed, as the next file was not open yet
+        int         deferred;
+        /// Time the writer took to switch files, last and worst
+        double      lastSwitch;
+        double      worstSwitch;
+        /// Time the background thread took to retire a file and open the
+        /// next one, last and worst
+        double      lastBackground;
+        double      worstBackground;
+    };
+
+    RolloverFile();
+    /// Close the files
+    ~RolloverFile();
+
+    /** Open the first file of the set and start the background thread.
+        \param filename Name of the file set, see RolloverFile
+        \param maxFiles Number of old files to keep. For Generational,
+        0 keeps all generations.
+        \param compressCommand Command compressing closed files, empty to
+        not compress them
+        \param compressSuffix Suffix the compress command adds
+        \return false if the first file could not be opened
+        \warning Not real-time capable
+    */
+    bool open(const std::string& filename, Naming naming, int maxFiles,
+              const std::string& compressCommand,
+              const std::string& compressSuffix);
+    /// Finish the background work and close all files
+    /// \warning Not real-time capable
+    void close();
+    bool isOpen() const;
+
+    /** Append \a size bytes of \a data to the current file and flush it.
+        \return false if not all data could be written
+    */
+    bool write(const char* data, std::size_t size);
+    /// Number of bytes in the current file
+    long size() const;
+
+    /** Continue in the next file, which only swaps files. The previous
+        file is retired in the background.
+        \return false if the next file is not open yet, in which case
+        the current file is kept. Try again later.
+    */
+    bool rollover();
+
+    /// Statistics since open()
+    Statistics getStatistics();
+
+protected:
+    class Worker;
+    friend class Worker;
+
+    /// Retire files and open the next file until stopped, in the
+    /// background thread
+    void work();
+    /// Stop work() once the pending work is done
+    void stopWork();
+    /// Close \a file of \a generation, rename, compress and delete files
+    void retire(FILE* file, int generation);
+    /// Open the file for \a generation, 0 on error
+    FILE* openNext(int generation);
+    /// Compress \a path, and return whether it succeeded
+    bool compress(const std::string& path);
+    /// Name of the file of \a generation, or of backup \a generation for
+    /// Rolling. Add the compress suffix if \a compressed.
+    std::string path(int generation, bool compressed) const;
+    /// Name of the next file, when it is for \a generation
+    std::string nextPath(int generation) const;
+
+    std::string         filename;
+    Naming              naming;
+    int                 maxFiles;
+    std::string         compressCommand;
+    std::string         compressSuffix;
+
+    Worker*             worker;
+    RTT::Activity*      activity;
+
+    // owned by the writer
+    FILE*               current;
+    long                currentSize;
+    int                 generation;
+
+    /// Guards the members below, never held during file operations
+    RTT::os::Mutex      lock;
+    /// Signals work for the background thread
+    RTT::os::Condition  cond;
+    /// Pre-opened next file and its size, 0 until open
+    FILE*               next;
+    long                nextSize;
+    /// File to retire and its generation, 0 if none
+    FILE*               retired;
+    int                 retiredGeneration;
+    /// Whether the background thread is to open the next file
+    bool                wantNext;
+    bool                stopping;
+    Statistics          stats;
+
+private:
+    /* prevent copying and assignment */
+    RolloverFile(const RolloverFile& other);
+    RolloverFile& operator=(const RolloverFile& other);
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "logging/SharedMemoryAppender.hpp"
+#include "logging/Layout.hpp"
+#include "ocl/Component.hpp"
+#include <rtt/Logger.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+SharedMemoryAppender::SharedMemoryAppender(std::string name) :
+		OCL::logging::Appender(name),
+        sharedMemoryName_prop("SharedMemoryName", "Name of the POSIX shared memory object, starting with '/'", "/ocl-logging"),
+        size_prop("Size", "Size of the ring in bytes", 1024 * 1024),
+        format_prop("Format", "Format of the events: 'text' or 'binary'", "text"),
+        maxEventsPerCycle_prop("MaxEventsPerCycle", "Maximum number of log events to pop per cycle (0 for all)", 0),
+        maxEventsPerCycle(0),
+        map(0),
+        mapSize(0),
+        header(0),
+        data(0),
+        trailer(0),
+        layout(0)
+{
+    properties()->addProperty(sharedMemoryName_prop);
+    properties()->addProperty(size_prop);
+    properties()->addProperty(format_prop);
+    properties()->addProperty(maxEventsPerCycle_prop);
+}
+
+SharedMemoryAppender::~SharedMemoryAppender()
+{
+    cleanupHook();
+}
+
+bool SharedMemoryAppender::configureHook()
+{
+    // verify valid limits
+    int m = maxEventsPerCycle_prop.rvalue();
+    if ((0 > m))
+    {
+        log(Error) << "Invalid maxEventsPerCycle value of "
+                   << m << ". Value must be >= 0."
+                   << endlog();
+        return false;
+    }
+    int size = size_prop.rvalue();
+    if ((0 >= size))
+    {
+        log(Error) << "Invalid Size value of "
+                   << size << ". Value must be > 0."
+                   << endlog();
+        return false;
+    }
+    RingLog::Format format;
+    if (0 == format_prop.rvalue().compare("text"))
+        format = RingLog::TextFormat;
+    else if (0 == format_prop.rvalue().compare("binary"))
+        format = RingLog::BinaryFormat;
+    else
+    {
+        log(Error) << "Invalid Format '" << format_prop.rvalue()
+                   << "'. Value must be 'text' or 'binary'." << endlog();
+        return false;
+    }
+    const std::string& name = sharedMemoryName_prop.rvalue();
+    if ((name.size() < 2) || ('/' != name[0]) || (std::string::npos != name.find('/', 1)))
+    {
+        log(Error) << "Invalid SharedMemoryName '" << name
+                   << "'. Value must be '/' followed by a name without '/'." << endlog();
+        return false;
+    }
+
+    OCL::logging::Layout* l = 0;
+    if ((RingLog::TextFormat == format) && !createNativeLayout(l))
+        return false;
+
+    // in case the name changed...
+    cleanupHook();
+    layout              = l;
+    maxEventsPerCycle   = m;
+
+    mapSize = RingLog::liveTrailerOffset(size) + sizeof(RingLog::LiveTrailer);
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat s;
+    if ((-1 != fd) && (0 == ::fstat(fd, &s)) &&
+        (0 != s.st_size) && ((std::size_t)s.st_size != mapSize))
+    {
+        // viewers may have mapped it, so create a new object instead of
+        // resizing this one under them
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+    if (-1 == fd)
+    {
+        log(Error) << "Could not open shared memory " << name
+                   << ": " << strerror(errno) << endlog();
+        return false;
+    }
+    if (0 != ::ftruncate(fd, mapSize))
+    {
+        log(Error) << "Could not resize shared memory " << name
+                   << ": " << strerror(errno) << endlog();
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(0, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);    // the mapping stays
+    if (MAP_FAILED == p)
+    {
+        log(Error) << "Could not map shared memory " << name
+                   << ": " << strerror(errno) << endlog();
+        return false;
+    }
+
+    map     = static_cast<char*>(p);
+    header  = reinterpret_cast<RingLog::RingHeader*>(map);
+    data    = map + sizeof(RingLog::RingHeader);
+    trailer = reinterpret_cast<RingLog::LiveTrailer*>(map + RingLog::liveTrailerOffset(size));
+
+    // keep the events of an existing ring, unless the writer stopped
+    // halfway an update
+    bool keep = RingLog::checkHeader(*header) &&
+        (header->capacity == (boost::uint64_t)size) &&
+        (header->format == (boost::uint32_t)format) &&
+        (0 == (trailer->sequence & 1));
+    if (!keep)
+    {
+        RingLog::initTrailer(*trailer);
+        RingLog::initHeader(*header, format, size);
+    }
+    else
+    {
+        log(Info) << "Appending to existing shared memory ring " << name << endlog();
+    }
+    return true;
+}
+
+void SharedMemoryAppender::updateHook()
+{
+	processEvents(maxEventsPerCycle);
+}
+
+void SharedMemoryAppender::cleanupHook()
+{
+    // the object stays, for viewers
+    if (map)
+    {
+        ::munmap(map, mapSize);
+        map     = 0;
+        header  = 0;
+        data    = 0;
+        trailer = 0;
+    }
+    delete layout;
+    layout = 0;
+}
+
+void SharedMemoryAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    buffer.clear();
+    if (layout)
+    {
+        layout->format(event, buffer);
+    }
+    else
+    {
+        // every record carries its names, as earlier ones may be overwritten
+        encoder.reset();
+        encoder.encode(event, buffer);
+    }
+    RingLog::appendRecord(*header, data, buffer.data(), buffer.size(), trailer);
+}
+
+bool SharedMemoryAppender::hasOutput() const
+{
+    return 0 != map;
+}
+
+// namespaces
+}
+}
+
+ORO_LIST_COMPONENT_TYPE(OCL::logging::SharedMemoryAppender)
@@ -0,0 +1,86 @@
+#ifndef	SHAREDMEMORYAPPENDER_HPP
+#define	SHAREDMEMORYAPPENDER_HPP 1
+
+#include "Appender.hpp"
+#include "BinaryLog.hpp"
+#include "RingLog.hpp"
+#include <rtt/Property.hpp>
+
+namespace OCL {
+namespace logging {
+
+/** Appender publishing events into a ring in POSIX shared memory, which
+    viewers in other processes follow live, eg with ocl-logtail.
+
+    The shared memory object holds a ring in the RingLog format, followed
+    by a RingLog::LiveTrailer. Each event is visible to viewers as soon as
+    the appender processed it, without waiting for a file to be flushed.
+    Viewers map the ring read-only (see SharedMemoryReader), so they never
+    slow down the appender: a viewer which falls behind misses the events
+    that were overwritten, and counts them.
+
+    The object is kept after cleanup, so viewers can still read the last
+    events, and an existing ring of the same size and format is appended
+    to. On Linux it is /dev/shm/<name>, which ocl-logdecode reads too.
+
+    With \a Format "text", events are formatted with a native layout (see
+    Layout). With "binary", each event is written as BinaryLog records,
+    including the names it refers to, as older records may be overwritten.
+*/
+class SharedMemoryAppender : public OCL::logging::Appender
+{
+public:
+	SharedMemoryAppender(std::string name);
+	virtual ~SharedMemoryAppender();
+protected:
+	/// Create or open the shared memory object, and map it
+    virtual bool configureHook();
+	/// Process at most \a maxEventsPerCycle events
+	virtual void updateHook();
+	/// Unmap the shared memory object
+	virtual void cleanupHook();
+
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Name of the shared memory object, eg "/ocl-logging"
+    RTT::Property<std::string>      sharedMemoryName_prop;
+    /// Size of the ring in bytes
+    RTT::Property<int>              size_prop;
+    /// "text" or "binary"
+    RTT::Property<std::string>      format_prop;
+    /**
+     * Property to set maximum number of log events to pop per cycle
+     */
+    RTT::Property<int>              maxEventsPerCycle_prop;
+
+    /**
+     * Maximum number of log events to pop per cycle
+     *
+     * Defaults to 0, to publish the events as soon as possible.
+     *
+     * A value of 0 indicates to not limit the number of events per cycle.
+     * With enough event production, this could lead to thread
+     * starvation!
+     */
+    int                             maxEventsPerCycle;
+
+    /// The mapped object, or 0
+    char*                           map;
+    std::size_t                     mapSize;
+    /// Header, data and trailer in \a map
+    RingLog::RingHeader*            header;
+    char*                           data;
+    RingLog::LiveTrailer*           trailer;
+
+    OCL::logging::Layout*           layout;
+    BinaryLogEncoder                encoder;
+    /// Record being encoded
+    std::string                     buffer;
+};
+
+// namespaces
+}
+}
+
+#endif
@@ -0,0 +1,212 @@
+#include "logging/SharedMemoryReader.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace OCL {
+namespace logging {
+
+SharedMemoryReader::SharedMemoryReader() :
+        map(0),
+        mapSize(0),
+        device(0),
+        inode(0),
+        header(0),
+        data(0),
+        trailer(0),
+        offset(0),
+        record(0),
+        lost(0)
+{
+}
+
+SharedMemoryReader::~SharedMemoryReader()
+{
+    detach();
+}
+
+bool SharedMemoryReader::attach(const std::string& name, bool fromBegin)
+{
+    detach();
+
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (-1 == fd)
+    {
+        // the appender may not have started yet
+        if (ENOENT != errno)
+            perror(name.c_str());
+        return false;
+    }
+    struct stat s;
+    RingLog::RingHeader h;
+    void* p = MAP_FAILED;
+    if ((0 == ::fstat(fd, &s)) && (sizeof(h) <= (std::size_t)s.st_size))
+    {
+        p = ::mmap(0, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);    // the mapping stays
+    if (MAP_FAILED == p)
+    {
+        fprintf(stderr, "%s: could not map the ring\n", name.c_str());
+        return false;
+    }
+
+    memcpy(&h, p, sizeof(h));
+    if (!RingLog::checkHeader(h) ||
+        ((std::size_t)s.st_size < RingLog::liveTrailerOffset(h.capacity) + sizeof(RingLog::LiveTrailer)))
+    {
+        fprintf(stderr, "%s: not a ring in shared memory\n", name.c_str());
+        ::munmap(p, s.st_size);
+        return false;
+    }
+
+    this->name  = name;
+    map         = static_cast<char*>(p);
+    mapSize     = s.st_size;
+    device      = s.st_dev;
+    inode       = s.st_ino;
+    header      = reinterpret_cast<const RingLog::RingHeader*>(map);
+    data        = map + sizeof(RingLog::RingHeader);
+    trailer     = reinterpret_cast<const RingLog::LiveTrailer*>(
+        map + RingLog::liveTrailerOffset(h.capacity));
+    lost        = 0;
+
+    Position position;
+    if (!snapshot(position))
+    {
+        // eg the writer crashed while updating the ring
+        fprintf(stderr, "%s: the ring is inconsistent\n", name.c_str());
+        detach();
+        return false;
+    }
+    offset = fromBegin ? position.begin : position.end;
+    record = fromBegin ? position.beginRecord : position.endRecord;
+    return true;
+}
+
+void SharedMemoryReader::detach()
+{
+    if (map)
+    {
+        ::munmap(map, mapSize);
+        map     = 0;
+        header  = 0;
+        data    = 0;
+        trailer = 0;
+    }
+}
+
+bool SharedMemoryReader::isAttached() const
+{
+    return 0 != map;
+}
+
+bool SharedMemoryReader::isReplaced() const
+{
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (-1 == fd)
+        return true;
+    struct stat s;
+    const bool same = (0 == ::fstat(fd, &s)) && (s.st_dev == device) && (s.st_ino == inode);
+    ::close(fd);
+    return !same;
+}
+
+bool SharedMemoryReader::snapshot(Position& position) const
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        const boost::uint64_t sequence = trailer->sequence;
+        __sync_synchronize();
+        if (0 == (sequence & 1))
+        {
+            position.begin          = header->begin;
+            position.end            = header->end;
+            position.beginRecord    = trailer->beginRecord;
+            position.endRecord      = trailer->endRecord;
+            __sync_synchronize();
+            if (sequence == trailer->sequence)
+                return true;
+        }
+        sched_yield();
+    }
+    return false;
+}
+
+int SharedMemoryReader::read(std::vector<std::string>& records)
+{
+    Position position;
+    if (!map || !snapshot(position))
+        return 0;       // try again later
+    if ((position.end < offset) || (position.endRecord < record))
+    {
+        // the appender started a new ring in the same object
+        offset = position.begin;
+        record = position.beginRecord;
+    }
+    if (offset < position.begin)
+    {
+        lost   += position.beginRecord - record;
+        offset  = position.begin;
+        record  = position.beginRecord;
+    }
+    if (offset == position.end)
+        return 0;
+
+    buffer.resize(position.end - offset);
+    RingLog::copyOut(data, header->capacity, offset, &buffer[0], buffer.size());
+
+    // the writer may have overwritten the oldest of the copied records
+    Position after;
+    if (!snapshot(after))
+        return 0;
+    boost::uint64_t from = offset;
+    if (offset < after.begin)
+    {
+        lost   += after.beginRecord - record;
+        from    = after.begin;
+        record  = after.beginRecord;
+        if (position.end <= from)
+        {
+            offset = from;
+            return 0;
+        }
+    }
+
+    int n = 0;
+    std::size_t pos = from - offset;
+    while (pos + sizeof(boost::uint32_t) <= buffer.size())
+    {
+        boost::uint32_t length;
+        memcpy(&length, &buffer[pos], sizeof(length));
+        pos += sizeof(length);
+        if (pos + length > buffer.size())
+            break;      // not a record boundary, can not happen
+        records.push_back(std::string(&buffer[pos], length));
+        pos += length;
+        ++n;
+    }
+    offset = position.end;
+    record = position.endRecord;
+    return n;
+}
+
+RingLog::Format SharedMemoryReader::getFormat() const
+{
+    return header ? (RingLog::Format)header->format : RingLog::TextFormat;
+}
+
+boost::uint64_t SharedMemoryReader::lostRecords() const
+{
+    return lost;
+}
+
+// namespaces
+}
+}
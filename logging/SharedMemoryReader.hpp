@@ -0,0 +1,98 @@
+#ifndef	SHAREDMEMORYREADER_HPP
+#define	SHAREDMEMORYREADER_HPP 1
+
+#include "RingLog.hpp"
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+/** Follows the ring in shared memory of a SharedMemoryAppender, from
+    another process.
+
+    The ring is mapped read-only, so readers never delay or disturb the
+    writer. Instead, a reader which falls behind finds its next records
+    overwritten. It then continues with the oldest record still in the
+    ring, and counts the records it lost, see lostRecords().
+    \warning Not real-time capable
+*/
+class SharedMemoryReader
+{
+public:
+    SharedMemoryReader();
+    /// Detach
+    ~SharedMemoryReader();
+
+    /** Attach to the ring in the POSIX shared memory object \a name,
+        eg "/ocl-logging".
+        \param fromBegin read the records in the ring first, instead of
+        only those written after attaching
+        \return false if \a name does not exist or holds no ring
+    */
+    bool attach(const std::string& name, bool fromBegin);
+    /// Unmap the ring
+    void detach();
+    bool isAttached() const;
+    /** Whether \a name was removed or refers to another object than the
+        attached one, eg after the appender was configured with another
+        size. Attach again to follow the new ring.
+    */
+    bool isReplaced() const;
+
+    /** Append the records written since the last read to \a records,
+        oldest first
+        \return the number of records appended
+    */
+    int read(std::vector<std::string>& records);
+
+    /// Format of the records
+    RingLog::Format getFormat() const;
+    /// Number of records which were overwritten before they were read
+    boost::uint64_t lostRecords() const;
+
+protected:
+    /// The offsets and counters of the ring, see RingLog::LiveTrailer
+    struct Position
+    {
+        boost::uint64_t begin;
+        boost::uint64_t end;
+        boost::uint64_t beginRecord;
+        boost::uint64_t endRecord;
+    };
+
+    /// Get a consistent copy of the offsets and counters
+    /// \return false if the writer kept updating them
+    bool snapshot(Position& position) const;
+
+    std::string                     name;
+    /// The mapped object, or 0
+    char*                           map;
+    std::size_t                     mapSize;
+    /// Identity of the mapped object
+    dev_t                           device;
+    ino_t                           inode;
+    /// Header, data and trailer in \a map
+    const RingLog::RingHeader*      header;
+    const char*                     data;
+    const RingLog::LiveTrailer*     trailer;
+
+    /// Offset and number of the next record to read
+    boost::uint64_t                 offset;
+    boost::uint64_t                 record;
+    boost::uint64_t                 lost;
+    /// Copy of the new part of the ring
+    std::vector<char>               buffer;
+
+private:
+    /* prevent copying and assignment */
+    SharedMemoryReader(const SharedMemoryReader& other);
+    SharedMemoryReader& operator=(const SharedMemoryReader& other);
+};
+
+// namespaces
+}
+}
+
+#endif
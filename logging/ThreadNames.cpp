@@ -0,0 +1,47 @@
+#include "ThreadNames.hpp"
+#include "InternTable.hpp"
+#include <log4cpp/threading/Threading.hh>
+
+#if defined(_MSC_VER)
+#define OCL_THREAD_LOCAL __declspec(thread)
+#else
+#define OCL_THREAD_LOCAL __thread
+#endif
+
+namespace OCL {
+namespace logging {
+
+namespace {
+
+// never deleted, see CategoryNames
+InternTable& names()
+{
+    static InternTable* table = new InternTable("<overflow>");
+    return *table;
+}
+
+/// The id of the current thread, or 0 if not looked up yet
+OCL_THREAD_LOCAL ThreadId currentId = 0;
+
+}
+
+ThreadId ThreadNames::current()
+{
+    if (0 == currentId)
+    {
+        // log4cpp's name, as used in its own events
+        char name[32];
+        log4cpp::threading::getThreadId(&name[0]);
+        currentId = names().intern(name);
+    }
+    return currentId;
+}
+
+const char* ThreadNames::name(ThreadId id)
+{
+    return names().get(id);
+}
+
+// namespaces
+}
+}
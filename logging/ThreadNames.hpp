@@ -0,0 +1,36 @@
+#ifndef	THREADNAMES_HPP
+#define	THREADNAMES_HPP 1
+
+namespace OCL {
+namespace logging {
+
+/// Identifies an interned thread name
+typedef unsigned int ThreadId;
+
+/** Interns the names of the threads which log, such that each thread
+    looks up its name only once, and logging events only carry a small id.
+
+    Id 0 is the empty name. Threads which log once the table is full
+    share the name "<overflow>".
+*/
+class ThreadNames
+{
+public:
+    /** Get the id of the calling thread.
+        \warning Not real-time capable on the first call in each thread,
+        which interns the thread's name. Real-time capable afterwards.
+    */
+    static ThreadId current();
+
+    /** Get the name of \a id.
+        \return the name, or "" for an unknown id
+        \note Real-time capable and lock-free
+    */
+    static const char* name(ThreadId id);
+};
+
+// namespaces
+}
+}
+
+#endif
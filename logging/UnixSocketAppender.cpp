@@ -0,0 +1,287 @@
+#include "logging/UnixSocketAppender.hpp"
+#include "ocl/Component.hpp"
+#include <rtt/Logger.hpp>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// not available everywhere, where SIGPIPE must be ignored instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace RTT;
+
+namespace OCL {
+namespace logging {
+
+UnixSocketAppender::UnixSocketAppender(std::string name) :
+		OCL::logging::Appender(name),
+        socketPath_prop("SocketPath", "Path of the Unix domain socket of the log collector",
+                        "/tmp/ocl-logging.sock"),
+        socketType_prop("SocketType", "Type of the socket: 'seqpacket' or 'datagram'",
+                        "seqpacket"),
+        maxPacketSize_prop("MaxPacketSize", "Maximum size of a packet of events, in bytes",
+                           16 * 1024),
+        reconnectInterval_prop("ReconnectInterval",
+                               "Time between attempts to connect to the collector, in seconds",
+                               1.0),
+        maxEventsPerCycle_prop("MaxEventsPerCycle", "Maximum number of log events to pop per cycle",
+                               0),
+        eventsSent_prop("EventsSent", "Events sent since configure (read-only)", 0),
+        droppedEvents_prop("DroppedEvents",
+                           "Events dropped as the collector was gone or did not keep up (read-only)",
+                           0),
+        packetsSent_prop("PacketsSent", "Packets sent since configure (read-only)", 0),
+        connected_prop("Connected", "Whether connected to the collector (read-only)", false),
+        maxEventsPerCycle(0),
+        socketType(SOCK_SEQPACKET),
+        maxPacketSize(0),
+        fd(-1),
+        configured(false),
+        lastAttempt(0),
+        eventsSent(0),
+        droppedEvents(0),
+        packetsSent(0),
+        packetEvents(0)
+{
+    properties()->addProperty(socketPath_prop);
+    properties()->addProperty(socketType_prop);
+    properties()->addProperty(maxPacketSize_prop);
+    properties()->addProperty(reconnectInterval_prop);
+    properties()->addProperty(maxEventsPerCycle_prop);
+    properties()->addProperty(eventsSent_prop);
+    properties()->addProperty(droppedEvents_prop);
+    properties()->addProperty(packetsSent_prop);
+    properties()->addProperty(connected_prop);
+}
+
+UnixSocketAppender::~UnixSocketAppender()
+{
+    disconnect();
+}
+
+bool UnixSocketAppender::configureHook()
+{
+    // verify valid limits
+    int m = maxEventsPerCycle_prop.rvalue();
+    if ((0 > m))
+    {
+        log(Error) << "Invalid maxEventsPerCycle value of "
+                   << m << ". Value must be >= 0."
+                   << endlog();
+        return false;
+    }
+    if ((1024 > maxPacketSize_prop.rvalue()) || (0 > reconnectInterval_prop.rvalue()))
+    {
+        log(Error) << "Invalid MaxPacketSize or ReconnectInterval value of "
+                   << maxPacketSize_prop.rvalue() << " or " << reconnectInterval_prop.rvalue()
+                   << ". Values must be >= 1024 and >= 0." << endlog();
+        return false;
+    }
+    const std::string& type = socketType_prop.rvalue();
+    if ("seqpacket" == type)
+    {
+        socketType = SOCK_SEQPACKET;
+    }
+    else if ("datagram" == type)
+    {
+        socketType = SOCK_DGRAM;
+    }
+    else
+    {
+        log(Error) << "Invalid SocketType '" << type
+                   << "'. Value must be 'seqpacket' or 'datagram'." << endlog();
+        return false;
+    }
+    if (sizeof(((struct sockaddr_un*)0)->sun_path) <= socketPath_prop.rvalue().size())
+    {
+        log(Error) << "SocketPath '" << socketPath_prop.rvalue() << "' is too long." << endlog();
+        return false;
+    }
+
+    // in case the path changed...
+    disconnect();
+
+    maxEventsPerCycle   = m;
+    maxPacketSize       = maxPacketSize_prop.rvalue();
+    lastAttempt         = 0;
+    eventsSent          = 0;
+    droppedEvents       = 0;
+    packetsSent         = 0;
+    packet.clear();
+    packetEvents        = 0;
+    packet.reserve(maxPacketSize);
+    configured          = true;
+
+    // the collector may come later
+    if (!connect())
+    {
+        log(Warning) << "No log collector at " << socketPath_prop.rvalue()
+                     << " yet, dropping events until there is." << endlog();
+    }
+    updateStatistics();
+    return true;
+}
+
+void UnixSocketAppender::updateHook()
+{
+	processEvents(maxEventsPerCycle);
+    sendPacket();
+    updateStatistics();
+}
+
+void UnixSocketAppender::stopHook()
+{
+    Appender::stopHook();
+    sendPacket();
+    updateStatistics();
+}
+
+void UnixSocketAppender::cleanupHook()
+{
+    sendPacket();
+    disconnect();
+    configured = false;
+}
+
+void UnixSocketAppender::appendEvent(const OCL::logging::LoggingEvent& event)
+{
+    if (!connect())
+    {
+        ++droppedEvents;
+        return;
+    }
+
+    record.clear();
+    encoder.encode(event, record);
+    if (!packet.empty() && (packet.size() + record.size() > maxPacketSize))
+    {
+        if (!sendPacket())
+        {
+            if (-1 == fd)
+            {
+                ++droppedEvents;
+                return;
+            }
+            // the names in the record may be in the dropped packet
+            record.clear();
+            encoder.encode(event, record);
+        }
+    }
+    packet += record;
+    ++packetEvents;
+}
+
+bool UnixSocketAppender::hasOutput() const
+{
+    // also when not connected, to drop the events meanwhile
+    return configured;
+}
+
+bool UnixSocketAppender::connect()
+{
+    if (-1 != fd)
+        return true;
+
+    os::TimeService* ts = os::TimeService::Instance();
+    if ((0 != lastAttempt) && (ts->secondsSince(lastAttempt) < reconnectInterval_prop.rvalue()))
+        return false;
+    lastAttempt = ts->getTicks();
+
+    const std::string& path = socketPath_prop.rvalue();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int s = ::socket(AF_UNIX, socketType, 0);
+    if (-1 == s)
+    {
+        return false;
+    }
+    if (0 != ::connect(s, (struct sockaddr*)&addr, sizeof(addr)))
+    {
+        ::close(s);
+        return false;
+    }
+    // starts the connection, the collector learns the names anew
+    BinaryLog::FileHeader header;
+    BinaryLog::initHeader(header);
+    if ((ssize_t)sizeof(header) != ::send(s, &header, sizeof(header), MSG_DONTWAIT | MSG_NOSIGNAL))
+    {
+        ::close(s);
+        return false;
+    }
+    encoder.reset();
+    fd = s;
+    log(Info) << "Connected to log collector at " << path << endlog();
+    return true;
+}
+
+void UnixSocketAppender::disconnect()
+{
+    if (-1 != fd)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool UnixSocketAppender::sendPacket()
+{
+    if (packet.empty())
+        return true;
+
+    bool sent = false;
+    if (-1 != fd)
+    {
+        ssize_t n = ::send(fd, packet.data(), packet.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if ((ssize_t)packet.size() == n)
+        {
+            sent = true;
+        }
+        else if ((-1 == n) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (ENOBUFS == errno)))
+        {
+            // the collector does not keep up, and misses the names in this packet
+            encoder.reset();
+        }
+        else
+        {
+            log(Warning) << "Lost connection to log collector at " << socketPath_prop.rvalue()
+                         << ": " << strerror(errno) << endlog();
+            disconnect();
+        }
+    }
+
+    if (sent)
+    {
+        eventsSent += packetEvents;
+        ++packetsSent;
+    }
+    else
+    {
+        droppedEvents += packetEvents;
+    }
+    packet.clear();
+    packetEvents = 0;
+    return sent;
+}
+
+void UnixSocketAppender::updateStatistics()
+{
+    eventsSent_prop     = eventsSent;
+    droppedEvents_prop  = droppedEvents;
+    packetsSent_prop    = packetsSent;
+    connected_prop      = (-1 != fd);
+}
+
+// namespaces
+}
+}
+
+ORO_LIST_COMPONENT_TYPE(OCL::logging::UnixSocketAppender)
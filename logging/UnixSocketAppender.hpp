@@ -0,0 +1,112 @@
+#ifndef	UNIXSOCKETAPPENDER_HPP
+#define	UNIXSOCKETAPPENDER_HPP 1
+
+#include "Appender.hpp"
+#include "BinaryLog.hpp"
+#include <rtt/Property.hpp>
+#include <rtt/os/TimeService.hpp>
+
+namespace OCL {
+namespace logging {
+
+/** Appender sending events to a log collector on the same host, over a
+    Unix domain socket, in the binary log format (see BinaryLog).
+
+    The events of a cycle are encoded into packets of at most
+    \a MaxPacketSize bytes, each holding whole records. Every connection
+    starts with a packet holding only a BinaryLog::FileHeader, after which
+    the name of each category and format is sent once, before the first
+    event which refers to it.
+
+    \a SocketType is "seqpacket" (default), where the collector accepts a
+    connection per appender, or "datagram", where the collector reads a
+    single socket. A datagram collector treats a header packet as a new
+    connection, so use one appender per datagram socket.
+
+    Sending never blocks. When the collector does not keep up, the packet
+    is dropped and its names are sent again with the next events. When the
+    collector is gone, events are dropped until it is back, which is
+    checked every \a ReconnectInterval seconds. See ocl-logreceive
+    (logreceive.cpp) for a reference collector.
+*/
+class UnixSocketAppender : public OCL::logging::Appender
+{
+public:
+	UnixSocketAppender(std::string name);
+	virtual ~UnixSocketAppender();
+protected:
+	/// Check the properties, and try to connect
+    virtual bool configureHook();
+	/// Process at most \a maxEventsPerCycle events, and send them
+	virtual void updateHook();
+	/// Drain the buffer and send it
+	virtual void stopHook();
+	/// Close the socket
+	virtual void cleanupHook();
+
+    virtual void appendEvent(const OCL::logging::LoggingEvent& event);
+    virtual bool hasOutput() const;
+
+    /// Connect, at most every \a ReconnectInterval seconds
+    bool connect();
+    /// Close the socket
+    void disconnect();
+    /** Send the encoded events of \a packet
+        \return false if they were dropped, in which case the encoder is
+        reset or the socket closed
+    */
+    bool sendPacket();
+    /// Copy the statistics to their properties
+    void updateStatistics();
+
+    /// Path of the socket of the collector
+    RTT::Property<std::string>      socketPath_prop;
+    /// "seqpacket" or "datagram"
+    RTT::Property<std::string>      socketType_prop;
+    RTT::Property<int>              maxPacketSize_prop;
+    RTT::Property<double>           reconnectInterval_prop;
+    /**
+     * Property to set maximum number of log events to pop per cycle
+     */
+    RTT::Property<int>              maxEventsPerCycle_prop;
+    /// Statistics since configure (read-only)
+    RTT::Property<int>              eventsSent_prop;
+    RTT::Property<int>              droppedEvents_prop;
+    RTT::Property<int>              packetsSent_prop;
+    RTT::Property<bool>             connected_prop;
+
+    /**
+     * Maximum number of log events to pop per cycle
+     *
+     * Defaults to 0, as events are sent per packet anyway.
+     *
+     * A value of 0 indicates to not limit the number of events per cycle.
+     * With enough event production, this could lead to thread
+     * starvation!
+     */
+    int                             maxEventsPerCycle;
+    /// SOCK_SEQPACKET or SOCK_DGRAM
+    int                             socketType;
+    std::size_t                     maxPacketSize;
+    /// -1 when not connected
+    int                             fd;
+    /// Whether the appender is configured
+    bool                            configured;
+    RTT::os::TimeService::ticks     lastAttempt;
+    int                             eventsSent;
+    int                             droppedEvents;
+    int                             packetsSent;
+
+    BinaryLogEncoder                encoder;
+    /// Records to send, and the number of events among them
+    std::string                     packet;
+    int                             packetEvents;
+    /// Records of the current event
+    std::string                     record;
+};
+
+// namespaces
+}
+}
+
+#endif
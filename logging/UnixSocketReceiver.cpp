@@ -0,0 +1,190 @@
+#include "logging/UnixSocketReceiver.hpp"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace OCL {
+namespace logging {
+
+UnixSocketReceiver::UnixSocketReceiver() :
+        datagram(false),
+        fd(-1),
+        // larger than any packet of a Unix domain socket
+        buffer(256 * 1024),
+        invalid(0)
+{
+}
+
+UnixSocketReceiver::~UnixSocketReceiver()
+{
+    close();
+}
+
+bool UnixSocketReceiver::open(const std::string& path, bool datagram)
+{
+    close();
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (sizeof(addr.sun_path) <= path.size())
+    {
+        fprintf(stderr, "%s: socket path too long\n", path.c_str());
+        return false;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd = ::socket(AF_UNIX, datagram ? SOCK_DGRAM : SOCK_SEQPACKET, 0);
+    ::unlink(path.c_str());
+    if ((-1 == fd) ||
+        (0 != ::bind(fd, (struct sockaddr*)&addr, sizeof(addr))) ||
+        (!datagram && (0 != ::listen(fd, 8))))
+    {
+        perror(path.c_str());
+        close();
+        return false;
+    }
+    this->path      = path;
+    this->datagram  = datagram;
+    if (datagram)
+    {
+        peers.push_back(new Peer(fd));
+    }
+    return true;
+}
+
+void UnixSocketReceiver::close()
+{
+    for (std::size_t i = 0; i < peers.size(); ++i)
+    {
+        if (fd != peers[i]->fd)
+            ::close(peers[i]->fd);
+        delete peers[i];
+    }
+    peers.clear();
+    if (-1 != fd)
+    {
+        ::close(fd);
+        fd = -1;
+        ::unlink(path.c_str());
+    }
+}
+
+int UnixSocketReceiver::receive(int timeout, std::vector<DecodedEvent>& events)
+{
+    if (-1 == fd)
+        return -1;
+
+    // the listener first, unless it is the datagram socket itself
+    std::vector<struct pollfd> fds(datagram ? 0 : 1);
+    if (!datagram)
+    {
+        fds[0].fd       = fd;
+        fds[0].events   = POLLIN;
+    }
+    for (std::size_t i = 0; i < peers.size(); ++i)
+    {
+        struct pollfd p;
+        p.fd        = peers[i]->fd;
+        p.events    = POLLIN;
+        fds.push_back(p);
+    }
+    if (0 > ::poll(&fds[0], fds.size(), timeout))
+    {
+        return (EINTR == errno) ? 0 : -1;
+    }
+
+    int count = 0;
+    const std::size_t first = datagram ? 0 : 1;
+    for (std::size_t i = fds.size(); first < i--; )
+    {
+        if (0 == fds[i].revents)
+            continue;
+        Peer* peer = peers[i - first];
+        ssize_t n = ::recv(peer->fd, &buffer[0], buffer.size(), MSG_DONTWAIT);
+        if (0 < n)
+        {
+            count += decodePacket(*peer, &buffer[0], n, events);
+        }
+        else if (!datagram && ((0 == n) || ((EAGAIN != errno) && (EINTR != errno))))
+        {
+            // the appender disconnected
+            ::close(peer->fd);
+            delete peer;
+            peers.erase(peers.begin() + (i - first));
+        }
+    }
+    if (!datagram && (0 != fds[0].revents))
+    {
+        int c = ::accept(fd, 0, 0);
+        if (-1 != c)
+        {
+            peers.push_back(new Peer(c));
+        }
+    }
+    return count;
+}
+
+int UnixSocketReceiver::decodePacket(Peer& peer, const char* data, std::size_t size,
+                                     std::vector<DecodedEvent>& events)
+{
+    BinaryLog::FileHeader header;
+    if (sizeof(header) == size)
+    {
+        memcpy(&header, data, sizeof(header));
+        if (BinaryLog::checkHeader(header))
+        {
+            // a new connection, which sends the names anew
+            peer.decoder    = BinaryLogDecoder();
+            peer.started    = true;
+            return 0;
+        }
+    }
+    if (!peer.started)
+    {
+        ++invalid;
+        return 0;
+    }
+
+    int         count = 0;
+    std::size_t begin = 0;
+    bool        isEvent;
+    DecodedEvent event;
+    int         n;
+    while ((begin < size) &&
+           (0 < (n = peer.decoder.decode(data + begin, size - begin, isEvent, event))))
+    {
+        begin += n;
+        if (isEvent)
+        {
+            events.push_back(event);
+            ++count;
+        }
+    }
+    // packets hold whole records
+    if (begin != size)
+    {
+        ++invalid;
+    }
+    return count;
+}
+
+int UnixSocketReceiver::invalidPackets() const
+{
+    return invalid;
+}
+
+int UnixSocketReceiver::connections() const
+{
+    return datagram ? 0 : peers.size();
+}
+
+// namespaces
+}
+}
@@ -0,0 +1,79 @@
+#ifndef	UNIXSOCKETRECEIVER_HPP
+#define	UNIXSOCKETRECEIVER_HPP 1
+
+#include "BinaryLog.hpp"
+#include <string>
+#include <vector>
+
+namespace OCL {
+namespace logging {
+
+/** Reference log collector for the UnixSocketAppender, as used by
+    ocl-logreceive and the tests.
+
+    Binds a Unix domain socket and decodes the packets of the appenders.
+    With seqpacket sockets each connection of an appender has its own
+    names. With a datagram socket a header packet starts anew, so only
+    one appender can send to it.
+*/
+class UnixSocketReceiver
+{
+public:
+    UnixSocketReceiver();
+    /// Close the sockets
+    ~UnixSocketReceiver();
+
+    /** Bind to \a path, replacing any socket there
+        \param datagram Whether to read a datagram socket instead of
+        accepting seqpacket connections
+    */
+    bool open(const std::string& path, bool datagram);
+    /// Close the sockets and remove the socket file
+    void close();
+
+    /** Wait at most \a timeout milliseconds for packets, and decode them.
+        \param events The decoded events are appended to it
+        \return the number of events decoded, or -1 on error
+    */
+    int receive(int timeout, std::vector<DecodedEvent>& events);
+
+    /// Number of packets which could not be decoded
+    int invalidPackets() const;
+    /// Number of appenders connected, always 0 for a datagram socket
+    int connections() const;
+
+protected:
+    /// A connected appender
+    struct Peer
+    {
+        Peer(int fd) : fd(fd), started(false) {}
+        int                 fd;
+        BinaryLogDecoder    decoder;
+        /// Whether the header was received
+        bool                started;
+    };
+
+    /// Decode a packet of \a size bytes from \a peer
+    int decodePacket(Peer& peer, const char* data, std::size_t size,
+                     std::vector<DecodedEvent>& events);
+
+    std::string             path;
+    bool                    datagram;
+    /// The bound socket, -1 if not open
+    int                     fd;
+    /// Connections, or the bound socket itself for datagrams
+    std::vector<Peer*>      peers;
+    std::vector<char>       buffer;
+    int                     invalid;
+
+private:
+    /* prevent copying and assignment */
+    UnixSocketReceiver(const UnixSocketReceiver& other);
+    UnixSocketReceiver& operator=(const UnixSocketReceiver& other);
+};
+
+// namespaces
+}
+}
+
+#endif
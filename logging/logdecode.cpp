@@ -0,0 +1,156 @@
+/** Convert binary log files written by the BinaryFileAppender, and ring
+    files written by the RingFileAppender, to text.
+
+    Usage: ocl-logdecode [file...]
+
+    Reads standard input if no file is given.
+*/
+
+#include "BinaryLog.hpp"
+#include "RingLog.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace OCL::logging;
+
+namespace {
+
+bool decodeRing(std::istream& in, const char* name, const char* magic, std::size_t size)
+{
+    std::vector<char> data(magic, magic + size);
+    data.insert(data.end(), std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+    std::vector<std::string> records;
+    RingLog::RingHeader header;
+    if (data.empty() || !RingLog::readRecords(&data[0], data.size(), records))
+    {
+        std::cerr << name << ": invalid ring file" << std::endl;
+        return false;
+    }
+    memcpy(&header, &data[0], sizeof(header));
+
+    BinaryLogDecoder    decoder;
+    DecodedEvent        event;
+    std::string         text;
+    std::vector<std::string>::const_iterator it;
+    for (it = records.begin(); it != records.end(); ++it)
+    {
+        if (RingLog::TextFormat == header.format)
+        {
+            std::cout << *it;
+            continue;
+        }
+        // each record holds an event with the names it refers to
+        std::size_t begin = 0;
+        bool        isEvent;
+        int         n;
+        while ((begin < it->size()) &&
+               (0 < (n = decoder.decode(it->data() + begin, it->size() - begin, isEvent, event))))
+        {
+            begin += n;
+            if (isEvent)
+            {
+                text.clear();
+                event.toText(text);
+                std::cout << text;
+            }
+        }
+        if (begin != it->size())
+        {
+            std::cerr << name << ": invalid record" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decode(std::istream& in, const char* name)
+{
+    // both formats start with their magic
+    BinaryLog::FileHeader header;
+    char* p = reinterpret_cast<char*>(&header);
+    if (in.read(p, sizeof(header.magic)) &&
+        (0 == memcmp(p, RingLog::Magic, sizeof(RingLog::Magic))))
+    {
+        return decodeRing(in, name, p, sizeof(header.magic));
+    }
+    if (!in.read(p + sizeof(header.magic), sizeof(header) - sizeof(header.magic)) ||
+        !BinaryLog::checkHeader(header))
+    {
+        std::cerr << name << ": not a binary log or ring file" << std::endl;
+        return false;
+    }
+
+    BinaryLogDecoder    decoder;
+    DecodedEvent        event;
+    std::vector<char>   data;
+    std::size_t         begin = 0;
+    std::string         text;
+    char                chunk[64 * 1024];
+    bool                more = true;
+    while (more)
+    {
+        in.read(chunk, sizeof(chunk));
+        more = (in.gcount() == sizeof(chunk));
+        data.erase(data.begin(), data.begin() + begin);
+        data.insert(data.end(), chunk, chunk + in.gcount());
+        begin = 0;
+
+        bool isEvent;
+        int  n = 0;
+        while ((begin < data.size()) &&
+               (0 < (n = decoder.decode(&data[begin], data.size() - begin, isEvent, event))))
+        {
+            begin += n;
+            if (isEvent)
+            {
+                text.clear();
+                event.toText(text);
+                std::cout << text;
+            }
+        }
+        if (n < 0)
+        {
+            std::cerr << name << ": invalid record" << std::endl;
+            return false;
+        }
+    }
+    if (begin != data.size())
+    {
+        // eg when the process was killed while writing
+        std::cerr << name << ": incomplete last record" << std::endl;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (1 == argc)
+        return decode(std::cin, "<stdin>") ? 0 : 1;
+
+    int rc = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "--help")))
+        {
+            std::cout << "Usage: " << argv[0] << " [file...]" << std::endl;
+            return 0;
+        }
+        std::ifstream file(argv[i], std::ios::in | std::ios::binary);
+        if (!file)
+        {
+            std::cerr << argv[i] << ": could not open file" << std::endl;
+            rc = 1;
+            continue;
+        }
+        if (!decode(file, argv[i]))
+            rc = 1;
+    }
+    return rc;
+}
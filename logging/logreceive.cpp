@@ -0,0 +1,76 @@
+/** Reference log collector for the UnixSocketAppender. Receives events on
+    a Unix domain socket and prints them as text, like ocl-logdecode.
+
+    Usage: ocl-logreceive [--datagram] [--count N] socket-path
+
+    --datagram  Read a datagram socket, instead of accepting seqpacket
+                connections
+    --count N   Exit after receiving N events
+*/
+
+#include "UnixSocketReceiver.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace OCL::logging;
+
+int main(int argc, char** argv)
+{
+    bool        datagram = false;
+    long        count = -1;
+    const char* path = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (0 == strcmp(argv[i], "--datagram"))
+            datagram = true;
+        else if ((0 == strcmp(argv[i], "--count")) && (i + 1 < argc))
+            count = atol(argv[++i]);
+        else if (('-' != argv[i][0]) && !path)
+            path = argv[i];
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [--datagram] [--count N] socket-path" << std::endl;
+            return ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "--help"))) ? 0 : 1;
+        }
+    }
+    if (!path)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--datagram] [--count N] socket-path" << std::endl;
+        return 1;
+    }
+
+    UnixSocketReceiver receiver;
+    if (!receiver.open(path, datagram))
+        return 1;
+
+    std::vector<DecodedEvent>   events;
+    std::string                 text;
+    long                        received = 0;
+    int                         invalid = 0;
+    while ((0 > count) || (received < count))
+    {
+        events.clear();
+        if (0 > receiver.receive(1000, events))
+        {
+            std::cerr << path << ": could not receive" << std::endl;
+            return 1;
+        }
+        for (std::size_t i = 0; i < events.size(); ++i)
+        {
+            text.clear();
+            events[i].toText(text);
+            std::cout << text;
+        }
+        std::cout.flush();
+        received += events.size();
+        if (invalid != receiver.invalidPackets())
+        {
+            invalid = receiver.invalidPackets();
+            std::cerr << path << ": " << invalid << " invalid packets" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,333 @@
+/** Search log files written by the OCL file appenders, reading only the
+    blocks which an index says may hold matching events (see LogIndex).
+    The index of each file is built or updated first, and saved next to it
+    as file.idx.
+
+    Usage: ocl-logsearch [options] file...
+      --from TIME        Only events at or after TIME
+      --to TIME          Only events at or before TIME
+      --category NAME    Only events of category NAME or its descendants.
+                         May be given more than once.
+      --priority NAME    Only events of priority NAME or more severe, eg WARN
+      --block-size N     Size in bytes of new index blocks (default 1 MiB)
+      --index-only       Build or update the indexes, do not search
+      --stats            Report how many blocks were read, on stderr
+
+    TIME is "YYYY-MM-DD HH:MM:SS" in local time, or seconds since the epoch.
+
+    Each file is searched together with the other files of its set, as
+    written by the rolling and generational appenders, oldest first: the
+    backups file.N .. file.1 before file, or the generations file.0,
+    file.1, ... when file itself does not exist. Compressed files of a
+    set are skipped.
+
+    Binary log events are written as ocl-logdecode does, text log lines
+    as they are.
+*/
+
+#include "LogIndex.hpp"
+#include "BinaryLog.hpp"
+#include <log4cpp/Priority.hh>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace OCL::logging;
+
+namespace {
+
+/// Blocks read and indexed, for --stats
+std::size_t blocksRead  = 0;
+std::size_t blocksTotal = 0;
+
+bool exists(const std::string& path)
+{
+    struct stat s;
+    return 0 == stat(path.c_str(), &s);
+}
+
+/** Append the files of the set \a name to \a files, oldest first
+    \return false if there are none
+*/
+bool expandFileSet(const std::string& name, std::vector<std::string>& files)
+{
+    const std::string::size_type slash = name.rfind('/');
+    const std::string directory = (std::string::npos == slash) ? "." : name.substr(0, slash + 1);
+    const std::string prefix    = name.substr((std::string::npos == slash) ? 0 : slash + 1) + ".";
+
+    // numbered files of the set, and their numbers
+    std::vector<std::pair<long, std::string> > numbered;
+    DIR* dir = opendir(directory.c_str());
+    struct dirent* entry;
+    while (dir && (0 != (entry = readdir(dir))))
+    {
+        const std::string file = entry->d_name;
+        if ((file.size() <= prefix.size()) || (0 != file.compare(0, prefix.size(), prefix)))
+            continue;
+        const char* number  = file.c_str() + prefix.size();
+        char*       end;
+        const long  n       = strtol(number, &end, 10);
+        if ((end == number) || ('-' == *number) || ('+' == *number))
+            continue;
+        const std::string path = (std::string::npos == slash) ? file : directory + file;
+        if ('\0' != *end)
+        {
+            if (0 != strcmp(end, ".idx") && (0 != strcmp(end, ".idx.tmp")) && (0 != strcmp(end, ".next")))
+                std::cerr << path << ": compressed or unknown file in the set, skipped" << std::endl;
+            continue;
+        }
+        numbered.push_back(std::make_pair(n, path));
+    }
+    if (dir)
+        closedir(dir);
+    std::sort(numbered.begin(), numbered.end());
+
+    const bool rolling = exists(name);
+    if (rolling)
+        std::reverse(numbered.begin(), numbered.end());
+    for (std::size_t i = 0; i < numbered.size(); ++i)
+        files.push_back(numbered[i].second);
+    if (rolling)
+        files.push_back(name);
+    return rolling || !numbered.empty();
+}
+
+/// Write the events of \a data, a block of a binary log, which match \a query
+void searchBinary(const std::vector<char>& data, BinaryLogDecoder& decoder,
+                  const LogIndex::Query& query, const char* name)
+{
+    DecodedEvent    event;
+    std::string     text;
+    std::size_t     begin = 0;
+    bool            isEvent;
+    int             n = 0;
+    while ((begin < data.size()) &&
+           (0 < (n = decoder.decode(&data[begin], data.size() - begin, isEvent, event))))
+    {
+        begin += n;
+        if (isEvent && query.matches(event.seconds, event.priority, event.category))
+        {
+            text.clear();
+            event.toText(text);
+            std::cout << text;
+        }
+    }
+    if (begin != data.size())
+        std::cerr << name << ": invalid record" << std::endl;
+}
+
+/// Write the lines of \a data, a block of a text log, of the events which
+/// match \a query
+void searchText(const std::vector<char>& data, const LogIndex::Query& query, bool filtering)
+{
+    // lines before the first event only match when not filtering
+    bool            matches = !filtering;
+    boost::int64_t  seconds;
+    int             priority;
+    std::string     category;
+    std::size_t     begin = 0;
+    while (begin < data.size())
+    {
+        const char* line    = &data[begin];
+        const char* end     = (const char*)memchr(line, '\n', data.size() - begin);
+        const std::size_t size = end ? end - line + 1 : data.size() - begin;
+        if (LogIndex::parseLine(line, size, seconds, priority, category))
+            matches = query.matches(seconds, priority, category);
+        if (matches)
+            std::cout.write(line, size);
+        begin += size;
+    }
+}
+
+/** Index \a path and write its events which match \a query
+    \return false on errors
+*/
+bool search(const std::string& path, const LogIndex::Query& query, bool filtering,
+            std::size_t blockSize, bool indexOnly)
+{
+    LogIndex index;
+    if (!index.update(path, blockSize))
+    {
+        std::cerr << path << ": " << index.getError() << std::endl;
+        // search what could be indexed of a partly written file
+        if (index.getBlocks().empty())
+            return false;
+    }
+    if (index.isModified() && !index.save())
+    {
+        std::cerr << LogIndex::indexPath(path) << ": could not save the index" << std::endl;
+    }
+    blocksTotal += index.getBlocks().size();
+    if (indexOnly)
+        return true;
+
+    std::vector<std::size_t> found;
+    index.find(query, found);
+    if (found.empty())
+        return true;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (0 == file)
+    {
+        std::cerr << path << ": could not open file" << std::endl;
+        return false;
+    }
+
+    BinaryLogDecoder decoder;
+    if (LogIndex::BinaryFile == index.getFormat())
+    {
+        std::string names;
+        index.getNameRecords(names);
+        bool isEvent;
+        DecodedEvent event;
+        int n;
+        for (std::size_t begin = 0; (begin < names.size()) &&
+                 (0 < (n = decoder.decode(names.data() + begin, names.size() - begin,
+                                          isEvent, event))); begin += n)
+            ;
+    }
+
+    bool ok = true;
+    std::vector<char> data;
+    for (std::size_t i = 0; ok && (i < found.size()); ++i)
+    {
+        ok = index.readBlock(file, index.getBlocks()[found[i]], data);
+        if (!ok)
+        {
+            std::cerr << path << ": could not read block " << found[i] << std::endl;
+        }
+        else if (LogIndex::BinaryFile == index.getFormat())
+        {
+            searchBinary(data, decoder, query, path.c_str());
+        }
+        else
+        {
+            searchText(data, query, filtering);
+        }
+        ++blocksRead;
+    }
+    std::fclose(file);
+    return ok;
+}
+
+void usage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--from TIME] [--to TIME] [--category NAME]..."
+              << " [--priority NAME] [--block-size N] [--index-only] [--stats] file..."
+              << std::endl
+              << "See the top of logsearch.cpp for details." << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    LogIndex::Query             query;
+    bool                        filtering = false;
+    std::size_t                 blockSize = LogIndex::DefaultBlockSize;
+    bool                        indexOnly = false;
+    bool                        stats     = false;
+    std::vector<std::string>    names;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (("-h" == a) || ("--help" == a))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        if ("--index-only" == a) { indexOnly = true; continue; }
+        if ("--stats" == a) { stats = true; continue; }
+        if (0 != a.compare(0, 2, "--"))
+        {
+            names.push_back(a);
+            continue;
+        }
+
+        if (i + 1 == argc)
+        {
+            std::cerr << "Missing value for option " << a << std::endl;
+            return 1;
+        }
+        const std::string v = argv[++i];
+        bool valid = true;
+        if ("--from" == a)
+        {
+            valid = LogIndex::parseTime(v, query.from);
+            filtering = true;
+        }
+        else if ("--to" == a)
+        {
+            valid = LogIndex::parseTime(v, query.to);
+            filtering = true;
+        }
+        else if ("--category" == a)
+        {
+            query.categories.push_back(v);
+            filtering = true;
+        }
+        else if ("--priority" == a)
+        {
+            try
+            {
+                query.priority = log4cpp::Priority::getPriorityValue(v);
+                filtering = true;
+            }
+            catch (std::invalid_argument&)
+            {
+                valid = false;
+            }
+        }
+        else if ("--block-size" == a)
+        {
+            blockSize = strtoul(v.c_str(), 0, 10);
+            valid = 0 < blockSize;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << a << std::endl;
+            usage(argv[0]);
+            return 1;
+        }
+        if (!valid)
+        {
+            std::cerr << "Invalid value '" << v << "' for option " << a << std::endl;
+            return 1;
+        }
+    }
+    if (names.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int rc = 0;
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        std::vector<std::string> files;
+        if (!expandFileSet(names[i], files))
+        {
+            std::cerr << names[i] << ": no such file or file set" << std::endl;
+            rc = 1;
+            continue;
+        }
+        for (std::size_t j = 0; j < files.size(); ++j)
+        {
+            if (!search(files[j], query, filtering, blockSize, indexOnly))
+                rc = 1;
+        }
+    }
+    if (stats)
+    {
+        std::cerr << "Read " << blocksRead << " of " << blocksTotal << " blocks" << std::endl;
+    }
+    return rc;
+}
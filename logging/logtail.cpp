@@ -0,0 +1,192 @@
+/** Follow the ring in shared memory of a SharedMemoryAppender, and print
+    its events as they are logged, like "tail -f".
+
+    Usage: ocl-logtail [options] [name]
+      --category NAME    Only events of category NAME or its descendants.
+                         May be given more than once.
+      --priority NAME    Only events of priority NAME or more severe, eg WARN
+      --all              Start with the events already in the ring
+      --interval SECONDS Time between polls of the ring (default 0.1)
+
+    The name of the shared memory object defaults to "/ocl-logging". Binary
+    events are printed as ocl-logdecode does, text events as they are. Text
+    events are filtered when their layout is one that LogIndex parses.
+    When events are overwritten before they are read, a line reporting how
+    many were lost is printed in their place. The viewer waits for the
+    appender to start, and follows it when it is configured again.
+*/
+
+#include "SharedMemoryReader.hpp"
+#include "BinaryLog.hpp"
+#include "LogIndex.hpp"
+#include <log4cpp/Priority.hh>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace OCL::logging;
+
+namespace {
+
+/// Print \a record of a binary ring, if its event matches \a query
+void printBinary(const std::string& record, const LogIndex::Query& query)
+{
+    // each record holds an event with the names it refers to
+    BinaryLogDecoder    decoder;
+    DecodedEvent        event;
+    std::string         text;
+    std::size_t         begin = 0;
+    bool                isEvent;
+    int                 n;
+    while ((begin < record.size()) &&
+           (0 < (n = decoder.decode(record.data() + begin, record.size() - begin, isEvent, event))))
+    {
+        begin += n;
+        if (isEvent && query.matches(event.seconds, event.priority, event.category))
+        {
+            text.clear();
+            event.toText(text);
+            std::cout << text;
+        }
+    }
+    if (begin != record.size())
+        std::cerr << "ocl-logtail: invalid record" << std::endl;
+}
+
+/// Print \a record of a text ring, if its event matches \a query
+void printText(const std::string& record, const LogIndex::Query& query, bool filtering)
+{
+    boost::int64_t  seconds;
+    int             priority;
+    std::string     category;
+    if (LogIndex::parseLine(record.data(), record.size(), seconds, priority, category) ?
+        query.matches(seconds, priority, category) : !filtering)
+    {
+        std::cout << record;
+    }
+}
+
+void usage(const char* program)
+{
+    std::cout << "Usage: " << program << " [--category NAME]... [--priority NAME] [--all]"
+              << " [--interval SECONDS] [name]" << std::endl
+              << "See the top of logtail.cpp for details." << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    LogIndex::Query query;
+    bool            filtering = false;
+    bool            all       = false;
+    double          interval  = 0.1;
+    std::string     name      = "/ocl-logging";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (("-h" == a) || ("--help" == a))
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        if ("--all" == a) { all = true; continue; }
+        if (0 != a.compare(0, 2, "--"))
+        {
+            name = a;
+            continue;
+        }
+
+        if (i + 1 == argc)
+        {
+            std::cerr << "Missing value for option " << a << std::endl;
+            return 1;
+        }
+        const std::string v = argv[++i];
+        bool valid = true;
+        if ("--category" == a)
+        {
+            query.categories.push_back(v);
+            filtering = true;
+        }
+        else if ("--priority" == a)
+        {
+            try
+            {
+                query.priority = log4cpp::Priority::getPriorityValue(v);
+                filtering = true;
+            }
+            catch (std::invalid_argument&)
+            {
+                valid = false;
+            }
+        }
+        else if ("--interval" == a)
+        {
+            interval = atof(v.c_str());
+            valid = 0 < interval;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << a << std::endl;
+            usage(argv[0]);
+            return 1;
+        }
+        if (!valid)
+        {
+            std::cerr << "Invalid value '" << v << "' for option " << a << std::endl;
+            return 1;
+        }
+    }
+
+    SharedMemoryReader          reader;
+    std::vector<std::string>    records;
+    boost::uint64_t             lost = 0;
+    // polls between checks whether the ring was replaced, about a second
+    const int                   checkEvery = std::max(1, (int)(1.0 / interval));
+    int                         polls = 0;
+    bool                        waiting = false;
+    for (;; usleep((useconds_t)(interval * 1e6)))
+    {
+        if (!reader.isAttached() || ((0 == ++polls % checkEvery) && reader.isReplaced()))
+        {
+            // the events already in a new ring are new to us
+            if (!reader.attach(name, all || reader.isAttached() || waiting))
+            {
+                if (!waiting)
+                    std::cerr << "ocl-logtail: waiting for " << name << std::endl;
+                waiting = true;
+                usleep(1000000);
+                continue;
+            }
+            waiting = false;
+            lost    = 0;
+        }
+
+        records.clear();
+        reader.read(records);
+        if (lost != reader.lostRecords())
+        {
+            std::cout << "*** ocl-logtail: " << reader.lostRecords() - lost
+                      << " events lost, as they were overwritten before they were read ***"
+                      << std::endl;
+            lost = reader.lostRecords();
+        }
+        const bool binary = (RingLog::BinaryFormat == reader.getFormat());
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            if (binary)
+                printBinary(records[i], query);
+            else
+                printText(records[i], query, filtering);
+        }
+        std::cout.flush();
+    }
+    return 0;
+}
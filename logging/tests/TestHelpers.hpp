@@ -0,0 +1,105 @@
+#ifndef	TESTHELPERS_HPP
+#define	TESTHELPERS_HPP 1
+
+#include <rtt/os/main.h>
+#include <rtt/TaskContext.hpp>
+#include <rtt/ConnPolicy.hpp>
+#include <log4cpp/HierarchyMaintainer.hh>
+#include "logging/Category.hpp"
+
+#include <unistd.h>
+#include <iostream>
+
+namespace OCL {
+namespace logging {
+namespace test {
+
+/** Start Orocos with our log4cpp-derived categories
+    \return false if Orocos could not be started */
+inline bool startOrocos(int argc, char** argv)
+{
+    // use our log4cpp-derived categories, before __os_init()
+    log4cpp::HierarchyMaintainer::set_category_factory(
+        OCL::logging::Category::createOCLCategory);
+    if ( 0 != __os_init(argc, argv) ) {
+        std::cerr << "Unable to start Orocos" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/// The value of property \a name of \a component
+template<class T>
+T getProperty(RTT::TaskContext& component, const char* name)
+{
+    return component.properties()->getPropertyType<T>(name)->get();
+}
+
+/** The category \a name, logging INFO to the LogPort of \a appender
+    through a buffer of \a capacity events
+    \return 0 if it could not be connected */
+inline OCL::logging::Category* connectCategory(const char* name,
+                                               RTT::TaskContext& appender,
+                                               int capacity)
+{
+    OCL::logging::Category* category = dynamic_cast<OCL::logging::Category*>(
+        &log4cpp::Category::getInstance(name));
+    RTT::base::PortInterface* port = appender.ports()->getPort("LogPort");
+    RTT::ConnPolicy cp = RTT::ConnPolicy::buffer(capacity, RTT::ConnPolicy::LOCK_FREE, false, false);
+    if ( !category || !port || !category->connectToLogPort(*port, cp) )
+        return 0;
+    category->setPriority(log4cpp::Priority::INFO);
+    return category;
+}
+
+/// Report \a what as failed unless \a ok
+inline bool check(bool ok, const char* what)
+{
+    if ( !ok )
+        std::cerr << "FAILED: " << what << std::endl;
+    return ok;
+}
+
+/**
+ * Bounds a wait for an appender or a receiver to catch up: waiting goes on
+ * while the progress made changes, and stops once it did not change for
+ * \a ticks polls in a row.
+ */
+class IdleTimeout
+{
+public:
+    /**
+       \param ticks Number of polls without progress to give up after
+       \param tick_us Sleep time per poll without progress, 0 when the poll
+       itself waits
+    */
+    IdleTimeout(int ticks = 100, useconds_t tick_us = 10000) :
+        ticks(ticks), tick_us(tick_us), idle(0), last(0)
+    {}
+
+    /// Whether to keep waiting, given the \a progress made up to now
+    bool progressed(long long progress)
+    {
+        if ( progress != last ) {
+            last = progress;
+            idle = 0;
+            return true;
+        }
+        if ( tick_us )
+            usleep(tick_us);
+        return ++idle < ticks;
+    }
+
+protected:
+    int         ticks;
+    useconds_t  tick_us;
+    int         idle;
+    long long   last;
+};
+
+// namespaces
+}
+}
+}
+
+#endif
@@ -0,0 +1,454 @@
+/**
+ * Throughput and real-time jitter benchmark for OCL logging.
+ *
+ * Runs N producer threads which log to OCL::logging::Category's at a fixed
+ * rate, into one appender at a time, for every combination of appender,
+ * MaxEventsPerCycle and queue capacity given. The categories send their
+ * events through appender queues (see LoggingService's UseEventQueues),
+ * unless --use-ports is given.
+ *
+ * Usage: benchlogging [options]
+ *   --threads N          Number of producer threads (default 4)
+ *   --rate HZ            Events per second of each producer (default 10000)
+ *   --period S           Period of the producers, which log the events due
+ *                        each period as a burst (default 0.001)
+ *   --size BYTES         Message size (default 64)
+ *   --api NAME           How producers log: string (rt_string), binary
+ *                        (BinaryFormat) or stream (getRTStream) (default string)
+ *   --duration S         Time the producers run, per benchmark (default 1)
+ *   --appender NAME      Appender to benchmark: ostream (to /dev/null), file,
+ *                        rolling or buffered, may be repeated (default all)
+ *   --max-events N       MaxEventsPerCycle of the appender, may be repeated
+ *                        (default 1 and 0)
+ *   --queue N            QueueCapacity of the appender, may be repeated
+ *                        (default 1000)
+ *   --pool N             EventPoolSize of the logging service (default 10000)
+ *   --buffer BYTES       BufferSize of the buffered appender (default 65536)
+ *   --roll-size BYTES    MaxFileSize of the rolling appender (default 1048576)
+ *   --appender-period S  Period of the appender, 0 for triggered by every
+ *                        event (default 0.01)
+ *   --use-ports          Connect the appender through its LogPort instead
+ *   --priority P         Real-time priority of the producers, 0 for
+ *                        ORO_SCHED_OTHER (default 0)
+ *   --rtalloc BYTES      Size of the TLSF real-time memory pool, if RTT uses
+ *                        one (default 20971520)
+ *   --dir DIR            Directory of the log files (default .)
+ *
+ * Per benchmark is reported:
+ *   - events/s: events processed by the appender, per second from the start
+ *     of the producers until the appender drained its queue
+ *   - the percentiles of the time a producer spends in one log call
+ *   - the worst lateness of a producer cycle with respect to its period
+ *   - the worst end-to-end latency (the appender's WorstLatency)
+ *   - the events dropped as the appender queue or the event pool was full
+ *     (the appender's DroppedEvents, not known when using ports)
+ *   - the current and maximum usage of the TLSF pool
+ */
+#include <rtt/rtt-config.h>
+#ifdef OS_RT_MALLOC
+// need access to all TLSF functions embedded in RTT
+#define ORO_MEMORY_POOL
+#include <rtt/os/tlsf/tlsf.h>
+#endif
+#include "logging/tests/TestHelpers.hpp"
+#include <rtt/Activity.hpp>
+#include <rtt/base/RunnableInterface.hpp>
+
+#include "logging/EventClock.hpp"
+#include "logging/LoggingService.hpp"
+#include "logging/OstreamAppender.hpp"
+#include "logging/FileAppender.hpp"
+#include "logging/RollingFileAppender.hpp"
+#include "logging/BufferedFileAppender.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+using namespace OCL::logging::test;
+using OCL::logging::EventClock;
+
+namespace
+{
+    struct BenchConfig
+    {
+        int threads;
+        double rate;
+        double period;
+        int size;
+        string api;
+        double duration;
+        vector<string> appenders;
+        vector<int> max_events;
+        vector<int> queues;
+        int pool;
+        int buffer;
+        int roll_size;
+        double appender_period;
+        bool use_ports;
+        int priority;
+        size_t rtalloc;
+        string dir;
+    };
+
+#ifdef OS_RT_MALLOC
+    void* rtMem = 0;
+#endif
+
+    double now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    /**
+     * Logs the events due each period, and records the time of each call
+     * and the lateness of each cycle. All memory is allocated up front.
+     */
+    class Producer
+        : public base::RunnableInterface
+    {
+        const BenchConfig& cfg;
+        OCL::logging::Category* category;
+        RTT::rt_string message;
+        string padding;
+        EventClock::Nanoseconds start;
+        long long produced;
+        long long cycles;
+    public:
+        vector<EventClock::Nanoseconds> calls;
+        size_t ncalls;
+        EventClock::Nanoseconds worst_wakeup;
+
+        Producer(const BenchConfig& cfg, OCL::logging::Category* category)
+            : cfg(cfg), category(category), start(0), produced(0), cycles(0),
+              ncalls(0), worst_wakeup(0)
+        {
+            padding.assign(cfg.size, 'x');
+            message = padding.c_str();
+            calls.resize( (size_t)(cfg.rate * (cfg.duration + 1.0)) + 1 );
+        }
+
+        long long count() const { return produced; }
+
+        bool initialize()
+        {
+            start = EventClock::now();
+            produced = cycles = 0;
+            ncalls = 0;
+            worst_wakeup = 0;
+            return true;
+        }
+
+        void step()
+        {
+            EventClock::Nanoseconds t = EventClock::now();
+            EventClock::Nanoseconds late = t - start - (EventClock::Nanoseconds)(cycles * cfg.period * 1e9);
+            if ( cycles > 0 && late > worst_wakeup )
+                worst_wakeup = late;
+            ++cycles;
+
+            long long due = (long long)( (t - start) * 1e-9 * cfg.rate );
+            while ( produced < due ) {
+                EventClock::Nanoseconds t0 = EventClock::now();
+                log();
+                EventClock::Nanoseconds t1 = EventClock::now();
+                if ( ncalls < calls.size() )
+                    calls[ncalls++] = t1 - t0;
+                ++produced;
+            }
+        }
+
+        void finalize() {}
+
+    private:
+        void log()
+        {
+            static const OCL::logging::BinaryFormat format("seq %lld %s");
+            if ( cfg.api == "binary" )
+                category->log(log4cpp::Priority::INFO, format, produced, padding.c_str());
+            else if ( cfg.api == "stream" )
+                category->getRTStream(log4cpp::Priority::INFO) << "seq " << produced << ' ' << padding.c_str();
+            else
+                category->info(message);
+        }
+    };
+
+    struct RunResult
+    {
+        long long produced;
+        int dropped;
+        double elapsed;
+        double worst_latency;
+        EventClock::Nanoseconds worst_wakeup;
+        vector<EventClock::Nanoseconds> calls;
+    };
+
+    double percentile(const vector<EventClock::Nanoseconds>& sorted, double p)
+    {
+        if ( sorted.empty() )
+            return 0.0;
+        size_t i = (size_t)( p / 100.0 * (sorted.size() - 1) + 0.5 );
+        return sorted[i];
+    }
+
+    OCL::logging::Appender* createAppender(const BenchConfig& cfg, const string& type, int maxEvents, int queue)
+    {
+        OCL::logging::Appender* appender = 0;
+        string filename = cfg.dir + "/benchlogging-" + type + ".log";
+        if ( type == "ostream" )
+            appender = new OCL::logging::OstreamAppender("Appender");
+        else if ( type == "file" )
+            appender = new OCL::logging::FileAppender("Appender");
+        else if ( type == "rolling" ) {
+            appender = new OCL::logging::RollingFileAppender("Appender");
+            appender->properties()->getPropertyType<int>("MaxFileSize")->set( cfg.roll_size );
+        }
+        else if ( type == "buffered" ) {
+            appender = new OCL::logging::BufferedFileAppender("Appender");
+            appender->properties()->getPropertyType<int>("BufferSize")->set( cfg.buffer );
+        }
+        else
+            return 0;
+        if ( type != "ostream" ) {
+            unlink( filename.c_str() );
+            appender->properties()->getPropertyType<string>("Filename")->set( filename );
+        }
+        appender->properties()->getPropertyType<int>("MaxEventsPerCycle")->set( maxEvents );
+        appender->properties()->getPropertyType<int>("QueueCapacity")->set( queue );
+        appender->setActivity( new Activity(ORO_SCHED_OTHER, 0, cfg.appender_period) );
+        return appender;
+    }
+
+    bool run(const BenchConfig& cfg, const string& type, int maxEvents, int queue,
+             vector<OCL::logging::Category*>& categories, RunResult& result)
+    {
+        OCL::logging::Appender* appender = createAppender(cfg, type, maxEvents, queue);
+        if ( !appender ) {
+            cerr << "Unknown appender " << type << ". See the top of benchlogging.cpp for usage." << endl;
+            return false;
+        }
+
+        // the producers log to "Bench.pN", which are additive to "Bench"
+        OCL::logging::LoggingService service("LoggingService");
+        service.addPeer( appender );
+        PropertyBag appenders;
+        appenders.ownProperty( new Property<string>("Bench", "", "Appender") );
+        service.properties()->getPropertyType<PropertyBag>("Appenders")->set( appenders );
+        service.properties()->getPropertyType<bool>("UseEventQueues")->set( !cfg.use_ports );
+        service.properties()->getPropertyType<int>("EventPoolSize")->set( cfg.pool );
+
+        if ( !appender->configure() || !service.configure() || !appender->start() ) {
+            cerr << "Could not start the " << type << " appender." << endl;
+            delete appender;
+            return false;
+        }
+
+        vector<Producer*> producers;
+        vector<Activity*> activities;
+        for (int i = 0; i != cfg.threads; ++i) {
+            producers.push_back( new Producer(cfg, categories[i]) );
+            activities.push_back( new Activity(cfg.priority ? ORO_SCHED_RT : ORO_SCHED_OTHER,
+                                               cfg.priority, cfg.period, producers.back(), "Producer") );
+        }
+
+        double t0 = now();
+        for (size_t i = 0; i != activities.size(); ++i)
+            activities[i]->start();
+        usleep( (useconds_t)(cfg.duration * 1e6) );
+        for (size_t i = 0; i != activities.size(); ++i)
+            activities[i]->stop();
+        // stopping the appender drains its queue
+        appender->stop();
+        result.elapsed = now() - t0;
+
+        result.produced = 0;
+        result.worst_wakeup = 0;
+        result.calls.clear();
+        for (size_t i = 0; i != producers.size(); ++i) {
+            result.produced += producers[i]->count();
+            result.worst_wakeup = max( result.worst_wakeup, producers[i]->worst_wakeup );
+            result.calls.insert( result.calls.end(), producers[i]->calls.begin(),
+                                 producers[i]->calls.begin() + producers[i]->ncalls );
+            delete activities[i];
+            delete producers[i];
+        }
+        sort( result.calls.begin(), result.calls.end() );
+        result.dropped = cfg.use_ports ? -1 : getProperty<int>(*appender, "DroppedEvents");
+        result.worst_latency = getProperty<double>(*appender, "WorstLatency");
+
+        appender->cleanup();
+        service.removePeer( "Appender" );
+        delete appender;
+        return true;
+    }
+
+    void printHeader()
+    {
+        printf("%-9s %6s %6s %11s %9s %9s %9s %9s %10s %10s %9s %s\n",
+               "appender", "maxev", "queue", "events/s", "call p50", "call p99", "p99.9", "call max",
+               "wakeup max", "e2e worst", "dropped", "tlsf used/max");
+        printf("%-9s %6s %6s %11s %9s %9s %9s %9s %10s %10s %9s %s\n",
+               "", "", "", "", "us", "us", "us", "us", "us", "ms", "", "bytes");
+    }
+
+    void printResult(const string& type, int maxEvents, int queue, const RunResult& r)
+    {
+        long long processed = r.produced - (r.dropped > 0 ? r.dropped : 0);
+        char dropped[32];
+        if ( r.dropped < 0 )
+            snprintf(dropped, sizeof(dropped), "-");
+        else
+            snprintf(dropped, sizeof(dropped), "%d", r.dropped);
+        char tlsf[64] = "-";
+#ifdef OS_RT_MALLOC
+        if ( rtMem )
+            snprintf(tlsf, sizeof(tlsf), "%lu/%lu",
+                     (unsigned long)get_used_size(rtMem), (unsigned long)get_max_size(rtMem));
+#endif
+        printf("%-9s %6d %6d %11.0f %9.2f %9.2f %9.2f %9.2f %10.1f %10.3f %9s %s\n",
+               type.c_str(), maxEvents, queue, processed / r.elapsed,
+               percentile(r.calls, 50) * 1e-3, percentile(r.calls, 99) * 1e-3,
+               percentile(r.calls, 99.9) * 1e-3, percentile(r.calls, 100) * 1e-3,
+               r.worst_wakeup * 1e-3, r.worst_latency * 1e3, dropped, tlsf);
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig cfg;
+    cfg.threads = 4;
+    cfg.rate = 10000.0;
+    cfg.period = 0.001;
+    cfg.size = 64;
+    cfg.api = "string";
+    cfg.duration = 1.0;
+    cfg.pool = 10000;
+    cfg.buffer = 65536;
+    cfg.roll_size = 1024 * 1024;
+    cfg.appender_period = 0.01;
+    cfg.use_ports = false;
+    cfg.priority = 0;
+    cfg.rtalloc = 20 * 1024 * 1024;
+    cfg.dir = ".";
+
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i+1] : 0;
+        if ( a == "--use-ports" ) { cfg.use_ports = true; continue; }
+        if ( !v ) {
+            cerr << "Missing value for option " << a << endl;
+            return 1;
+        }
+        ++i;
+        if ( a == "--threads" ) cfg.threads = atoi(v);
+        else if ( a == "--rate" ) cfg.rate = atof(v);
+        else if ( a == "--period" ) cfg.period = atof(v);
+        else if ( a == "--size" ) cfg.size = atoi(v);
+        else if ( a == "--api" ) cfg.api = v;
+        else if ( a == "--duration" ) cfg.duration = atof(v);
+        else if ( a == "--appender" ) cfg.appenders.push_back(v);
+        else if ( a == "--max-events" ) cfg.max_events.push_back(atoi(v));
+        else if ( a == "--queue" ) cfg.queues.push_back(atoi(v));
+        else if ( a == "--pool" ) cfg.pool = atoi(v);
+        else if ( a == "--buffer" ) cfg.buffer = atoi(v);
+        else if ( a == "--roll-size" ) cfg.roll_size = atoi(v);
+        else if ( a == "--appender-period" ) cfg.appender_period = atof(v);
+        else if ( a == "--priority" ) cfg.priority = atoi(v);
+        else if ( a == "--rtalloc" ) cfg.rtalloc = strtoul(v, 0, 10);
+        else if ( a == "--dir" ) cfg.dir = v;
+        else {
+            cerr << "Unknown option " << a << ". See the top of benchlogging.cpp for usage." << endl;
+            return 1;
+        }
+    }
+    if ( cfg.appenders.empty() ) {
+        cfg.appenders.push_back("ostream");
+        cfg.appenders.push_back("file");
+        cfg.appenders.push_back("rolling");
+        cfg.appenders.push_back("buffered");
+    }
+    if ( cfg.max_events.empty() ) {
+        cfg.max_events.push_back(1);
+        cfg.max_events.push_back(0);
+    }
+    if ( cfg.queues.empty() )
+        cfg.queues.push_back(1000);
+    if ( cfg.rate <= 0 || cfg.period <= 0 || cfg.threads <= 0 || cfg.duration <= 0 || cfg.size < 0 ) {
+        cerr << "Rate, period, threads and duration must be positive." << endl;
+        return 1;
+    }
+    if ( cfg.api != "string" && cfg.api != "binary" && cfg.api != "stream" ) {
+        cerr << "Unknown api " << cfg.api << ", expected string, binary or stream." << endl;
+        return 1;
+    }
+
+#ifdef OS_RT_MALLOC
+    // rt_string's and the logging service need the real-time memory pool
+    rtMem = malloc(cfg.rtalloc);
+    if ( !rtMem || (size_t)-1 == init_memory_pool(cfg.rtalloc, rtMem) ) {
+        cerr << "Invalid memory pool size of " << cfg.rtalloc << " bytes." << endl;
+        return 1;
+    }
+#endif
+
+    if ( !startOrocos(argc, argv) )
+        return 1;
+
+    vector<OCL::logging::Category*> categories;
+    for (int i = 0; i != cfg.threads; ++i) {
+        ostringstream name;
+        name << "Bench.p" << i;
+        categories.push_back( dynamic_cast<OCL::logging::Category*>(
+            &log4cpp::Category::getInstance(name.str())) );
+        categories.back()->setPriority(log4cpp::Priority::INFO);
+    }
+
+    printf("benchlogging: %d threads at %.0f Hz, period %.3f ms, %d byte %s messages, %.1f s, %s\n\n",
+           cfg.threads, cfg.rate, cfg.period * 1e3, cfg.size, cfg.api.c_str(), cfg.duration,
+           cfg.use_ports ? "ports" : "event queues");
+    printHeader();
+
+    // the ostream appender writes to std::cout, the report goes to stdout
+    ofstream devnull("/dev/null");
+    int rc = 0;
+    for (size_t a = 0; a != cfg.appenders.size(); ++a) {
+        for (size_t m = 0; m != cfg.max_events.size(); ++m) {
+            for (size_t q = 0; q != cfg.queues.size(); ++q) {
+                streambuf* out = cout.rdbuf();
+                if ( cfg.appenders[a] == "ostream" )
+                    cout.rdbuf( devnull.rdbuf() );
+                RunResult result;
+                bool ok = run(cfg, cfg.appenders[a], cfg.max_events[m], cfg.queues[q], categories, result);
+                cout.rdbuf( out );
+                if ( !ok ) {
+                    rc = 1;
+                    continue;
+                }
+                printResult(cfg.appenders[a], cfg.max_events[m], cfg.queues[q], result);
+            }
+        }
+    }
+
+    __os_exit();
+    log4cpp::HierarchyMaintainer::getDefaultMaintainer().shutdown();
+    log4cpp::HierarchyMaintainer::getDefaultMaintainer().deleteAllCategories();
+#ifdef OS_RT_MALLOC
+    destroy_memory_pool(rtMem);
+    free(rtMem);
+#endif
+    return rc;
+}
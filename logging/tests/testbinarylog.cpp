@@ -0,0 +1,146 @@
+/**
+ * Test of binary events, from BinaryEncoder to the formatted message.
+ *
+ * Each event is formatted twice: directly, as appenders do with
+ * LoggingEvent::formatMessage(), and after a round trip through
+ * BinaryLogEncoder and BinaryLogDecoder, as ocl-logdecode does. Both
+ * must equal the expected message, for every argument type, for "%%"
+ * and a trailing '%', and for events truncated at MessageSize.
+ *
+ * Usage: testbinarylog
+ */
+#include "logging/BinaryFormat.hpp"
+#include "logging/BinaryLog.hpp"
+#include "logging/CategoryNames.hpp"
+
+#include <climits>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace OCL::logging;
+
+namespace
+{
+    const CategoryId category = CategoryNames::intern("org.orocos.ocl.logging.tests.binarylog");
+
+    /// Format \a encoder.event both ways, and compare with \a expected
+    bool check(const BinaryEncoder& encoder, const string& expected, const char* what)
+    {
+        string direct;
+        encoder.event.formatMessage(direct);
+
+        string data;
+        BinaryLogEncoder logEncoder;
+        logEncoder.encode(encoder.event, data);
+        BinaryLogDecoder decoder;
+        DecodedEvent decoded;
+        bool isEvent = false;
+        int n = 0;
+        size_t begin = 0;
+        while ((begin < data.size()) &&
+               (0 < (n = decoder.decode(data.data() + begin, data.size() - begin, isEvent, decoded))))
+            begin += n;
+
+        bool ok = true;
+        if (direct != expected) {
+            cerr << "FAILED: " << what << ", formatted '" << direct << "'" << endl;
+            ok = false;
+        }
+        if ((begin != data.size()) || !isEvent || (decoded.message != expected)) {
+            cerr << "FAILED: " << what << ", decoded '" << decoded.message << "'" << endl;
+            ok = false;
+        }
+        return ok;
+    }
+
+    int testTypes()
+    {
+        bool ok = true;
+
+        static const BinaryFormat integers("%d %i %u %lld %llu %ld %lu %x %X %o");
+        BinaryEncoder e1(category, integers, log4cpp::Priority::INFO);
+        e1 << -5 << INT_MAX << 7u << LLONG_MIN << ULLONG_MAX << -1L << 2UL << 255 << 255u << 8;
+        char expected[256];
+        snprintf(expected, sizeof(expected), "-5 %d 7 %lld %llu -1 2 ff FF 10",
+                 INT_MAX, LLONG_MIN, ULLONG_MAX);
+        ok &= check(e1, expected, "integer arguments");
+
+        static const BinaryFormat floating("%f %.3f %e %g %d");
+        BinaryEncoder e2(category, floating, log4cpp::Priority::INFO);
+        e2 << 1.5 << 3.14159 << 1e10 << 0.25 << 2.5;
+        ok &= check(e2, "1.500000 3.142 1.000000e+10 0.25 2.5", "double arguments");
+
+        static const BinaryFormat others("%c %s %s %d %s %s %5s|%-4d|");
+        BinaryEncoder e3(category, others, log4cpp::Priority::INFO);
+        e3 << 'x' << true << false << true << "text" << string("string") << "ab" << 42;
+        ok &= check(e3, "x true false 1 text string    ab|42  |", "char, bool and string arguments");
+
+        static const BinaryFormat pointer("%p");
+        BinaryEncoder e4(category, pointer, log4cpp::Priority::INFO);
+        const void* p = &e4;
+        e4 << p;
+        snprintf(expected, sizeof(expected), "%p", p);
+        ok &= check(e4, expected, "pointer argument");
+
+        static const BinaryFormat escapes("100%% of %d%");
+        BinaryEncoder e5(category, escapes, log4cpp::Priority::INFO);
+        e5 << 3;
+        ok &= check(e5, "100% of 3%", "'%%' and a trailing '%'");
+
+        static const BinaryFormat missing("%d and %d");
+        BinaryEncoder e6(category, missing, log4cpp::Priority::INFO);
+        e6 << 1;
+        ok &= check(e6, "1 and <?>", "missing argument");
+
+        return ok ? 0 : 1;
+    }
+
+    int testTruncation()
+    {
+        bool ok = true;
+
+        // a string is cut to the room that is left in the event
+        static const BinaryFormat prefixed("%d %s");
+        BinaryEncoder e1(category, prefixed, log4cpp::Priority::INFO);
+        e1 << 1 << string(2 * LoggingEvent::MessageSize, 'a');
+        ok &= (LoggingEvent::MessageTruncated & e1.event.truncated) &&
+            (LoggingEvent::MessageSize > (int)e1.event.messageLength);
+        // type and value of the int, type and length of the string, '\0'
+        const size_t room = LoggingEvent::MessageSize - (1 + sizeof(int)) - (1 + sizeof(unsigned short)) - 1;
+        ok &= check(e1, "1 " + string(room, 'a') + "...", "truncated string");
+
+        // arguments which do not fit are dropped, after the last one which did
+        static const BinaryFormat many("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d "
+                                       "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d "
+                                       "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d");
+        BinaryEncoder e2(category, many, log4cpp::Priority::INFO);
+        string expected;
+        const int fit = (LoggingEvent::MessageSize - 1) / (1 + sizeof(long long));
+        for (int i = 0; i != 48; ++i) {
+            e2 << (long long)i;
+            if (i < fit) {
+                char number[16];
+                snprintf(number, sizeof(number), "%d ", i);
+                expected += number;
+            }
+        }
+        ok &= (LoggingEvent::MessageTruncated & e2.event.truncated) && (fit < 48);
+        expected += "...";
+        ok &= check(e2, expected, "dropped arguments");
+
+        if (!ok)
+            cerr << "FAILED: truncation" << endl;
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int rc = 0;
+    rc |= testTypes();
+    rc |= testTruncation();
+    cout << (rc ? "testbinarylog FAILED" : "testbinarylog passed") << endl;
+    return rc;
+}
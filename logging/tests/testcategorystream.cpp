@@ -0,0 +1,156 @@
+/**
+ * Test of the messages formatted by a CategoryStream.
+ *
+ * Messages are streamed into an OCL category whose events are read from
+ * its log port. Built-in types must be formatted as by an std::ostream,
+ * manipulators must apply, messages longer than MessageSize must be
+ * truncated, and nothing may be formatted for a disabled priority.
+ *
+ * Usage: testcategorystream
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include <rtt/InputPort.hpp>
+
+#include <climits>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace RTT;
+using namespace OCL::logging;
+using namespace OCL::logging::test;
+
+namespace
+{
+    /// Counts how often it is formatted
+    struct Counted
+    {
+        static int formatted;
+    };
+    int Counted::formatted = 0;
+
+    ostream& operator<<(ostream& os, const Counted&)
+    {
+        ++Counted::formatted;
+        return os << "counted";
+    }
+
+    InputPort<LoggingEvent> port("LogPort");
+
+    /// Compare the message of the next event on \a port with \a expected
+    bool check(const string& expected, bool truncated, const char* what)
+    {
+        LoggingEvent event;
+        if (NewData != port.read(event)) {
+            cerr << "FAILED: " << what << ", no event" << endl;
+            return false;
+        }
+        const string message(event.message, event.messageLength);
+        if ((message != expected) ||
+            (truncated != (0 != (event.truncated & LoggingEvent::MessageTruncated)))) {
+            cerr << "FAILED: " << what << ", message '" << message << "'" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    int testFormat(Category* category)
+    {
+        bool ok = true;
+
+        category->getRTStream(log4cpp::Priority::INFO)
+            << "text " << string("string") << ' ' << true << ' ' << (signed char)'c'
+            << ' ' << -42 << ' ' << 7u << ' ' << LLONG_MIN << ' ' << ULLONG_MAX
+            << ' ' << 1.5 << ' ' << 1e-10 << ' ' << 0.1f << ' ' << Counted();
+        ostringstream os;
+        os << "text string 1 c -42 7 " << LLONG_MIN << ' ' << ULLONG_MAX
+           << " 1.5 1e-10 " << 0.1f << " counted";
+        ok &= check(os.str(), false, "built-in types");
+
+        category->getRTStream(log4cpp::Priority::INFO)
+            << hex << 255 << ' ' << showbase << 16 << noshowbase << dec << ' ' << 10
+            << '|' << setw(4) << 3 << '|' << left << setw(4) << "ab" << '|'
+            << fixed << setprecision(2) << 3.14159 << ' ' << boolalpha << false;
+        ok &= check("ff 0x10 10|   3|ab  |3.14 false", false, "manipulators");
+
+        // the format of a copy is the one of the original
+        CategoryStream stream = category->getRTStream(log4cpp::Priority::INFO);
+        stream << hex;
+        CategoryStream copy(stream);
+        copy << 255 << eol;
+        ok &= check("ff", false, "copied format");
+        stream << 17 << eol;
+        ok &= check("11", false, "format kept after a flush");
+
+        return ok ? 0 : 1;
+    }
+
+    int testTruncation(Category* category)
+    {
+        bool ok = true;
+
+        // the '\0' of the event takes one character
+        const string line(100, 'x');
+        CategoryStream stream = category->getRTStream(log4cpp::Priority::INFO);
+        for (int i = 0; i < LoggingEvent::MessageSize; i += line.size())
+            stream << line;
+        stream << eol;
+        ok &= check(string(LoggingEvent::MessageSize - 1, 'x'), true, "truncated string");
+
+        // also when formatted by the std::ostream, which recovers afterwards
+        for (int i = 0; i < LoggingEvent::MessageSize; ++i)
+            stream << setw(2) << i % 10;
+        stream << eol;
+        LoggingEvent event;
+        ok &= (NewData == port.read(event)) &&
+            (LoggingEvent::MessageSize - 1 == (int)event.messageLength) &&
+            (event.truncated & LoggingEvent::MessageTruncated);
+        stream << setw(3) << 5 << eol;
+        ok &= check("  5", false, "formatting after a truncation");
+
+        if (!ok)
+            cerr << "FAILED: truncation" << endl;
+        return ok ? 0 : 1;
+    }
+
+    int testDisabled(Category* category)
+    {
+        Counted::formatted = 0;
+        category->getRTStream(log4cpp::Priority::DEBUG)
+            << "text " << 42 << hex << 255 << setw(8) << Counted();
+        LoggingEvent event;
+        const bool ok = (0 == Counted::formatted) && (NewData != port.read(event));
+        if (!ok)
+            cerr << "FAILED: a disabled priority formatted or logged a message" << endl;
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( !startOrocos(argc, argv) )
+        return 1;
+
+    Category* category = dynamic_cast<Category*>(
+        &log4cpp::Category::getInstance("org.orocos.ocl.logging.tests.categorystream"));
+    category->setPriority(log4cpp::Priority::INFO);
+    ConnPolicy cp = ConnPolicy::buffer(10, ConnPolicy::LOCK_FREE, false, false);
+    int rc = 0;
+    if ( !category->connectToLogPort(port, cp) ) {
+        cerr << "testcategorystream: could not connect to the category." << endl;
+        rc = 1;
+    }
+    else {
+        rc |= testFormat(category);
+        rc |= testTruncation(category);
+        rc |= testDisabled(category);
+        port.disconnect();
+    }
+    cout << (rc ? "testcategorystream FAILED" : "testcategorystream passed") << endl;
+
+    __os_exit();
+    return rc;
+}
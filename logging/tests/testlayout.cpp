@@ -0,0 +1,100 @@
+/**
+ * Test of the native layouts against the log4cpp layouts they mirror.
+ *
+ * Events of every priority, with and without an NDC, are formatted with
+ * the native simple, basic and pattern layouts, and with the log4cpp
+ * layout of the same name after converting the event with toLog4cpp().
+ * Both must give the same text.
+ *
+ * Usage: testlayout
+ */
+#include "logging/Layout.hpp"
+#include "logging/CategoryNames.hpp"
+#include <log4cpp/BasicLayout.hh>
+#include <log4cpp/PatternLayout.hh>
+#include <log4cpp/SimpleLayout.hh>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace OCL::logging;
+
+namespace
+{
+    const log4cpp::Priority::Value priorities[] = {
+        log4cpp::Priority::FATAL, log4cpp::Priority::ALERT, log4cpp::Priority::CRIT,
+        log4cpp::Priority::ERROR, log4cpp::Priority::WARN, log4cpp::Priority::NOTICE,
+        log4cpp::Priority::INFO, log4cpp::Priority::DEBUG };
+
+    const char* patterns[] = {
+        "%m%n",
+        "%p %c: %m%n",
+        "[%-8p] %c{2} %x - %m%n",
+        "%d{%Y-%m-%d %H:%M:%S,%l} [%t] %5.3p %c{1}: %m%n",
+        "%d %R %% %m%n",
+        "%d{ABSOLUTE} %.4c %10x|%-10m|%n" };
+
+    /// Events of each priority, with and without an NDC
+    vector<LoggingEvent> events()
+    {
+        const CategoryId category = CategoryNames::intern("org.orocos.ocl.logging.tests.layout");
+        vector<LoggingEvent> v;
+        for (size_t i = 0; i != sizeof(priorities) / sizeof(priorities[0]); ++i) {
+            const char* message = "a message";
+            LoggingEvent event(category, message, strlen(message), priorities[i]);
+            v.push_back(event);
+            event.setNdc("context");
+            v.push_back(event);
+        }
+        return v;
+    }
+
+    /// Compare \a native with \a original for all \a events
+    bool compare(Layout& native, log4cpp::Layout& original,
+                 const vector<LoggingEvent>& events, const string& what)
+    {
+        for (size_t i = 0; i != events.size(); ++i) {
+            string formatted;
+            native.format(events[i], formatted);
+            const string expected = original.format(events[i].toLog4cpp());
+            if (formatted != expected) {
+                cerr << "FAILED: " << what << " layout, formatted '" << formatted
+                     << "' instead of '" << expected << "'" << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const vector<LoggingEvent> v = events();
+    bool ok = true;
+
+    SimpleLayout simple;
+    log4cpp::SimpleLayout log4cppSimple;
+    ok &= compare(simple, log4cppSimple, v, "simple");
+
+    BasicLayout basic;
+    log4cpp::BasicLayout log4cppBasic;
+    ok &= compare(basic, log4cppBasic, v, "basic");
+
+    for (size_t i = 0; i != sizeof(patterns) / sizeof(patterns[0]); ++i) {
+        PatternLayout pattern;
+        log4cpp::PatternLayout log4cppPattern;
+        log4cppPattern.setConversionPattern(patterns[i]);
+        if (!pattern.setConversionPattern(patterns[i])) {
+            cerr << "FAILED: invalid pattern " << patterns[i] << endl;
+            ok = false;
+            continue;
+        }
+        ok &= compare(pattern, log4cppPattern, v, string("pattern '") + patterns[i] + "'");
+    }
+
+    cout << (ok ? "testlayout passed" : "testlayout FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/**
+ * Test of the Log4cxxAppender against a loopback server.
+ *
+ * A server thread accepts the connection of the appender on 127.0.0.1 and
+ * reads what it sends, optionally slowly to simulate a slow Chainsaw.
+ * Events are logged to an OCL category connected to the appender, which
+ * must account for each of them as sent or dropped.
+ *
+ * Usage: testlog4cxx
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include <rtt/Activity.hpp>
+#include "logging/Log4cxxAppender.hpp"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace RTT;
+using namespace OCL::logging::test;
+
+namespace
+{
+    /// Number of events logged per run
+    const int               events          = 10000;
+    /// Port of the server
+    const unsigned short    port            = 4561;
+    /// Sleep time of the slow server per read
+    const int               slow_delay_ms   = 5;
+
+    struct Server
+    {
+        unsigned short port;
+        int delay_ms;
+        int listener;
+        unsigned long long bytes;
+        bool serialized;
+    };
+
+    /** Listen on the loopback interface, before the appender connects. */
+    bool listenOn(Server& server)
+    {
+        server.listener = ::socket(PF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(server.listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(server.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if ( ::bind(server.listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+             ::listen(server.listener, 1) != 0 ) {
+            perror("testlog4cxx: listen");
+            ::close(server.listener);
+            return false;
+        }
+        return true;
+    }
+
+    /** Read until the appender disconnects. */
+    void* serverMain(void* arg)
+    {
+        Server* server = static_cast<Server*>(arg);
+        server->bytes = 0;
+        server->serialized = false;
+        int fd = ::accept(server->listener, 0, 0);
+        ::close(server->listener);
+        if ( fd < 0 )
+            return 0;
+        char buf[4096];
+        ssize_t r;
+        while ( (r = ::recv(fd, buf, sizeof(buf), 0)) > 0 ) {
+            // a Java object stream starts with 0xACED
+            if ( server->bytes == 0 && r >= 2 )
+                server->serialized = (unsigned char)buf[0] == 0xAC && (unsigned char)buf[1] == 0xED;
+            server->bytes += r;
+            if ( server->delay_ms )
+                usleep( server->delay_ms * 1000 );
+        }
+        ::close(fd);
+        return 0;
+    }
+
+    /** Log the events through the appender to a server reading with \a delay_ms.
+        \param lossless Whether no event may be dropped
+        \return 0 if all events are accounted for */
+    int run(const char* title, int delay_ms, int capacity, const char* policy, bool lossless)
+    {
+        Server server;
+        server.port = port;
+        server.delay_ms = delay_ms;
+        if ( !listenOn(server) )
+            return 1;
+        pthread_t thread;
+        pthread_create(&thread, 0, &serverMain, &server);
+
+        OCL::logging::Log4cxxAppender appender("Log4cxx");
+        appender.properties()->getPropertyType<std::string>("Hostname")->set( "127.0.0.1" );
+        appender.properties()->getPropertyType<int>("Port")->set( port );
+        appender.properties()->getPropertyType<int>("QueueCapacity")->set( capacity );
+        appender.properties()->getPropertyType<std::string>("OverflowPolicy")->set( policy );
+        appender.setActivity( new Activity(ORO_SCHED_OTHER, 0, 0.01) );
+
+        OCL::logging::Category* category =
+            connectCategory("org.orocos.ocl.logging.tests.log4cxx", appender, events);
+        if ( !category || !appender.configure() || !appender.start() ) {
+            cerr << "testlog4cxx: could not start the appender." << endl;
+            ::shutdown(server.listener, SHUT_RDWR);
+            pthread_join(thread, 0);
+            return 1;
+        }
+
+        static const OCL::logging::BinaryFormat format("Event %d of %d");
+        for (int i = 0; i != events; ++i)
+            category->log(log4cpp::Priority::INFO, format, i, events);
+
+        // wait until the appender took all events from its port, or it
+        // made no progress for a second
+        IdleTimeout timeout;
+        int taken;
+        while ( ((taken = getProperty<int>(appender, "EventsSent") +
+                  getProperty<int>(appender, "DroppedEvents") +
+                  getProperty<int>(appender, "QueueDepth")) < events) &&
+                timeout.progressed(taken) )
+        {}
+        appender.stop();
+        int sent = getProperty<int>(appender, "EventsSent");
+        int dropped = getProperty<int>(appender, "DroppedEvents");
+        double latency = getProperty<double>(appender, "WorstSendLatency");
+        appender.cleanup();
+        appender.ports()->getPort("LogPort")->disconnect();
+        pthread_join(thread, 0);
+
+        printf("%s: %d sent, %d dropped, worst latency %.3f ms, server received %llu bytes\n",
+               title, sent, dropped, latency * 1e3, server.bytes);
+        if ( sent + dropped != events ) {
+            printf("%s: FAILED, %d events are missing\n", title, events - sent - dropped);
+            return 1;
+        }
+        if ( lossless && 0 != dropped ) {
+            printf("%s: FAILED, no events should be dropped\n", title);
+            return 1;
+        }
+        if ( 0 < sent && !server.serialized ) {
+            printf("%s: FAILED, the server did not receive a Java object stream\n", title);
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( !startOrocos(argc, argv) )
+        return 1;
+
+    int rc = 0;
+    // a queue for all events, nothing may be dropped
+    rc |= run("fast server", 0, events, "drop-newest", true);
+    // a small queue and a slow server, events are dropped but never lost
+    rc |= run("slow server, drop-newest", slow_delay_ms, 100, "drop-newest", false);
+    rc |= run("slow server, drop-oldest", slow_delay_ms, 100, "drop-oldest", false);
+
+    __os_exit();
+    return rc;
+}
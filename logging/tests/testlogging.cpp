@@ -3,9 +3,20 @@
 #include <iostream>
 #include <log4cpp/HierarchyMaintainer.hh>
 #include "logging/Category.hpp"
+#include "logging/CategoryHandle.hpp"
+#include "logging/LogMacros.hpp"
 
 using namespace RTT;
 
+static int evaluated = 0;
+
+// a message which counts how often it is built
+static RTT::rt_string message(const char* text)
+{
+    ++evaluated;
+    return RTT::rt_string(text);
+}
+
 int main(int argc, char** argv)
 {
     // use only OCL::logging Category's
@@ -69,6 +80,32 @@ int main(int argc, char** argv)
     {
         std::cout << "Unable cast" << std::endl;
     }
-    
-    return 0;
+
+    // a handle follows priority changes of the category and its parents
+    std::cout << "\nThrough a handle ...\n";
+    OCL::logging::CategoryHandle handle(name);
+    if (!handle.isValid() || (handle.get() != category))
+    {
+        std::cout << "Unable to resolve handle" << std::endl;
+        return 1;
+    }
+    log4cpp::Category::getInstance("org.test").setPriority(log4cpp::Priority::ERROR);
+    bool ok = !handle.isPriorityEnabled(log4cpp::Priority::INFO) &&
+        handle.isPriorityEnabled(log4cpp::Priority::ERROR);
+    handle->setPriority(log4cpp::Priority::DEBUG);
+    ok = ok && handle.isPriorityEnabled(log4cpp::Priority::INFO);
+    std::cout << "handle priorities " << (ok ? "follow" : "do NOT follow")
+              << " the category" << std::endl;
+
+    // the macros do not build messages of disabled priorities
+    handle->setPriority(log4cpp::Priority::WARN);
+    OCL_LOG_DEBUG(handle, message("debug"));
+    OCL_LOG(handle, log4cpp::Priority::INFO, message("info"));
+    OCL_LOG_STREAM(handle, log4cpp::Priority::INFO) << message("stream").c_str();
+    OCL_LOG_ERROR(handle, message("error"));
+    OCL_LOG(category, log4cpp::Priority::WARN, message("warn"));
+    std::cout << "macros built " << evaluated << " of 2 enabled messages" << std::endl;
+    ok = ok && (2 == evaluated);
+
+    return ok ? 0 : 1;
 }
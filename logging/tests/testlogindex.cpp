@@ -0,0 +1,189 @@
+/**
+ * Test of the LogIndex sidecar index.
+ *
+ * A text log in the basic layout and a binary log are indexed in small
+ * blocks. Queries must find exactly the blocks holding matching events,
+ * an index updated after appending must equal one built from scratch, and
+ * the index of a renamed, rolled over, file must be rebuilt.
+ *
+ * Usage: testlogindex
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include "logging/LogIndex.hpp"
+#include "logging/BinaryLog.hpp"
+#include "logging/CategoryNames.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace OCL::logging;
+using namespace OCL::logging::test;
+
+namespace
+{
+    const long start = 1700000000;
+    const char* categories[] = { "org.test.a", "org.test.a.b", "org.test.c" };
+
+    /// Append events \a first up to \a last to the text log \a path. Event
+    /// i has category i%3, is at start + i/10, and only event 500 is an ERROR.
+    void writeText(const char* path, int first, int last)
+    {
+        FILE* file = fopen(path, "a");
+        for (int i = first; i != last; ++i) {
+            fprintf(file, "%ld %s %s : event %d\n", start + i / 10,
+                    (500 == i) ? "ERROR" : "INFO", categories[i % 3], i);
+            if (0 == i % 100)
+                fprintf(file, "  second line of event %d\n", i);
+        }
+        fclose(file);
+    }
+
+    /// Number of blocks which \a index finds for \a query
+    size_t count(const LogIndex& index, const LogIndex::Query& query)
+    {
+        vector<size_t> found;
+        index.find(query, found);
+        return found.size();
+    }
+
+    bool sameBlocks(const LogIndex& a, const LogIndex& b)
+    {
+        if (a.getBlocks().size() != b.getBlocks().size())
+            return false;
+        for (size_t i = 0; i != a.getBlocks().size(); ++i) {
+            const LogIndex::Block& x = a.getBlocks()[i];
+            const LogIndex::Block& y = b.getBlocks()[i];
+            if ((x.offset != y.offset) || (x.size != y.size) || (x.events != y.events) ||
+                (x.first != y.first) || (x.last != y.last) || (x.priorities != y.priorities))
+                return false;
+        }
+        return true;
+    }
+
+    int testText()
+    {
+        const char* path = "testlogindex.log";
+        remove(path);
+        remove(LogIndex::indexPath(path).c_str());
+        writeText(path, 0, 1000);
+
+        bool ok = true;
+        LogIndex index;
+        ok &= check(index.update(path, 4096) && index.save(), "indexing the text log");
+        ok &= check(LogIndex::TextFile == index.getFormat(), "text format detected");
+        ok &= check(5 < index.getBlocks().size(), "text log split in blocks");
+        ok &= check(3 == index.getCategories().size(), "all categories indexed");
+
+        LogIndex::Query query;
+        ok &= check(index.getBlocks().size() == count(index, query), "empty query matches all");
+        query.priority = log4cpp::Priority::ERROR;
+        ok &= check(1 == count(index, query), "one block with an ERROR");
+        query = LogIndex::Query();
+        query.from  = start + 99;
+        query.to    = start + 99;
+        ok &= check(1 == count(index, query), "one block in the last second");
+        query.to    = start - 1;
+        query.from  = 0;
+        ok &= check(0 == count(index, query), "no block before the first event");
+
+        // "org.test.a" includes "org.test.a.b", but not "org.test.ab"
+        query = LogIndex::Query();
+        query.categories.push_back("org.test.a");
+        ok &= check(query.matchesCategory("org.test.a.b") &&
+                    !query.matchesCategory("org.test.ab"), "category descendants match");
+
+        // only what was appended is indexed, with the same result
+        writeText(path, 1000, 1500);
+        LogIndex updated;
+        ok &= check(updated.update(path, 4096) && updated.isModified(), "updating the text log");
+        ok &= check(updated.getIndexedSize() > index.getIndexedSize(), "appended events indexed");
+        remove(LogIndex::indexPath(path).c_str());
+        LogIndex rebuilt;
+        ok &= check(rebuilt.update(path, 4096), "rebuilding the text log index");
+        ok &= check(sameBlocks(updated, rebuilt), "updated index equals rebuilt index");
+        updated.save();
+
+        // another file in its place, as after a rollover
+        remove(path);
+        writeText(path, 2000, 2100);
+        LogIndex rolled;
+        ok &= check(rolled.update(path, 4096), "indexing the rolled over file");
+        ok &= check(!rolled.getBlocks().empty() &&
+                    (start + 200 == rolled.getBlocks().front().first), "stale index rebuilt");
+
+        remove(path);
+        remove(LogIndex::indexPath(path).c_str());
+        return ok ? 0 : 1;
+    }
+
+    int testBinary()
+    {
+        const char* path = "testlogindex.bin";
+        remove(path);
+        remove(LogIndex::indexPath(path).c_str());
+
+        BinaryLog::FileHeader header;
+        BinaryLog::initHeader(header);
+        string data(reinterpret_cast<const char*>(&header), sizeof(header));
+        BinaryLogEncoder encoder;
+        for (int i = 0; i != 1000; ++i) {
+            const char* message = "binary event";
+            LoggingEvent event(CategoryNames::intern(categories[(i < 900) ? 0 : 2]),
+                               message, 12, (999 == i) ? log4cpp::Priority::WARN : log4cpp::Priority::DEBUG);
+            encoder.encode(event, data);
+        }
+        // an incomplete last record is not indexed
+        data.append("E", 1);
+        FILE* file = fopen(path, "wb");
+        fwrite(data.data(), 1, data.size(), file);
+        fclose(file);
+
+        bool ok = true;
+        LogIndex index;
+        ok &= check(index.update(path, 2048), "indexing the binary log");
+        ok &= check(LogIndex::BinaryFile == index.getFormat(), "binary format detected");
+        ok &= check(data.size() - 1 == index.getIndexedSize(), "incomplete record not indexed");
+
+        LogIndex::Query query;
+        query.categories.push_back(categories[2]);
+        const size_t c = count(index, query);
+        ok &= check((0 < c) && (c < index.getBlocks().size()), "only the blocks of a category");
+        query = LogIndex::Query();
+        query.priority = log4cpp::Priority::WARN;
+        ok &= check(1 == count(index, query), "one block with a WARN");
+
+        // a block decodes on its own, after the name records
+        string names;
+        index.getNameRecords(names);
+        vector<char> block;
+        file = fopen(path, "rb");
+        ok &= check(index.readBlock(file, index.getBlocks().back(), block), "reading a block");
+        fclose(file);
+        names.append(block.begin(), block.end());
+        BinaryLogDecoder decoder;
+        DecodedEvent event;
+        bool isEvent;
+        int n;
+        size_t begin = 0;
+        while ((begin < names.size()) &&
+               (0 < (n = decoder.decode(names.data() + begin, names.size() - begin, isEvent, event))))
+            begin += n;
+        ok &= check((begin == names.size()) && isEvent && (categories[2] == event.category),
+                    "decoding a block");
+
+        remove(path);
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int rc = 0;
+    rc |= testText();
+    rc |= testBinary();
+    cout << (rc ? "testlogindex FAILED" : "testlogindex passed") << endl;
+    return rc;
+}
@@ -0,0 +1,133 @@
+/**
+ * Test of the rate limit and duplicate suppression of the LoggingService.
+ *
+ * A flood of messages is logged to a rate limited category, and to one
+ * which suppresses duplicates, whose events are read from their log
+ * ports. Only the burst, or the first of the duplicates, may pass. Once
+ * the flood stopped, the LoggingService must report the suppressed
+ * messages within the summary interval, and only once.
+ *
+ * Usage: testratelimit
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include <rtt/Activity.hpp>
+#include <rtt/InputPort.hpp>
+#include "logging/LoggingService.hpp"
+
+#include <unistd.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+using namespace OCL::logging;
+using namespace OCL::logging::test;
+
+namespace
+{
+    const char* limitedName     = "org.orocos.ocl.logging.tests.ratelimit.limited";
+    const char* duplicatesName  = "org.orocos.ocl.logging.tests.ratelimit.duplicates";
+
+    /// The messages of the events waiting on \a port
+    vector<string> readAll(InputPort<LoggingEvent>& port)
+    {
+        vector<string> messages;
+        LoggingEvent event;
+        while (NewData == port.read(event)) {
+            string message;
+            event.formatMessage(message);
+            messages.push_back(message);
+        }
+        return messages;
+    }
+
+    bool check(const vector<string>& messages, const vector<string>& expected, const char* what)
+    {
+        if (messages == expected)
+            return true;
+        cerr << "FAILED: " << what << ", read";
+        for (size_t i = 0; i != messages.size(); ++i)
+            cerr << " '" << messages[i] << "'";
+        cerr << endl;
+        return false;
+    }
+
+    Category* connect(const char* name, InputPort<LoggingEvent>& port)
+    {
+        Category* category = dynamic_cast<Category*>(&log4cpp::Category::getInstance(name));
+        ConnPolicy cp = ConnPolicy::buffer(200, ConnPolicy::LOCK_FREE, false, false);
+        if ( !category || !category->connectToLogPort(port, cp) )
+            return 0;
+        return category;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( !startOrocos(argc, argv) )
+        return 1;
+
+    InputPort<LoggingEvent> limitedPort("limited");
+    InputPort<LoggingEvent> duplicatesPort("duplicates");
+    Category* limited       = connect(limitedName, limitedPort);
+    Category* duplicates    = connect(duplicatesName, duplicatesPort);
+
+    // at most 10 messages per second, in bursts of 2, reported every 0.2 s
+    LoggingService service("LoggingService");
+    service.properties()->getPropertyType<PropertyBag>("Levels")->value().ownProperty(
+        new Property<string>(limitedName, "", "info"));
+    service.properties()->getPropertyType<PropertyBag>("Levels")->value().ownProperty(
+        new Property<string>(duplicatesName, "", "info"));
+    service.properties()->getPropertyType<PropertyBag>("RateLimits")->value().ownProperty(
+        new Property<double>(limitedName, "", 10.0));
+    service.properties()->getPropertyType<PropertyBag>("SuppressDuplicates")->value().ownProperty(
+        new Property<bool>(duplicatesName, "", true));
+    service.properties()->getPropertyType<double>("RateLimitBurst")->set(2.0);
+    service.properties()->getPropertyType<double>("SummaryInterval")->set(0.2);
+    service.setActivity( new Activity(ORO_SCHED_OTHER, 0, 0.05) );
+
+    int rc = 0;
+    if ( !limited || !duplicates || !service.configure() || !service.start() ) {
+        cerr << "testratelimit: could not start the LoggingService." << endl;
+        rc = 1;
+    }
+    else {
+        static const BinaryFormat event("Event %d");
+        static const BinaryFormat same("Same message");
+        for (int i = 0; i != 100; ++i) {
+            limited->log(log4cpp::Priority::INFO, event, i);
+            if (i < 5)
+                duplicates->log(log4cpp::Priority::WARN, same);
+        }
+
+        bool ok = true;
+        vector<string> expected;
+        expected.push_back("Event 0");
+        expected.push_back("Event 1");
+        ok &= check(readAll(limitedPort), expected, "the burst passes");
+        ok &= check(readAll(duplicatesPort), vector<string>(1, "Same message"),
+                    "the first duplicate passes");
+
+        // nothing is logged anymore, the service reports the flood
+        usleep(500000);
+        ok &= check(readAll(limitedPort),
+                    vector<string>(1, "98 messages suppressed by the rate limit"),
+                    "the summary of the rate limit");
+        ok &= check(readAll(duplicatesPort),
+                    vector<string>(1, "4 similar messages suppressed"),
+                    "the summary of the duplicates");
+
+        usleep(300000);
+        ok &= check(readAll(limitedPort), vector<string>(), "a single summary");
+        ok &= check(readAll(duplicatesPort), vector<string>(), "a single summary");
+        rc = ok ? 0 : 1;
+        service.stop();
+    }
+    limitedPort.disconnect();
+    duplicatesPort.disconnect();
+    cout << (rc ? "testratelimit FAILED" : "testratelimit passed") << endl;
+
+    __os_exit();
+    return rc;
+}
@@ -0,0 +1,153 @@
+/**
+ * Test of the file sets of a RolloverFile.
+ *
+ * A Rolling set is rolled over several times. The backups must be renamed
+ * along the chain, keeping MaxBackupIndex of them, and the pre-opened
+ * ".next" file must be gone after close. A Generational set must keep the
+ * last generations only, compressed when gzip is available.
+ *
+ * Usage: testrolloverfile
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include "logging/RolloverFile.hpp"
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace OCL::logging;
+using namespace OCL::logging::test;
+
+namespace
+{
+    bool exists(const string& path)
+    {
+        return 0 == access(path.c_str(), F_OK);
+    }
+
+    /// The contents of \a path, "" if it does not exist
+    string contents(const string& path)
+    {
+        string s;
+        FILE* file = fopen(path.c_str(), "r");
+        if (file) {
+            char buffer[256];
+            size_t n;
+            while (0 < (n = fread(buffer, 1, sizeof(buffer), file)))
+                s.append(buffer, n);
+            fclose(file);
+        }
+        return s;
+    }
+
+    /// Roll over, waiting at most a second for the next file to be opened
+    bool rollover(RolloverFile& file)
+    {
+        for (int i = 0; i != 100; ++i) {
+            if (file.rollover())
+                return true;
+            usleep(10000);
+        }
+        return false;
+    }
+
+    /// Write "file i" to files 0 up to \a files, rolling over in between
+    bool writeFiles(RolloverFile& file, int files)
+    {
+        bool ok = true;
+        for (int i = 0; i != files; ++i) {
+            if (0 != i)
+                ok &= check(rollover(file), "rolling over");
+            char text[32];
+            int n = snprintf(text, sizeof(text), "file %d\n", i);
+            ok &= check(file.write(text, n), "writing");
+        }
+        return ok;
+    }
+
+    void removeAll(const string& filename)
+    {
+        remove(filename.c_str());
+        remove((filename + ".next").c_str());
+        for (int i = 0; i != 10; ++i) {
+            char suffix[16];
+            snprintf(suffix, sizeof(suffix), ".%d", i);
+            remove((filename + suffix).c_str());
+            remove((filename + suffix + ".gz").c_str());
+        }
+    }
+
+    int testRolling()
+    {
+        const string filename = "testrolloverfile.log";
+        removeAll(filename);
+
+        bool ok = true;
+        {
+            RolloverFile file;
+            ok &= check(file.open(filename, RolloverFile::Rolling, 2, "", ""), "opening");
+            ok &= writeFiles(file, 4);
+            // wait for the last backup to be renamed
+            usleep(100000);
+            ok &= check(exists(filename + ".next"), "the next file is pre-opened");
+            ok &= check(3 == file.getStatistics().rollovers, "counting the rollovers");
+            file.close();
+        }
+        ok &= check("file 3\n" == contents(filename), "the current file");
+        ok &= check("file 2\n" == contents(filename + ".1"), "the first backup");
+        ok &= check("file 1\n" == contents(filename + ".2"), "the second backup");
+        ok &= check(!exists(filename + ".3"), "only MaxBackupIndex backups");
+        ok &= check(!exists(filename + ".next"), "no next file after closing");
+
+        removeAll(filename);
+        return ok ? 0 : 1;
+    }
+
+    int testGenerational()
+    {
+        const string filename = "testrolloverfile.gen";
+        removeAll(filename);
+        const bool gzip = (0 == system("gzip --version > /dev/null 2>&1"));
+        const string suffix = gzip ? ".gz" : "";
+
+        bool ok = true;
+        {
+            RolloverFile file;
+            ok &= check(file.open(filename, RolloverFile::Generational, 2,
+                                  gzip ? "gzip" : "", ".gz"), "opening");
+            ok &= writeFiles(file, 5);
+            file.close();
+        }
+        ok &= check("file 4\n" == contents(filename + ".4"), "the current generation");
+        ok &= check(exists(filename + ".3" + suffix) && exists(filename + ".2" + suffix),
+                    "the last generations are kept");
+        ok &= check(!gzip || (!exists(filename + ".3") && !exists(filename + ".2")),
+                    "the kept generations are compressed");
+        ok &= check(!exists(filename + ".1") && !exists(filename + ".1.gz") &&
+                    !exists(filename + ".0") && !exists(filename + ".0.gz"),
+                    "older generations are deleted");
+        ok &= check(!exists(filename + ".5"), "no empty next generation after closing");
+
+        removeAll(filename);
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( 0 != __os_init(argc, argv) ) {
+        cerr << "Unable to start Orocos" << endl;
+        return 1;
+    }
+
+    int rc = 0;
+    rc |= testRolling();
+    rc |= testGenerational();
+    cout << (rc ? "testrolloverfile FAILED" : "testrolloverfile passed") << endl;
+
+    __os_exit();
+    return rc;
+}
@@ -0,0 +1,130 @@
+/**
+ * Test of the SharedMemoryAppender against a SharedMemoryReader.
+ *
+ * Events are logged to an OCL category connected to the appender. A
+ * reader which keeps up must receive all of them, in order. A reader
+ * which falls behind a small ring must receive the newest events in
+ * order, and count every other event as lost.
+ *
+ * Usage: testsharedmemory
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include <rtt/Activity.hpp>
+#include "logging/SharedMemoryAppender.hpp"
+#include "logging/SharedMemoryReader.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+using namespace OCL::logging;
+using namespace OCL::logging::test;
+
+namespace
+{
+    const char* categoryName    = "org.orocos.ocl.logging.tests.sharedmemory";
+    const char* shmName         = "/testsharedmemory";
+    /// Number of events logged per run
+    const int   events          = 1000;
+
+    /** Read until \a expected records are read or lost, or nothing
+        happened for a second.
+        \return false if the numbers of the events are not increasing */
+    bool readAll(SharedMemoryReader& reader, boost::uint64_t expected, vector<int>& numbers)
+    {
+        vector<string> records;
+        IdleTimeout timeout;
+        while ( ((boost::uint64_t)numbers.size() + reader.lostRecords() < expected) &&
+                timeout.progressed(numbers.size() + reader.lostRecords()) )
+        {
+            records.clear();
+            reader.read(records);
+            for (unsigned int i = 0; i < records.size(); ++i) {
+                const string::size_type p = records[i].find("Event ");
+                if ( string::npos == p ) {
+                    printf("FAILED, read '%s'\n", records[i].c_str());
+                    return false;
+                }
+                numbers.push_back(atoi(records[i].c_str() + p + 6));
+                if ( (1 < numbers.size()) && (numbers[numbers.size() - 2] >= numbers.back()) ) {
+                    printf("FAILED, event %d after %d\n", numbers.back(),
+                           numbers[numbers.size() - 2]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /** Log the events through an appender with a ring of \a size bytes
+        \param follow read while logging, instead of afterwards
+        \return 0 if all events are read or counted as lost */
+    int run(const char* title, int size, bool follow)
+    {
+        SharedMemoryAppender appender("SharedMemory");
+        appender.properties()->getPropertyType<std::string>("SharedMemoryName")->set( shmName );
+        appender.properties()->getPropertyType<int>("Size")->set( size );
+        appender.setActivity( new Activity(ORO_SCHED_OTHER, 0, 0.01) );
+
+        OCL::logging::Category* category = connectCategory(categoryName, appender, events);
+        if ( !category || !appender.configure() || !appender.start() ) {
+            cerr << "testsharedmemory: could not start the appender." << endl;
+            return 1;
+        }
+        SharedMemoryReader reader;
+        if ( !reader.attach(shmName, false) ) {
+            cerr << "testsharedmemory: could not attach to " << shmName << endl;
+            return 1;
+        }
+
+        static const BinaryFormat format("Event %d of %d");
+        vector<int> numbers;
+        bool ok = true;
+        for (int i = 0; i != events; ++i) {
+            category->log(log4cpp::Priority::INFO, format, i, events);
+            if ( follow && (0 == i % 10) ) {
+                // let the appender publish them, and read them
+                usleep(20000);
+                ok = readAll(reader, i + 1, numbers) && ok;
+            }
+        }
+        if ( !follow )
+            usleep(200000);
+        ok = readAll(reader, events, numbers) && ok;
+        printf("%s: %d read, %d lost\n", title, (int)numbers.size(), (int)reader.lostRecords());
+        ok = ok && (events == (int)(numbers.size() + reader.lostRecords())) &&
+            !numbers.empty() && (events - 1 == numbers.back());
+        if ( follow )
+            ok = ok && (0 == reader.lostRecords());
+        else
+            ok = ok && (0 < reader.lostRecords());
+
+        appender.stop();
+        appender.cleanup();
+        appender.ports()->getPort("LogPort")->disconnect();
+        ::shm_unlink(shmName);
+        if ( !ok )
+            printf("%s: FAILED\n", title);
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( !startOrocos(argc, argv) )
+        return 1;
+
+    int rc = 0;
+    rc |= run("following", 64 * 1024, true);
+    // holds a few dozen events only
+    rc |= run("behind", 2048, false);
+
+    __os_exit();
+    return rc;
+}
@@ -0,0 +1,131 @@
+/**
+ * Test of the UnixSocketAppender against the reference receiver.
+ *
+ * Events are logged to an OCL category connected to the appender, and
+ * received with a UnixSocketReceiver, for a seqpacket and a datagram
+ * socket. The receiver is then restarted, after which the appender must
+ * reconnect and send the category name again.
+ *
+ * Usage: testunixsocket
+ */
+#include "logging/tests/TestHelpers.hpp"
+#include <rtt/Activity.hpp>
+#include "logging/UnixSocketAppender.hpp"
+#include "logging/UnixSocketReceiver.hpp"
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+using namespace OCL::logging;
+using namespace OCL::logging::test;
+
+namespace
+{
+    const char* categoryName    = "org.orocos.ocl.logging.tests.unixsocket";
+    const char* path            = "testunixsocket.sock";
+    /// Number of events logged per run
+    const int   events          = 1000;
+
+    /** Receive until \a expected events are received or dropped, or
+        nothing happened for a second.
+        \return false if an event is not as logged */
+    bool receiveAll(UnixSocketReceiver& receiver, UnixSocketAppender& appender,
+                    int expected, vector<DecodedEvent>& received)
+    {
+        // receive() waits 10 ms for a packet
+        IdleTimeout timeout(100, 0);
+        int done;
+        while ( ((done = (int)received.size() + getProperty<int>(appender, "DroppedEvents")) < expected) &&
+                timeout.progressed(done) )
+        {
+            receiver.receive(10, received);
+        }
+        for (unsigned int i = 0; i < received.size(); ++i) {
+            if ( received[i].category != categoryName ||
+                 0 != received[i].message.compare(0, 6, "Event ") ) {
+                printf("FAILED, received '%s' from '%s'\n",
+                       received[i].message.c_str(), received[i].category.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Log the events through the appender to a receiver on the path
+        \return 0 if all events are received, also after a restart */
+    int run(const char* title, bool datagram)
+    {
+        UnixSocketReceiver receiver;
+        if ( !receiver.open(path, datagram) )
+            return 1;
+
+        UnixSocketAppender appender("UnixSocket");
+        appender.properties()->getPropertyType<std::string>("SocketPath")->set( path );
+        appender.properties()->getPropertyType<std::string>("SocketType")->set( datagram ? "datagram" : "seqpacket" );
+        appender.properties()->getPropertyType<double>("ReconnectInterval")->set( 0.0 );
+        appender.setActivity( new Activity(ORO_SCHED_OTHER, 0, 0.01) );
+
+        OCL::logging::Category* category = connectCategory(categoryName, appender, events);
+        if ( !category || !appender.configure() || !appender.start() ) {
+            cerr << "testunixsocket: could not start the appender." << endl;
+            return 1;
+        }
+
+        static const BinaryFormat format("Event %d of %d");
+        vector<DecodedEvent> received;
+        for (int i = 0; i != events; ++i)
+            category->log(log4cpp::Priority::INFO, format, i, events);
+        bool ok = receiveAll(receiver, appender, events, received);
+        int dropped = getProperty<int>(appender, "DroppedEvents");
+        printf("%s: %d received, %d dropped, %d packets, %d invalid\n", title,
+               (int)received.size(), dropped, getProperty<int>(appender, "PacketsSent"),
+               receiver.invalidPackets());
+        // the socket buffer holds all events, nothing may be dropped
+        ok = ok && (events == (int)received.size()) && (0 == dropped) &&
+            (0 == receiver.invalidPackets());
+
+        // a new receiver knows no names, the appender sends them again
+        receiver.close();
+        category->log(log4cpp::Priority::INFO, format, 0, 1);
+        usleep(100000);
+        receiver.open(path, datagram);
+        received.clear();
+        int restarted = 0;
+        for (int i = 0; (i < 100) && received.empty(); ++i) {
+            category->log(log4cpp::Priority::INFO, format, i, 100);
+            ++restarted;
+            receiver.receive(10, received);
+        }
+        // all events since the restart are received or dropped
+        ok = receiveAll(receiver, appender, restarted + 1, received) && ok;
+        printf("%s: after a restart %d received, %d invalid\n", title,
+               (int)received.size(), receiver.invalidPackets());
+        ok = ok && !received.empty() && (0 == receiver.invalidPackets());
+
+        appender.stop();
+        appender.cleanup();
+        appender.ports()->getPort("LogPort")->disconnect();
+        if ( !ok )
+            printf("%s: FAILED\n", title);
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( !startOrocos(argc, argv) )
+        return 1;
+
+    int rc = 0;
+    rc |= run("seqpacket", false);
+    rc |= run("datagram", true);
+
+    __os_exit();
+    return rc;
+}
@@ -3,6 +3,7 @@
 #include <rtt/Logger.hpp>
 #include "TableMarshaller.hpp"
 #include "NiceHeaderMarshaller.hpp"
+#include "DashboardMarshaller.hpp"
 
 #include "ocl/Component.hpp"
 ORO_LIST_COMPONENT_TYPE(OCL::ConsoleReporting)
@@ -14,14 +15,21 @@ namespace OCL
 
     ConsoleReporting::ConsoleReporting(std::string fr_name /*= "Reporting"*/, std::ostream& console /*= std::cerr*/)
         : ReportingComponent( fr_name ),
-          mconsole( console )
+          mconsole( console ),
+          dashboard("Dashboard","Set to true to redraw the latest values in place instead of writing a line per sample.",false),
+          dashboard_rate("DashboardRate","Maximum number of dashboard redraws per second.",10.0)
     {
+        this->properties()->addProperty( dashboard );
+        this->properties()->addProperty( dashboard_rate );
     }
 
         bool ConsoleReporting::startHook()
         {
             RTT::Logger::In in("ConsoleReporting::startup");
-            if (mconsole) {
+            if (mconsole && dashboard.get()) {
+                // the dashboard shows the column names itself.
+                this->addMarshaller( 0, new RTT::DashboardMarshaller<std::ostream>( mconsole, dashboard_rate.get() ) );
+            } else if (mconsole) {
                 RTT::marsh::MarshallInterface* fheader;
                 RTT::marsh::MarshallInterface* fbody;
                 if ( this->writeHeader)
@@ -10,6 +10,12 @@ namespace OCL
 {
     /**
      * A component which writes data reports to a console.
+     *
+     * By default, a new table line is written for each sample. When
+     * the Dashboard property is set, the latest value of each column is
+     * shown on a fixed screen layout instead, which is redrawn in place
+     * at most DashboardRate times per second. This requires a terminal
+     * which understands ANSI escape sequences.
      */
     class ConsoleReporting
         : public ReportingComponent
@@ -20,6 +26,9 @@ namespace OCL
          */
         std::ostream& mconsole;
 
+        RTT::Property<bool>   dashboard;
+        RTT::Property<double> dashboard_rate;
+
     public:
         /**
          * Create a reporting component which writes to a C++ stream.
@@ -0,0 +1,172 @@
+/***************************************************************************
+
+           DashboardMarshaller.hpp -  in-place console dashboard
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ORO_COMP_DASHBOARD_MARSHALLER_HPP
+#define ORO_COMP_DASHBOARD_MARSHALLER_HPP
+
+#include <rtt/Property.hpp>
+#include <rtt/base/PropertyIntrospection.hpp>
+#include <rtt/marsh/StreamProcessor.hpp>
+#include <rtt/marsh/MarshallInterface.hpp>
+#include <rtt/os/TimeService.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <map>
+#include <vector>
+
+namespace RTT
+{
+    /**
+     * A marsh::MarshallInterface which shows the latest value of each
+     * column on a fixed screen layout, one line per column. The screen
+     * is redrawn in place using ANSI escape sequences, at most \a rate
+     * times per second. Frames which arrive in between are dropped
+     * before any of their values are formatted.
+     *
+     * When the reporter only reports new data, a column keeps the
+     * value it had at the last redraw in which it was reported.
+     */
+    template<typename o_stream>
+    class DashboardMarshaller
+        : public marsh::MarshallInterface, public marsh::StreamProcessor<o_stream>
+    {
+        typedef std::vector< std::pair<std::string, std::string> > Rows;
+        Rows rows;
+        std::map<std::string, typename Rows::size_type> index;
+        std::string prefix;
+        std::string::size_type width;
+        os::TimeService::Seconds period;
+        os::TimeService::ticks lastdraw;
+        enum { NewFrame, Drawing, Skipping } state;
+        bool relayout;
+        unsigned long long frames;
+        unsigned long long skipped;
+
+        /**
+         * Decides at the start of each frame if it will be drawn.
+         * @return true if the current frame is drawn.
+         */
+        bool beginFrame()
+        {
+            if ( state == NewFrame ) {
+                os::TimeService* ts = os::TimeService::Instance();
+                if ( lastdraw == 0 || period <= 0.0 || ts->secondsSince( lastdraw ) >= period ) {
+                    lastdraw = ts->getTicks();
+                    state = Drawing;
+                } else
+                    state = Skipping;
+            }
+            return state == Drawing;
+        }
+
+        void store(const std::string& name, base::DataSourceBase::shared_ptr ds)
+        {
+            std::string fullname = prefix.empty() ? name : prefix + '.' + name;
+            std::ostringstream value;
+            value << ds;
+            typename std::map<std::string, typename Rows::size_type>::iterator it = index.find( fullname );
+            if ( it == index.end() ) {
+                index[fullname] = rows.size();
+                rows.push_back( std::make_pair( fullname, value.str() ) );
+                width = std::max( width, fullname.size() );
+                relayout = true;
+            } else
+                rows[it->second].second = value.str();
+        }
+
+        void draw()
+        {
+            // clear the whole screen only when a column appeared.
+            if ( relayout )
+                *this->s << "\033[2J";
+            relayout = false;
+            *this->s << "\033[H" << "Frame " << frames << " (" << skipped << " skipped)\033[K\n";
+            for ( typename Rows::const_iterator it = rows.begin(); it != rows.end(); ++it )
+                *this->s << std::left << std::setw( width ) << it->first << std::right
+                         << " : " << it->second << "\033[K\n";
+            *this->s << "\033[J";
+            this->s->flush();
+        }
+
+    public:
+        typedef o_stream output_stream;
+        typedef o_stream OutputStream;
+
+        /**
+         * Create a new dashboard on a terminal stream.
+         * @param os The stream to draw on (i.e. cout)
+         * @param rate The maximum number of redraws per second.
+         * Zero redraws on every frame.
+         */
+        DashboardMarshaller(output_stream &os, double rate = 10.0)
+            : marsh::StreamProcessor<o_stream>(os),
+              width(0), period( rate > 0.0 ? 1.0 / rate : 0.0 ), lastdraw(0),
+              state(NewFrame), relayout(true), frames(0), skipped(0)
+        {}
+
+        virtual ~DashboardMarshaller() {}
+
+        virtual void serialize(base::PropertyBase* v)
+        {
+            if ( !beginFrame() )
+                return;
+            Property<PropertyBag>* bag = dynamic_cast< Property<PropertyBag>* >( v );
+            if ( bag ) {
+                std::string oldpref = prefix;
+                prefix = prefix.empty() ? bag->getName() : prefix + '.' + bag->getName();
+                this->serialize( bag->value() );
+                prefix = oldpref;
+            } else
+                store( v->getName(), v->getDataSource() );
+        }
+
+        virtual void serialize(const PropertyBag &v)
+        {
+            if ( !beginFrame() )
+                return;
+            for (
+                PropertyBag::const_iterator i = v.getProperties().begin();
+                i != v.getProperties().end();
+                i++ )
+            {
+                this->serialize( *i );
+            }
+        }
+
+        virtual void flush()
+        {
+            if ( state == NewFrame )
+                return;
+            ++frames;
+            if ( state == Drawing )
+                draw();
+            else
+                ++skipped;
+            state = NewFrame;
+        }
+    };
+}
+#endif
@@ -4,6 +4,7 @@
 #include <rtt/Logger.hpp>
 #include "TableMarshaller.hpp"
 #include "NiceHeaderMarshaller.hpp"
+#include "IndexMarshaller.hpp"
 
 
 #include "ocl/Component.hpp"
@@ -16,15 +17,30 @@ namespace OCL
 
     FileReporting::FileReporting(const std::string& fr_name)
         : ReportingComponent( fr_name ),
-          repfile("ReportFile","Location on disc to store the reports.", "reports.dat")
+          repfile("ReportFile","Location on disc to store the reports.", "reports.dat"),
+          writeIndex("WriteIndex","Write a time index to ReportFile.idx, for use with ocl-reportquery.", false),
+          indexBlockRows("IndexBlockRows","Number of report lines per index entry.", 1000)
     {
         this->properties()->addProperty( repfile );
+        this->properties()->addProperty( writeIndex );
+        this->properties()->addProperty( indexBlockRows );
     }
 
     bool FileReporting::startHook()
     {
         mfile.open( repfile.get().c_str() );
         if (mfile) {
+            if ( writeIndex ) {
+                // must be serialized before the table, to see the offset of each line.
+                RTT::IndexMarshaller<std::ostream>* index =
+                    new RTT::IndexMarshaller<std::ostream>( mfile, repfile.get() + ".idx", indexBlockRows.get() > 0 ? indexBlockRows.get() : 1000 );
+                if ( index->isOpen() )
+                    this->addMarshaller( 0, index );
+                else {
+                    log(Error) << "Could not open file "+repfile.get()+".idx for writing the report index."<<endlog();
+                    delete index;
+                }
+            }
             if ( this->writeHeader)
                 fheader = new RTT::NiceHeaderMarshaller<std::ostream>( mfile );
             else
@@ -10,6 +10,11 @@ namespace OCL
 {
     /**
      * A component which writes data reports to a file.
+     *
+     * When WriteIndex is set, a time index of the report is written
+     * next to it, in ReportFile followed by ".idx". The index allows
+     * ReportReader and the ocl-reportquery tool to read a time range
+     * without scanning the whole report.
      */
     class FileReporting
         : public ReportingComponent
@@ -20,6 +25,16 @@ namespace OCL
          */
         RTT::Property<std::string>   repfile;
 
+        /**
+         * Write a time index next to the report.
+         */
+        RTT::Property<bool>          writeIndex;
+
+        /**
+         * Number of report lines per index entry.
+         */
+        RTT::Property<int>           indexBlockRows;
+
         /**
          * File to write reports to.
          */
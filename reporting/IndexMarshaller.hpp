@@ -0,0 +1,164 @@
+/***************************************************************************
+
+     IndexMarshaller.hpp -  writes the sidecar index of a table report
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ORO_COMP_INDEX_MARSHALLER_HPP
+#define ORO_COMP_INDEX_MARSHALLER_HPP
+
+#include <rtt/Property.hpp>
+#include <rtt/base/PropertyIntrospection.hpp>
+#include <rtt/marsh/MarshallInterface.hpp>
+#include <fstream>
+#include "ReportIndex.hpp"
+
+namespace RTT
+{
+    /**
+     * A marsh::MarshallInterface which writes the sidecar index (see
+     * OCL::ReportIndex) of the rows a TableMarshaller writes to the same
+     * stream. It must be added to the reporter before the
+     * TableMarshaller, such that the stream position at serialization
+     * is the start of the row.
+     *
+     * The column directory is taken from the first complete report. When
+     * only new data is reported, rows do not have a fixed layout and only
+     * the time index is usable.
+     */
+    template<typename o_stream>
+    class IndexMarshaller
+        : public marsh::MarshallInterface
+    {
+        o_stream& data;
+        std::ofstream index;
+        unsigned int block_rows;
+        bool started;
+        bool pending;
+        OCL::ReportIndex::Block block;
+        std::vector<std::string> columns;
+
+        void collect(const PropertyBag& v, const std::string& prefix)
+        {
+            for (PropertyBag::const_iterator it = v.getProperties().begin(); it != v.getProperties().end(); ++it) {
+                std::string name = prefix.empty() ? (*it)->getName() : prefix + '.' + (*it)->getName();
+                Property<PropertyBag>* bag = dynamic_cast< Property<PropertyBag>* >( *it );
+                if ( bag )
+                    collect( bag->rvalue(), name );
+                else
+                    columns.push_back( name );
+            }
+        }
+
+        void start()
+        {
+            OCL::ReportIndex::writeHeader( index, block_rows, columns );
+            started = true;
+        }
+
+        /**
+         * Starts a new row, \a first is the first property in the row.
+         */
+        void row(base::PropertyBase* first)
+        {
+            if ( !started )
+                start();
+            if ( pending )
+                return;
+            double t = block.t_last;
+            Property<double>* ts = dynamic_cast< Property<double>* >( first );
+            if ( ts )
+                t = ts->rvalue();
+            if ( block.rows == 0 ) {
+                block.offset = data.tellp();
+                block.t_first = t;
+            }
+            block.t_last = t;
+            pending = true;
+        }
+
+        void writeBlock()
+        {
+            if ( block.rows == 0 )
+                return;
+            OCL::ReportIndex::writeBlock( index, block );
+            index.flush();
+            block.rows = 0;
+        }
+
+    public:
+        typedef o_stream output_stream;
+        typedef o_stream OutputStream;
+
+        /**
+         * Create a new index marshaller.
+         * @param os The stream to which the table is written.
+         * @param indexfile The name of the sidecar index file.
+         * @param rows The number of rows in each block of the index.
+         */
+        IndexMarshaller(output_stream& os, const std::string& indexfile, unsigned int rows = 1000)
+            : data(os), index( indexfile.c_str(), std::ios::binary | std::ios::trunc ),
+              block_rows( rows ? rows : 1 ), started(false), pending(false)
+        {
+            block.t_first = block.t_last = 0.0;
+            block.offset = 0;
+            block.rows = 0;
+        }
+
+        virtual ~IndexMarshaller()
+        {
+            if ( !started )
+                start();
+            writeBlock();
+        }
+
+        /**
+         * Returns false if the index file could not be opened.
+         */
+        bool isOpen() const { return index.is_open(); }
+
+        virtual void serialize(base::PropertyBase* v)
+        {
+            row( v );
+        }
+
+        virtual void serialize(const PropertyBag &v)
+        {
+            if ( !started && columns.empty() )
+                collect( v, "" );
+            row( v.getProperties().empty() ? 0 : v.getProperties().front() );
+        }
+
+        virtual void flush()
+        {
+            if ( !pending ) {
+                // a flush without data is the end of the report.
+                writeBlock();
+                return;
+            }
+            pending = false;
+            if ( ++block.rows == block_rows )
+                writeBlock();
+        }
+    };
+}
+#endif
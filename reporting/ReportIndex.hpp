@@ -0,0 +1,108 @@
+/***************************************************************************
+
+          ReportIndex.hpp -  sidecar index format of table reports
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ORO_COMP_REPORT_INDEX_HPP
+#define ORO_COMP_REPORT_INDEX_HPP
+
+#include <boost/cstdint.hpp>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace OCL
+{
+    /**
+     * The sidecar index of a table report, as written by FileReporting
+     * when WriteIndex is set and read by ReportReader. The index file
+     * is named after the report with an extra ".idx" suffix and has the
+     * following layout, in host byte order:
+     *
+     * - a Header,
+     * - the column directory: Header::columns names, each terminated by
+     *   a '\\0', padded with zeros to Header::names_size, a multiple of 8,
+     * - a Block for each group of Header::block_rows rows of the report,
+     *   in the order in which they were written. The last block may
+     *   contain less rows.
+     *
+     * A Block ends where the next one starts, the last one ends at the
+     * end of the report file.
+     */
+    namespace ReportIndex
+    {
+        const char Magic[8] = { 'O', 'C', 'L', 'R', 'I', 'D', 'X', '1' };
+        const boost::uint32_t Version = 1;
+
+        struct Header
+        {
+            char            magic[8];
+            boost::uint32_t version;
+            boost::uint32_t block_rows;
+            boost::uint32_t columns;
+            boost::uint32_t names_size;
+        };
+
+        struct Block
+        {
+            //! Time stamp of the first row in this block.
+            double          t_first;
+            //! Time stamp of the last row in this block.
+            double          t_last;
+            //! Byte offset of the first row in the report.
+            boost::uint64_t offset;
+            //! Number of rows in this block.
+            boost::uint64_t rows;
+        };
+
+        /**
+         * Writes the header and the column directory.
+         */
+        inline void writeHeader( std::ostream& os, unsigned int block_rows, const std::vector<std::string>& columns )
+        {
+            Header h;
+            memcpy( h.magic, Magic, sizeof(Magic) );
+            h.version = Version;
+            h.block_rows = block_rows;
+            h.columns = columns.size();
+            h.names_size = 0;
+            for (std::vector<std::string>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+                h.names_size += it->size() + 1;
+            unsigned int padding = (8 - h.names_size % 8) % 8;
+            h.names_size += padding;
+            os.write( reinterpret_cast<const char*>(&h), sizeof(h) );
+            for (std::vector<std::string>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+                os.write( it->c_str(), it->size() + 1 );
+            const char zeros[8] = { 0 };
+            os.write( zeros, padding );
+        }
+
+        inline void writeBlock( std::ostream& os, const Block& b )
+        {
+            os.write( reinterpret_cast<const char*>(&b), sizeof(b) );
+        }
+    }
+}
+
+#endif
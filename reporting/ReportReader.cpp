@@ -0,0 +1,316 @@
+/***************************************************************************
+
+         ReportReader.cpp -  time-indexed queries on table reports
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ReportReader.hpp"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace OCL
+{
+    using namespace std;
+
+    namespace
+    {
+        bool mapFile( const string& name, const char*& data, size_t& size )
+        {
+            int fd = ::open( name.c_str(), O_RDONLY );
+            if ( fd < 0 ) {
+                cerr << "Could not open " << name << ": " << strerror(errno) << endl;
+                return false;
+            }
+            struct stat st;
+            if ( fstat( fd, &st ) != 0 ) {
+                cerr << "Could not stat " << name << ": " << strerror(errno) << endl;
+                ::close( fd );
+                return false;
+            }
+            size = st.st_size;
+            data = 0;
+            if ( size != 0 ) {
+                void* p = mmap( 0, size, PROT_READ, MAP_SHARED, fd, 0 );
+                if ( p == MAP_FAILED ) {
+                    cerr << "Could not map " << name << ": " << strerror(errno) << endl;
+                    ::close( fd );
+                    return false;
+                }
+                data = static_cast<const char*>( p );
+            }
+            ::close( fd );
+            return true;
+        }
+
+        void unmapFile( const char*& data, size_t& size )
+        {
+            if ( data )
+                munmap( const_cast<char*>( data ), size );
+            data = 0;
+            size = 0;
+        }
+
+        /**
+         * Splits the line [begin, end) in space separated tokens.
+         */
+        void tokenize( const char* begin, const char* end, vector< pair<const char*, size_t> >& tokens )
+        {
+            tokens.clear();
+            const char* p = begin;
+            while ( p != end ) {
+                while ( p != end && ( *p == ' ' || *p == '\t' || *p == '\r' ) )
+                    ++p;
+                const char* start = p;
+                while ( p != end && *p != ' ' && *p != '\t' && *p != '\r' )
+                    ++p;
+                if ( p != start )
+                    tokens.push_back( make_pair( start, size_t(p - start) ) );
+            }
+        }
+
+        /**
+         * Parses the time stamp of a row, returns false for headers and
+         * empty lines.
+         */
+        bool timeStamp( const vector< pair<const char*, size_t> >& tokens, double& t )
+        {
+            if ( tokens.empty() )
+                return false;
+            string first( tokens[0].first, tokens[0].second );
+            char* end;
+            t = strtod( first.c_str(), &end );
+            return *end == '\0';
+        }
+    }
+
+    ReportReader::ReportReader()
+        : mdata(0), mdatasize(0), mindex(0), mindexsize(0), mblocks(0), mnblocks(0), mscanned(0), mskipped(0)
+    {
+    }
+
+    ReportReader::~ReportReader()
+    {
+        close();
+    }
+
+    void ReportReader::close()
+    {
+        unmapFile( mdata, mdatasize );
+        unmapFile( mindex, mindexsize );
+        mblocks = 0;
+        mnblocks = 0;
+        mcolumns.clear();
+        mcolumnmap.clear();
+    }
+
+    bool ReportReader::open( const string& report, const string& index )
+    {
+        close();
+        string indexfile = index.empty() ? report + ".idx" : index;
+        if ( !mapFile( report, mdata, mdatasize ) || !mapFile( indexfile, mindex, mindexsize ) ) {
+            close();
+            return false;
+        }
+
+        const ReportIndex::Header* h = reinterpret_cast<const ReportIndex::Header*>( mindex );
+        if ( mindexsize < sizeof(ReportIndex::Header) || memcmp( h->magic, ReportIndex::Magic, sizeof(ReportIndex::Magic) ) != 0
+             || h->version != ReportIndex::Version || mindexsize < sizeof(ReportIndex::Header) + h->names_size ) {
+            cerr << indexfile << " is not a valid report index." << endl;
+            close();
+            return false;
+        }
+
+        const char* names = mindex + sizeof(ReportIndex::Header);
+        const char* namesend = names + h->names_size;
+        for ( unsigned int i = 0; i != h->columns && names < namesend; ++i ) {
+            size_t len = strnlen( names, namesend - names );
+            mcolumnmap[ string(names, len) ] = mcolumns.size();
+            mcolumns.push_back( string(names, len) );
+            names += len + 1;
+        }
+
+        mblocks = reinterpret_cast<const ReportIndex::Block*>( namesend );
+        mnblocks = ( mindexsize - sizeof(ReportIndex::Header) - h->names_size ) / sizeof(ReportIndex::Block);
+        // rows are looked up by offset, not in sequence.
+        if ( mdata )
+            madvise( const_cast<char*>( mdata ), mdatasize, MADV_RANDOM );
+        return true;
+    }
+
+    int ReportReader::column( const string& name ) const
+    {
+        map<string, int>::const_iterator it = mcolumnmap.find( name );
+        return it == mcolumnmap.end() ? -1 : it->second;
+    }
+
+    double ReportReader::startTime() const
+    {
+        return mnblocks ? mblocks[0].t_first : 0.0;
+    }
+
+    double ReportReader::endTime() const
+    {
+        return mnblocks ? mblocks[mnblocks - 1].t_last : 0.0;
+    }
+
+    bool ReportReader::query( const vector<string>& names, double t0, double t1, RowHandler& handler )
+    {
+        mscanned = 0;
+        mskipped = 0;
+        vector<int> wanted;
+        if ( names.empty() ) {
+            for ( size_t i = 0; i != mcolumns.size(); ++i )
+                wanted.push_back( i );
+        }
+        for ( vector<string>::const_iterator it = names.begin(); it != names.end(); ++it ) {
+            int c = column( *it );
+            if ( c < 0 ) {
+                cerr << "No column '" << *it << "' in report." << endl;
+                return false;
+            }
+            wanted.push_back( c );
+        }
+
+        // first block which may contain t0.
+        size_t lo = 0, hi = mnblocks;
+        while ( lo < hi ) {
+            size_t mid = (lo + hi) / 2;
+            if ( mblocks[mid].t_last < t0 )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        vector< pair<const char*, size_t> > tokens;
+        vector<string> values( wanted.size() );
+        for ( size_t b = lo; b < mnblocks && mblocks[b].t_first <= t1; ++b ) {
+            size_t begin = mblocks[b].offset;
+            size_t end = b + 1 < mnblocks ? mblocks[b+1].offset : mdatasize;
+            if ( end > mdatasize )
+                end = mdatasize;
+            if ( begin >= end )
+                continue;
+            mscanned += end - begin;
+
+            const char* p = mdata + begin;
+            const char* stop = mdata + end;
+            while ( p < stop ) {
+                const char* eol = static_cast<const char*>( memchr( p, '\n', stop - p ) );
+                if ( !eol )
+                    eol = stop;
+                tokenize( p, eol, tokens );
+                p = eol + 1;
+                double t;
+                if ( !timeStamp( tokens, t ) || t < t0 )
+                    continue;
+                if ( t > t1 )
+                    return true;
+                // a value with spaces would shift the columns after it.
+                if ( tokens.size() != mcolumns.size() ) {
+                    ++mskipped;
+                    continue;
+                }
+                for ( size_t i = 0; i != wanted.size(); ++i )
+                    values[i].assign( tokens[ wanted[i] ].first, tokens[ wanted[i] ].second );
+                handler.row( t, values );
+            }
+        }
+        return true;
+    }
+
+    bool ReportReader::buildIndex( const string& report, unsigned int block_rows, const string& index )
+    {
+        const char* data = 0;
+        size_t size = 0;
+        if ( !mapFile( report, data, size ) )
+            return false;
+        string indexfile = index.empty() ? report + ".idx" : index;
+        ofstream out( indexfile.c_str(), ios::binary | ios::trunc );
+        if ( !out ) {
+            cerr << "Could not create " << indexfile << endl;
+            unmapFile( data, size );
+            return false;
+        }
+        if ( block_rows == 0 )
+            block_rows = 1;
+
+        vector< pair<const char*, size_t> > tokens;
+        vector<string> columns;
+        bool started = false;
+        ReportIndex::Block block;
+        block.rows = 0;
+        const char* p = data;
+        const char* end = data + size;
+        while ( p < end ) {
+            const char* eol = static_cast<const char*>( memchr( p, '\n', end - p ) );
+            if ( !eol )
+                eol = end;
+            const char* line = p;
+            tokenize( p, eol, tokens );
+            p = eol + 1;
+            double t;
+            if ( !timeStamp( tokens, t ) ) {
+                // the NiceHeaderMarshaller writes the column names.
+                if ( !started && columns.empty() )
+                    for ( size_t i = 0; i != tokens.size(); ++i )
+                        columns.push_back( string( tokens[i].first, tokens[i].second ) );
+                continue;
+            }
+            if ( !started ) {
+                if ( columns.empty() ) {
+                    columns.push_back( "TimeStamp" );
+                    for ( size_t i = 1; i < tokens.size(); ++i ) {
+                        ostringstream name;
+                        name << "col" << i;
+                        columns.push_back( name.str() );
+                    }
+                }
+                ReportIndex::writeHeader( out, block_rows, columns );
+                started = true;
+            }
+            if ( block.rows == 0 ) {
+                block.offset = line - data;
+                block.t_first = t;
+            }
+            block.t_last = t;
+            if ( ++block.rows == block_rows ) {
+                ReportIndex::writeBlock( out, block );
+                block.rows = 0;
+            }
+        }
+        if ( !started )
+            ReportIndex::writeHeader( out, block_rows, columns );
+        if ( block.rows )
+            ReportIndex::writeBlock( out, block );
+        unmapFile( data, size );
+        return out.good();
+    }
+}
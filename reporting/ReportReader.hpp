@@ -0,0 +1,136 @@
+/***************************************************************************
+
+         ReportReader.hpp -  time-indexed queries on table reports
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ORO_COMP_REPORT_READER_HPP
+#define ORO_COMP_REPORT_READER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include "ReportIndex.hpp"
+
+#include <ocl/OCL.hpp>
+
+namespace OCL
+{
+    /**
+     * Reads columns over a time range from a table report written by
+     * FileReporting, using its sidecar index (see ReportIndex). Both
+     * files are memory mapped and a query only touches the blocks of the
+     * report which overlap the requested time range.
+     *
+     * The reader assumes that values do not contain spaces, which holds
+     * for all numeric types.
+     */
+    class OCL_API ReportReader
+    {
+    public:
+        /**
+         * Receives the rows of a query.
+         */
+        struct RowHandler
+        {
+            virtual ~RowHandler() {}
+            /**
+             * Called for each row in the requested time range.
+             * @param time The time stamp of the row.
+             * @param values The values of the requested columns, in the
+             * order of the query.
+             */
+            virtual void row( double time, const std::vector<std::string>& values ) = 0;
+        };
+
+        ReportReader();
+        ~ReportReader();
+
+        /**
+         * Maps a report and its index.
+         * @param report The report file.
+         * @param index The index file, by default the report name
+         * followed by ".idx".
+         * @return false and logs to std::cerr if either could not be
+         * mapped or the index is invalid.
+         */
+        bool open( const std::string& report, const std::string& index = "" );
+
+        void close();
+
+        /**
+         * The names of all columns, the first one being the time stamp.
+         */
+        const std::vector<std::string>& columns() const { return mcolumns; }
+
+        /**
+         * Returns the position of a column in a row, or -1.
+         */
+        int column( const std::string& name ) const;
+
+        /**
+         * The time stamps of the first and the last indexed row.
+         */
+        double startTime() const;
+        double endTime() const;
+
+        /**
+         * Calls \a handler for each row with a time stamp in [t0, t1].
+         * @param names The columns to return. An empty list returns all
+         * columns.
+         * @return false if a column does not exist.
+         */
+        bool query( const std::vector<std::string>& names, double t0, double t1, RowHandler& handler );
+
+        /**
+         * The number of report bytes scanned by the last query.
+         */
+        unsigned long long scannedBytes() const { return mscanned; }
+
+        /**
+         * The number of rows in the time range of the last query which were
+         * skipped because their number of values differs from the number
+         * of columns.
+         */
+        unsigned long long skippedRows() const { return mskipped; }
+
+        /**
+         * Builds the index of a report which was written without one.
+         * The column names are taken from the header line, if present.
+         */
+        static bool buildIndex( const std::string& report, unsigned int block_rows = 1000, const std::string& index = "" );
+
+    private:
+        const char* mdata;
+        std::size_t mdatasize;
+        const char* mindex;
+        std::size_t mindexsize;
+        const ReportIndex::Block* mblocks;
+        std::size_t mnblocks;
+        std::vector<std::string> mcolumns;
+        std::map<std::string, int> mcolumnmap;
+        unsigned long long mscanned;
+        unsigned long long mskipped;
+    };
+}
+
+#endif
@@ -0,0 +1,298 @@
+/***************************************************************************
+
+        ReportTrigger.cpp -  trigger expressions over report columns
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ReportTrigger.hpp"
+#include <rtt/Logger.hpp>
+#include <rtt/Property.hpp>
+#include <rtt/internal/DataSource.hpp>
+#include <cctype>
+#include <cstdlib>
+
+namespace OCL
+{
+    using namespace RTT;
+    using namespace std;
+
+    struct ReportTrigger::Node
+    {
+        virtual ~Node() {}
+        virtual double value() = 0;
+    };
+
+    namespace
+    {
+        typedef ReportTrigger::NodePtr NodePtr;
+
+        struct Constant : public ReportTrigger::Node
+        {
+            double c;
+            Constant(double v) : c(v) {}
+            double value() { return c; }
+        };
+
+        /**
+         * Reads the sampled value of a column without re-evaluating
+         * its data source.
+         */
+        template<class T>
+        struct Column : public ReportTrigger::Node
+        {
+            typename internal::DataSource<T>::shared_ptr ds;
+            Column(typename internal::DataSource<T>::shared_ptr d) : ds(d) {}
+            double value() { return ds->rvalue(); }
+        };
+
+        struct Changed : public ReportTrigger::Node
+        {
+            NodePtr col;
+            double last;
+            bool first;
+            Changed(NodePtr c) : col(c), last(0.0), first(true) {}
+            double value() {
+                double v = col->value();
+                bool result = !first && v != last;
+                first = false;
+                last = v;
+                return result;
+            }
+        };
+
+        struct Not : public ReportTrigger::Node
+        {
+            NodePtr a;
+            Not(NodePtr n) : a(n) {}
+            double value() { return a->value() == 0.0; }
+        };
+
+        struct Binary : public ReportTrigger::Node
+        {
+            enum Op { Or, And, Lt, Le, Gt, Ge, Eq, Ne } op;
+            NodePtr a, b;
+            Binary(Op o, NodePtr l, NodePtr r) : op(o), a(l), b(r) {}
+            double value() {
+                // no short-circuit: changed() must see every sample.
+                double l = a->value(), r = b->value();
+                switch (op) {
+                case Or:  return l != 0.0 || r != 0.0;
+                case And: return l != 0.0 && r != 0.0;
+                case Lt:  return l <  r;
+                case Le:  return l <= r;
+                case Gt:  return l >  r;
+                case Ge:  return l >= r;
+                case Eq:  return l == r;
+                case Ne:  return l != r;
+                }
+                return 0.0;
+            }
+        };
+
+        template<class T>
+        NodePtr tryColumn(base::DataSourceBase::shared_ptr dsb)
+        {
+            typename internal::DataSource<T>::shared_ptr ds = internal::DataSource<T>::narrow( dsb.get() );
+            if ( ds )
+                return NodePtr( new Column<T>( ds ) );
+            return NodePtr();
+        }
+
+        /**
+         * Finds a leaf in the report. Top level names contain dots
+         * themselves ("Component.Port"), the members below are
+         * separated by dots as well.
+         */
+        base::PropertyBase* findColumn(const PropertyBag& report, const string& name)
+        {
+            for (PropertyBag::const_iterator it = report.getProperties().begin(); it != report.getProperties().end(); ++it) {
+                const string& top = (*it)->getName();
+                if ( top == name )
+                    return *it;
+                if ( name.size() > top.size() && name[top.size()] == '.' && name.compare(0, top.size(), top) == 0 ) {
+                    Property<PropertyBag>* bag = dynamic_cast< Property<PropertyBag>* >( *it );
+                    if ( bag ) {
+                        base::PropertyBase* leaf = findProperty( bag->rvalue(), name.substr( top.size() + 1 ), "." );
+                        if ( leaf )
+                            return leaf;
+                    }
+                }
+            }
+            return 0;
+        }
+
+        class Parser
+        {
+            const string& in;
+            string::size_type pos;
+            const PropertyBag& report;
+        public:
+            string error;
+
+            Parser(const string& expr, const PropertyBag& r) : in(expr), pos(0), report(r) {}
+
+            void skip() {
+                while ( pos < in.size() && isspace( in[pos] ) )
+                    ++pos;
+            }
+
+            bool accept(const char* tok) {
+                skip();
+                string::size_type n = string(tok).size();
+                if ( in.compare(pos, n, tok) == 0 ) {
+                    pos += n;
+                    return true;
+                }
+                return false;
+            }
+
+            bool done() {
+                skip();
+                return pos == in.size();
+            }
+
+            NodePtr expr() {
+                NodePtr a = conj();
+                while ( a && accept("||") ) {
+                    NodePtr b = conj();
+                    if ( !b )
+                        return b;
+                    a.reset( new Binary( Binary::Or, a, b ) );
+                }
+                return a;
+            }
+
+            NodePtr conj() {
+                NodePtr a = unary();
+                while ( a && accept("&&") ) {
+                    NodePtr b = unary();
+                    if ( !b )
+                        return b;
+                    a.reset( new Binary( Binary::And, a, b ) );
+                }
+                return a;
+            }
+
+            NodePtr unary() {
+                if ( accept("!") ) {
+                    NodePtr a = unary();
+                    return a ? NodePtr( new Not(a) ) : a;
+                }
+                if ( accept("(") ) {
+                    NodePtr a = expr();
+                    if ( a && !accept(")") ) {
+                        error = "expected ')'";
+                        return NodePtr();
+                    }
+                    return a;
+                }
+                if ( accept("changed(") ) {
+                    NodePtr c = column();
+                    if ( c && !accept(")") ) {
+                        error = "expected ')' after changed(column";
+                        return NodePtr();
+                    }
+                    return c ? NodePtr( new Changed(c) ) : c;
+                }
+                NodePtr a = operand();
+                if ( !a )
+                    return a;
+                Binary::Op op;
+                if ( accept("<=") ) op = Binary::Le;
+                else if ( accept(">=") ) op = Binary::Ge;
+                else if ( accept("==") ) op = Binary::Eq;
+                else if ( accept("!=") ) op = Binary::Ne;
+                else if ( accept("<") ) op = Binary::Lt;
+                else if ( accept(">") ) op = Binary::Gt;
+                else
+                    return a;
+                NodePtr b = operand();
+                return b ? NodePtr( new Binary( op, a, b ) ) : b;
+            }
+
+            NodePtr operand() {
+                skip();
+                if ( pos < in.size() && ( isdigit( in[pos] ) || in[pos] == '-' || in[pos] == '+' || in[pos] == '.' ) ) {
+                    const char* begin = in.c_str() + pos;
+                    char* end;
+                    double v = strtod( begin, &end );
+                    if ( end == begin ) {
+                        error = "invalid number '" + in.substr(pos) + "'";
+                        return NodePtr();
+                    }
+                    pos += end - begin;
+                    return NodePtr( new Constant(v) );
+                }
+                return column();
+            }
+
+            NodePtr column() {
+                skip();
+                string::size_type start = pos;
+                while ( pos < in.size() && ( isalnum( in[pos] ) || in[pos] == '_' || in[pos] == '.' ) )
+                    ++pos;
+                if ( start == pos ) {
+                    error = "expected a column name at '" + in.substr(pos) + "'";
+                    return NodePtr();
+                }
+                string name = in.substr(start, pos - start);
+                base::PropertyBase* leaf = findColumn( report, name );
+                if ( !leaf || dynamic_cast< Property<PropertyBag>* >( leaf ) ) {
+                    error = "no column '" + name + "' in the report";
+                    return NodePtr();
+                }
+                base::DataSourceBase::shared_ptr dsb = leaf->getDataSource();
+                NodePtr n;
+                if ( !n ) n = tryColumn<double>( dsb );
+                if ( !n ) n = tryColumn<float>( dsb );
+                if ( !n ) n = tryColumn<int>( dsb );
+                if ( !n ) n = tryColumn<unsigned int>( dsb );
+                if ( !n ) n = tryColumn<char>( dsb );
+                if ( !n ) n = tryColumn<bool>( dsb );
+                if ( !n )
+                    error = "column '" + name + "' of type " + dsb->getTypeName() + " is not numeric";
+                return n;
+            }
+        };
+    }
+
+    bool ReportTrigger::compile( const std::string& expr, const PropertyBag& report )
+    {
+        Logger::In in("ReportTrigger");
+        Parser parser( expr, report );
+        mroot = parser.expr();
+        if ( mroot && !parser.done() ) {
+            parser.error = "unexpected trailing characters";
+            mroot.reset();
+        }
+        if ( !mroot ) {
+            log(Error) << "Invalid trigger expression '" << expr << "': " << parser.error << endlog();
+            return false;
+        }
+        return true;
+    }
+
+    bool ReportTrigger::evaluate()
+    {
+        return mroot && mroot->value() != 0.0;
+    }
+}
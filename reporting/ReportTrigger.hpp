@@ -0,0 +1,84 @@
+/***************************************************************************
+
+        ReportTrigger.hpp -  trigger expressions over report columns
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ORO_COMP_REPORT_TRIGGER_HPP
+#define ORO_COMP_REPORT_TRIGGER_HPP
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <rtt/PropertyBag.hpp>
+
+#include <ocl/OCL.hpp>
+
+namespace OCL
+{
+    /**
+     * A boolean expression over the columns of a report, used by the
+     * ReportingComponent to open reporting windows. A column is named as
+     * in the report header, for example \c Comp.Port or \c Comp.Port.2
+     * for the third element of a sequence. The grammar is:
+     *
+     * @verbatim
+     expr    := and ( '||' and )*
+     and     := unary ( '&&' unary )*
+     unary   := '!' unary | '(' expr ')' | 'changed(' column ')' | operand [ cmp operand ]
+     cmp     := '<' | '<=' | '>' | '>=' | '==' | '!='
+     operand := number | column
+     @endverbatim
+     *
+     * A lone operand is true when it is not zero. \c changed(column) is
+     * true when the column differs from its value at the previous
+     * evaluation. Columns must be numeric (double, float, int, unsigned
+     * int, char or bool).
+     *
+     * Evaluation reads the sampled values of the report and does not
+     * allocate.
+     */
+    class OCL_API ReportTrigger
+    {
+    public:
+        struct Node;
+        typedef boost::shared_ptr<Node> NodePtr;
+
+        /**
+         * Compile \a expr against the columns in \a report. The report
+         * must outlive this object.
+         * Logs an error and returns false if the expression can not be
+         * parsed or refers to an unknown or non-numeric column.
+         */
+        bool compile( const std::string& expr, const RTT::PropertyBag& report );
+
+        /**
+         * Evaluates the compiled expression on the current samples.
+         * Returns false if nothing was compiled.
+         */
+        bool evaluate();
+
+    private:
+        NodePtr mroot;
+    };
+}
+
+#endif
@@ -30,6 +30,7 @@
 
 // Impl.
 #include "EmptyMarshaller.hpp"
+#include "ReportTrigger.hpp"
 #include <rtt/marsh/PropertyDemarshaller.hpp>
 #include <rtt/marsh/PropertyMarshaller.hpp>
 #include <iostream>
@@ -178,6 +179,45 @@ namespace OCL
         return true;
     }
 
+    namespace
+    {
+        /**
+         * Collects the leaves of a report in depth-first order.
+         */
+        void collectLeaves( const PropertyBag& bag, vector<PropertyBase*>& leaves )
+        {
+            for (PropertyBag::const_iterator it = bag.getProperties().begin(); it != bag.getProperties().end(); ++it) {
+                Property<PropertyBag>* sub = dynamic_cast< Property<PropertyBag>* >( *it );
+                if ( sub )
+                    collectLeaves( sub->rvalue(), leaves );
+                else
+                    leaves.push_back( *it );
+            }
+        }
+
+        /**
+         * Makes a copy of a report in which each leaf owns its value,
+         * and collects the leaves in the same order as collectLeaves().
+         */
+        void cloneReport( const PropertyBag& source, PropertyBag& target, vector<PropertyBase*>& leaves )
+        {
+            target.setType( source.getType() );
+            for (PropertyBag::const_iterator it = source.getProperties().begin(); it != source.getProperties().end(); ++it) {
+                Property<PropertyBag>* sub = dynamic_cast< Property<PropertyBag>* >( *it );
+                if ( sub ) {
+                    Property<PropertyBag>* copy = new Property<PropertyBag>( sub->getName(), sub->getDescription() );
+                    cloneReport( sub->rvalue(), copy->value(), leaves );
+                    target.ownProperty( copy );
+                } else {
+                    PropertyBase* copy = (*it)->create();
+                    copy->update( *it );
+                    target.ownProperty( copy );
+                    leaves.push_back( copy );
+                }
+            }
+        }
+    }
+
   ReportingComponent::ReportingComponent( std::string name /*= "Reporting" */ )
         : TaskContext( name ),
           report("Report"), snapshotted(false),
@@ -189,7 +229,13 @@ namespace OCL
           report_policy( ConnPolicy::data(ConnPolicy::LOCK_FREE,true,false) ),
           onlyNewData(false),
           starttime(0),
-          timestamp("TimeStamp","The time at which the data was read.",0.0)
+          timestamp("TimeStamp","The time at which the data was read.",0.0),
+          trigger_expr("Trigger","An expression over the reported columns, for example 'Comp.Force.2 > 10 || changed(Comp.State)'. When set, data is only written out in windows around the moments it is true.",""),
+          pre_trigger("PreTrigger","Seconds of data written out before a trigger.",1.0),
+          post_trigger("PostTrigger","Seconds of data written out after the last trigger.",1.0),
+          trigger_history("TriggerHistory","Number of samples kept for the PreTrigger window. Zero computes it from the period of this component.",0),
+          triggered(false),
+          window_end(-1.0), history_head(0), history_count(0)
     {
         this->provides()->doc("Captures data on data ports. A periodic reporter will sample each added port according to its period, a non-periodic reporter will write out data as it comes in, or only during a snapshot() if the Snapshot property is true.");
 
@@ -200,6 +246,10 @@ namespace OCL
         this->properties()->addProperty( report_data);
         this->properties()->addProperty( "ReportPolicy", report_policy).doc("The ConnPolicy for the reporter's port connections.");
         this->properties()->addProperty( "ReportOnlyNewData", onlyNewData).doc("Turn on in order to only write out NewData on ports and omit unchanged ports. Turn off in order to sample and write out all ports (even old data).");
+        this->properties()->addProperty( trigger_expr );
+        this->properties()->addProperty( pre_trigger );
+        this->properties()->addProperty( post_trigger );
+        this->properties()->addProperty( trigger_history );
         // Add the methods, methods make sure that they are
         // executed in the context of the (non realtime) caller.
 
@@ -555,9 +605,16 @@ namespace OCL
             starttime = os::TimeService::Instance()->getTicks();
 
         // Get initial data samples
+        triggered = !trigger_expr.value().empty();
         this->copydata();
         this->makeReport2();
 
+        if ( triggered && !mtrigger ) {
+            cleanReport();
+            return false;
+        }
+        window_end = -1.0;
+
         // write headers
         if (writeHeader.get()) {
             // call all header marshallers.
@@ -568,7 +625,7 @@ namespace OCL
         }
 
         // write initial values with all value marshallers (uses the forcing above)
-        if ( getActivity()->isPeriodic() ) {
+        if ( getActivity()->isPeriodic() && !mtrigger ) {
             for(Marshallers::iterator it=marshallers.begin(); it != marshallers.end(); ++it) {
                 it->second->serialize( report );
                 it->second->flush();
@@ -642,12 +699,105 @@ namespace OCL
 
         }
         mchecker = checker;
+        setupTrigger();
+    }
+
+    bool ReportingComponent::setupTrigger()
+    {
+        Logger::In in("ReportingComponent");
+        clearTrigger();
+        if ( trigger_expr.value().empty() )
+            return true;
+        mtrigger.reset( new ReportTrigger() );
+        if ( !mtrigger->compile( trigger_expr.value(), report ) ) {
+            mtrigger.reset();
+            return false;
+        }
+
+        int size = trigger_history.value();
+        if ( size <= 0 && pre_trigger.value() > 0.0 ) {
+            if ( getActivity() && getActivity()->isPeriodic() )
+                size = int( pre_trigger.value() / getActivity()->getPeriod() ) + 1;
+            else {
+                size = 1000;
+                log(Warning) << "Not periodic and no TriggerHistory set: keeping " << size << " samples before a trigger." << endlog();
+            }
+        }
+        collectLeaves( report, report_leaves );
+        history.resize( size );
+        history_leaves.resize( size );
+        history_stamps.resize( size, 0.0 );
+        for (int i = 0; i != size; ++i) {
+            history[i] = new PropertyBag();
+            cloneReport( report, *history[i], history_leaves[i] );
+        }
+        log(Info) << "Trigger '" << trigger_expr.value() << "' with a history of " << size << " samples." << endlog();
+        return true;
+    }
+
+    void ReportingComponent::clearTrigger()
+    {
+        for (vector<PropertyBag*>::iterator it = history.begin(); it != history.end(); ++it) {
+            deletePropertyBag( **it );
+            delete *it;
+        }
+        history.clear();
+        history_leaves.clear();
+        history_stamps.clear();
+        report_leaves.clear();
+        history_head = history_count = 0;
+        mtrigger.reset();
+    }
+
+    bool ReportingComponent::triggerWindow()
+    {
+        os::TimeService::Seconds now = timestamp.rvalue();
+        if ( mtrigger->evaluate() ) {
+            if ( now > window_end )
+                writeHistory( now - pre_trigger.rvalue() );
+            window_end = now + post_trigger.rvalue();
+        }
+        if ( now <= window_end )
+            return true;
+
+        // outside a window: store the sample in the history.
+        if ( history.empty() )
+            return false;
+        unsigned int slot;
+        if ( history_count == history.size() ) {
+            slot = history_head;
+            history_head = (history_head + 1) % history.size();
+        } else {
+            slot = (history_head + history_count) % history.size();
+            ++history_count;
+        }
+        vector<PropertyBase*>& leaves = history_leaves[slot];
+        for (unsigned int i = 0; i != leaves.size(); ++i)
+            leaves[i]->refresh( report_leaves[i] );
+        history_stamps[slot] = now;
+        return false;
+    }
+
+    void ReportingComponent::writeHistory( os::TimeService::Seconds since )
+    {
+        for (unsigned int i = 0; i != history_count; ++i) {
+            unsigned int slot = (history_head + i) % history.size();
+            if ( history_stamps[slot] < since )
+                continue;
+            for(Marshallers::iterator it=marshallers.begin(); it != marshallers.end(); ++it) {
+                it->second->serialize( *history[slot] );
+                it->second->flush();
+            }
+        }
+        history_head = history_count = 0;
     }
-        
+
     void ReportingComponent::cleanReport()
     {
         // Only clones were added to result, so delete them.
         deletePropertyBag( report );
+        // the history refers to the report.
+        clearTrigger();
     }
 
     void ReportingComponent::updateHook() {
@@ -662,10 +812,16 @@ namespace OCL
         if ( mchecker && mchecker->get() == false ) {
             cleanReport();
             makeReport2();
+            if ( triggered && !mtrigger )
+                log(Error) << "The Trigger does not compile for the resized report: no data is written out until it does." << endlog();
         } else
             copydata();
 
         do {
+            // In triggered mode, samples outside a window go to the history,
+            // and nothing is written out without a compiled trigger.
+            if ( triggered && (!mtrigger || !triggerWindow()) )
+                continue;
             // Step 3: print out the result
             // write out to all marshallers
             for(Marshallers::iterator it=marshallers.begin(); it != marshallers.end(); ++it) {
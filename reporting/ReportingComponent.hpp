@@ -30,6 +30,7 @@
 
 
 #include <boost/tuple/tuple.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <rtt/Property.hpp>
 #include <rtt/PropertyBag.hpp>
@@ -43,6 +44,8 @@
 
 namespace OCL
 {
+    class ReportTrigger;
+
     /**
      * @brief A Component for periodically reporting Component
      * Port contents to a human readable text format. The
@@ -77,6 +80,15 @@ namespace OCL
      </properties>
      @endcode
      *
+     * @par Triggered reporting
+     * When the Trigger property holds an expression over the reported
+     * columns (see ReportTrigger), samples are only written out in
+     * windows around the moments the expression is true. Such a window
+     * starts PreTrigger seconds before the trigger and ends PostTrigger
+     * seconds after the last sample on which the expression was true.
+     * Samples outside a window are kept in a history buffer which is
+     * allocated when the report is built, and are dropped when they
+     * get older than PreTrigger.
      */
     class OCL_API ReportingComponent
         : public RTT::TaskContext
@@ -219,6 +231,31 @@ namespace OCL
 
         void makeReport2();
 
+        /**
+         * Compiles the trigger expression and allocates the history
+         * for the current report. Called by makeReport2().
+         * @return false if the expression is invalid.
+         */
+        bool setupTrigger();
+
+        /**
+         * Deletes the trigger and its history.
+         */
+        void clearTrigger();
+
+        /**
+         * Evaluates the trigger on the last copied sample.
+         * @return true if the sample lies within a reporting window and
+         * must be written out, false if it was stored in the history.
+         */
+        bool triggerWindow();
+
+        /**
+         * Writes out all samples in the history which are not older
+         * than \a since and empties the history.
+         */
+        void writeHistory( RTT::os::TimeService::Seconds since );
+
         /**
          * This not real-time function processes the copied data.
          */
@@ -249,6 +286,27 @@ namespace OCL
         //! If false, a sequence size has changed.
         RTT::internal::DataSource<bool>::shared_ptr mchecker;
 
+        RTT::Property<std::string>   trigger_expr;
+        RTT::Property<RTT::os::TimeService::Seconds> pre_trigger;
+        RTT::Property<RTT::os::TimeService::Seconds> post_trigger;
+        RTT::Property<int>           trigger_history;
+        //! True when started with a Trigger, also while mtrigger could not be compiled.
+        bool triggered;
+        boost::shared_ptr<ReportTrigger> mtrigger;
+        //! End of the current reporting window, in seconds since starttime.
+        RTT::os::TimeService::Seconds window_end;
+        /**
+         * The trigger history is a ring of deep copies of the report.
+         * The leaves of each copy are refreshed from report_leaves,
+         * which all have the same layout.
+         */
+        std::vector<RTT::PropertyBag*> history;
+        std::vector< std::vector<RTT::base::PropertyBase*> > history_leaves;
+        std::vector<RTT::os::TimeService::Seconds> history_stamps;
+        std::vector<RTT::base::PropertyBase*> report_leaves;
+        unsigned int history_head;
+        unsigned int history_count;
+
     };
 
 }
@@ -225,7 +225,9 @@ namespace OCL
 
     const RTT::PropertyBag* TcpReporting::getReport()
     {
-        makeReport2();
+        // the report is built in startHook() while running.
+        if ( report.empty() )
+            makeReport2();
         return &report;
     }
 
@@ -104,6 +104,13 @@ namespace OCL
        - \b Receive:
          - if succesfull: \verbatim "302 DataNameX\n" \endverbatim
          - if failed:     \verbatim "301 DataNameX\n" \endverbatim
+       .
+       Instead of an exact name, a prefix ending with '*' (for example
+       \verbatim "SUBSCRIBE MyPeer.*\n" \endverbatim) or a shell wildcard
+       pattern such as \verbatim "SUBSCRIBE *.D?Port\n" \endverbatim can be
+       given. It subscribes to all data whose name matches, including data
+       that is added later on. It fails if nothing matches at the time of
+       subscribing.
 
        \subsection unsubscribe Unsubscribe to Data:
        The client can cancel a subscription.
@@ -135,6 +142,21 @@ namespace OCL
        - \b Receive:
          \verbatim "107 SILENCE ON/OFF\n" \endverbatim
 
+       \subsection setrate Limit the frame rate:
+       The client can ask the server to send at most a given number of
+       frames per second. Frames in between are skipped on the server.
+       - \b Send:
+         -Latest value:  \verbatim "SETRATE 10\n" \endverbatim
+         -Decimated:     \verbatim "SETRATE 10 DECIMATE\n" \endverbatim
+         -No limit:      \verbatim "SETRATE 0\n" \endverbatim
+       - \b Receive:
+         \verbatim "101 OK\n" \endverbatim
+       .
+       In LATEST mode (the default), the first frame after each period is
+       sent. In DECIMATE mode, every N-th frame is sent, where N follows
+       from the period of the reporter. A non-periodic reporter always
+       uses LATEST mode.
+
        \subsection quit Close the connection with the server:
        The client can close the connection with the server.
        - \b Send:
@@ -26,7 +26,7 @@
 
 #include <algorithm> /* std::transform is needed for upper-case conversion */
 #include <string>
-#include <cstdlib> /* strtoull */
+#include <cstdlib> /* strtoull, strtod */
 #include <cctype>
 #include <cerrno>
 #include <rtt/Property.hpp>
@@ -270,6 +270,44 @@ namespace
             }
     };
 
+    /**
+     * Limit the rate at which frames are sent to this client.
+     */
+    class SetRateCommand : public RealCommand
+    {
+        protected:
+            void maincode( int argc, std::string* args )
+            {
+                char* tailptr;
+                double rate = strtod( args[0].c_str(), &tailptr );
+                if( args[0].empty() || *tailptr != '\0' || rate < 0.0 )
+                {
+                    sendError102();
+                    return;
+                }
+                bool latest = true;
+                if( argc == 2 )
+                {
+                    toupper( args, 1 );
+                    if( args[1] == "DECIMATE" )
+                    {
+                        latest = false;
+                    } else if( args[1] != "LATEST" ) {
+                        sendError102();
+                        return;
+                    }
+                }
+                _parent->getConnection()->setRate(rate, latest);
+                sendOK();
+            }
+
+        public:
+            SetRateCommand(TcpReportingInterpreter* parent)
+            : RealCommand( "SETRATE", parent, 1, 2, "<frequency | 0> [LATEST | DECIMATE]" )
+            {
+            }
+    };
+
     /**
      * Disable/enable output of data on the socket.
      */
@@ -319,7 +357,7 @@ namespace
 
         public:
             SubscribeCommand(TcpReportingInterpreter* parent)
-            : RealCommand( "SUBSCRIBE", parent, 1, 1, "<source name>" )
+            : RealCommand( "SUBSCRIBE", parent, 1, 1, "<source name | prefix* | pattern>" )
             {
             }
     };
@@ -667,6 +705,7 @@ namespace TCP
         addCommand( new HeaderCommand(this) );
         addCommand( new SilenceCommand(this) );
         addCommand( new SetLimitCommand(this) );
+        addCommand( new SetRateCommand(this) );
         addCommand( new SubscribeCommand(this) );
         addCommand( new UnsubscribeCommand(this) );
         addCommand( new SubscriptionsCommand(this) );
@@ -26,6 +26,7 @@
  ***************************************************************************/
 
 #include <vector>
+#include <fnmatch.h>
 #include <rtt/Logger.hpp>
 #include <rtt/os/Mutex.hpp>
 #include <rtt/Property.hpp>
@@ -37,6 +38,32 @@
 #include "TcpReporting.hpp"
 #include <rtt/types/TemplateTypeInfo.hpp>
 
+namespace
+{
+    /**
+     * Returns true if \a name contains wildcard characters.
+     */
+    bool isPattern( const std::string& name )
+    {
+        return name.find_first_of("*?[") != std::string::npos;
+    }
+
+    /**
+     * Match a source name against an exact name, a 'prefix*' or
+     * a wildcard pattern.
+     */
+    bool matchSubscription( const std::string& sub, const std::string& name )
+    {
+        std::string::size_type wc = sub.find_first_of("*?[");
+        if ( wc == std::string::npos )
+            return sub == name;
+        // fast path for plain prefixes
+        if ( wc == sub.size() - 1 && sub[wc] == '*' )
+            return name.compare(0, wc, sub, 0, wc) == 0;
+        return fnmatch( sub.c_str(), name.c_str(), 0 ) == 0;
+    }
+}
+
 namespace OCL
 {
 namespace TCP
@@ -46,6 +73,10 @@ namespace TCP
     {
         limit = 0;
         curframe = 0;
+        maxrate = 0.0;
+        decimation = 0;
+        inframe = 0;
+        lastsent = 0;
         reporter = marshaller->getReporter();
         silenced = true;
         interpreter = new TcpReportingInterpreter(this);
@@ -93,8 +124,17 @@ namespace TCP
     {
         lock.lock();
         log(Debug)<<"Datasender::addSubscription: "<<name<<endlog();
-        //Check if a property is available with that name?
-        if(reporter->getReport()->find(name)!=NULL){
+        //Check if a property is available with that name or matching that pattern?
+        bool available = false;
+        const PropertyBag* report = reporter->getReport();
+        if ( isPattern(name) ) {
+            for (PropertyBag::const_iterator it = report->getProperties().begin();
+                 !available && it != report->getProperties().end(); ++it)
+                available = matchSubscription( name, (*it)->getName() );
+        } else
+            available = report->find(name) != NULL;
+
+        if(available){
             //check if subscription already exists
             std::vector<std::string>::const_iterator pos =
                 find(subscriptions.begin(),subscriptions.end(),name);
@@ -176,22 +216,34 @@ namespace TCP
     }
 
 
+    bool Datasender::isSubscribed(const std::string& name) const
+    {
+        for(std::vector<std::string>::const_iterator elem = subscriptions.begin();
+            elem!=subscriptions.end();elem++)
+            if ( matchSubscription(*elem, name) )
+                return true;
+        return false;
+    }
+
     void Datasender::checkbag(const PropertyBag &v)
     {
         log(Debug)<<"Let's check the subscriptions"<<endlog();
+        // exact subscriptions are dropped when their source disappears,
+        // patterns stay since they may match sources added later.
         for(std::vector<std::string>::iterator elem = subscriptions.begin();
-            elem!=subscriptions.end();elem++){
-            base::PropertyBase* prop = reporter->getReport()->find(*elem);
-            if(prop!=NULL){
-                writeOut(prop);
-            }else{
+            elem!=subscriptions.end();){
+            if( !isPattern(*elem) && v.find(*elem) == NULL ){
                 Logger::In("DataSender");
                 log(Error)<<*elem<<" not longer available for reporting,"<<
                     ", removing the subscription."<<endlog();
-                subscriptions.erase(elem);
-                elem--;
-            }
+                elem = subscriptions.erase(elem);
+            } else
+                ++elem;
         }
+        for (PropertyBag::const_iterator i = v.getProperties().begin();
+             i != v.getProperties().end(); i++ )
+            if ( isSubscribed( (*i)->getName() ) )
+                writeOut(*i);
     }
 
     void Datasender::silence(bool newstate)
@@ -204,6 +256,40 @@ namespace TCP
         limit = newlimit;
     }
 
+    void Datasender::setRate(double frequency, bool latest)
+    {
+        lock.lock();
+        maxrate = frequency;
+        decimation = 0;
+        inframe = 0;
+        lastsent = 0;
+        if ( maxrate > 0.0 && !latest ) {
+            double period = reporter->getActivity() ? reporter->getActivity()->getPeriod() : 0.0;
+            if ( period > 0.0 ) {
+                decimation = (unsigned long long)( 1.0 / (period * maxrate) + 0.5 );
+                if ( decimation == 0 )
+                    decimation = 1;
+            } else {
+                Logger::In("DataSender");
+                log(Info)<<"Reporter is not periodic: falling back to latest-value rate limiting."<<endlog();
+            }
+        }
+        lock.unlock();
+    }
+
+    bool Datasender::rateAllows()
+    {
+        if ( maxrate <= 0.0 )
+            return true;
+        if ( decimation != 0 )
+            return ( inframe++ % decimation ) == 0;
+        RTT::os::TimeService* ts = RTT::os::TimeService::Instance();
+        if ( lastsent != 0 && ts->secondsSince( lastsent ) < 1.0 / maxrate )
+            return false;
+        lastsent = ts->getTicks();
+        return true;
+    }
+
     void Datasender::serialize(const PropertyBag &v)
     {
         if( silenced ) {
@@ -211,7 +297,7 @@ namespace TCP
         }
 
         lock.lock();
-        if( !subscriptions.empty() && ( limit == 0 || curframe <= limit ) ){
+        if( !subscriptions.empty() && ( limit == 0 || curframe <= limit ) && rateAllows() ){
             *os << "201 " <<curframe << " -- begin of frame\n";
             checkbag(v);
             *os << "203 " << curframe << " -- end of frame" << std::endl;
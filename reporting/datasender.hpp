@@ -32,6 +32,7 @@
 #include <rtt/Activity.hpp>
 #include <rtt/os/Mutex.hpp>
 #include <rtt/Property.hpp>
+#include <rtt/os/TimeService.hpp>
 
 using RTT::os::Mutex;
 using RTT::base::PropertyBase;
@@ -65,6 +66,8 @@ namespace OCL{
             void checkbag(const PropertyBag &v);
             void writeOut(base::PropertyBase* v);
             void writeOut(const PropertyBag &v);
+            bool isSubscribed(const std::string& name) const;
+            bool rateAllows();
             Socket* os;
             OCL::TcpReporting* reporter;
             unsigned long long limit;
@@ -72,6 +75,13 @@ namespace OCL{
             bool silenced;
             RTT::SocketMarshaller* marshaller;
             std::vector<std::string> subscriptions;
+            /**
+             * Server side rate limiting, see setRate().
+             */
+            double maxrate;
+            unsigned long long decimation;
+            unsigned long long inframe;
+            RTT::os::TimeService::ticks lastsent;
 
         public:
             Datasender(RTT::SocketMarshaller* marshaller, Socket* os);
@@ -88,6 +98,19 @@ namespace OCL{
              */
             void setLimit(unsigned long long newlimit);
 
+            /**
+             * Only send frames to the client at at most \a frequency Hz.
+             * Frames that fall in between are dropped before being
+             * formatted.
+             * @param frequency The maximum frame rate. Zero disables
+             * rate limiting.
+             * @param latest If true, the first frame after each period
+             * has elapsed is sent, which is the latest value at that time.
+             * If false and the reporter is periodic, every N-th frame
+             * is sent, with N derived from the reporter's period.
+             */
+            void setRate(double frequency, bool latest);
+
             /**
              * Send data to the client.
              */
@@ -98,6 +121,11 @@ namespace OCL{
              */
             RTT::SocketMarshaller* getMarshaller() const;
 
+            /**
+             * Subscribe to a data source. \a name is either an exact
+             * source name, a prefix ending with '*' or a shell wildcard
+             * pattern (see fnmatch(3)) which matches one or more sources.
+             */
             bool addSubscription(const std::string name );
             bool removeSubscription( const std::string& name );
 
@@ -0,0 +1,154 @@
+/***************************************************************************
+
+          reportquery.cpp -  query recorded table reports by time
+                           -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 The Orocos developers
+
+ ***************************************************************************
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the Free Software   *
+ *   Foundation, Inc., 59 Temple Place,                                    *
+ *   Suite 330, Boston, MA  02111-1307  USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+/**
+ * @file reportquery.cpp
+ * Prints columns over a time range of a table report which was written
+ * by FileReporting with WriteIndex enabled, or indexed with --build-index.
+ *
+ * Usage: ocl-reportquery [options] report.dat
+ *   --columns A,B,..   Columns to print (default: all).
+ *   --from t0          Start of the time range, in seconds (default: start).
+ *   --to t1            End of the time range, in seconds (default: end).
+ *   --index file       Index file (default: report.dat.idx).
+ *   --build-index      (Re)build the index of the report and exit.
+ *   --block-rows n     Rows per index block for --build-index (default: 1000).
+ *   --list             List the columns and the time range of the report.
+ *   --stats            Print the number of rows and bytes scanned, and of rows
+ *                      skipped for values with spaces, to stderr.
+ */
+
+#include "ReportReader.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+using namespace OCL;
+
+namespace
+{
+    struct Printer : public ReportReader::RowHandler
+    {
+        unsigned long rows;
+        Printer() : rows(0) {}
+        void row( double time, const vector<string>& values )
+        {
+            cout << time;
+            for ( vector<string>::const_iterator it = values.begin(); it != values.end(); ++it )
+                cout << ' ' << *it;
+            cout << '\n';
+            ++rows;
+        }
+    };
+
+    void usage( const char* prog )
+    {
+        cerr << "Usage: " << prog << " [--columns A,B,..] [--from t0] [--to t1] [--index file]" << endl
+             << "       " << prog << " [--list] [--stats] report" << endl
+             << "       " << prog << " --build-index [--block-rows n] [--index file] report" << endl;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    string report, index;
+    vector<string> columns;
+    double t0 = -numeric_limits<double>::max();
+    double t1 = numeric_limits<double>::max();
+    bool build = false, list = false, stats = false;
+    unsigned int block_rows = 1000;
+
+    for ( int i = 1; i < argc; ++i ) {
+        string arg = argv[i];
+        bool hasvalue = i + 1 < argc;
+        if ( arg == "--columns" && hasvalue ) {
+            string cols = argv[++i];
+            string::size_type start = 0, comma;
+            do {
+                comma = cols.find( ',', start );
+                string name = cols.substr( start, comma == string::npos ? string::npos : comma - start );
+                if ( !name.empty() )
+                    columns.push_back( name );
+                start = comma + 1;
+            } while ( comma != string::npos );
+        } else if ( arg == "--from" && hasvalue ) {
+            t0 = strtod( argv[++i], 0 );
+        } else if ( arg == "--to" && hasvalue ) {
+            t1 = strtod( argv[++i], 0 );
+        } else if ( arg == "--index" && hasvalue ) {
+            index = argv[++i];
+        } else if ( arg == "--block-rows" && hasvalue ) {
+            block_rows = strtoul( argv[++i], 0, 10 );
+        } else if ( arg == "--build-index" ) {
+            build = true;
+        } else if ( arg == "--list" ) {
+            list = true;
+        } else if ( arg == "--stats" ) {
+            stats = true;
+        } else if ( arg[0] != '-' && report.empty() ) {
+            report = arg;
+        } else {
+            usage( argv[0] );
+            return 1;
+        }
+    }
+    if ( report.empty() ) {
+        usage( argv[0] );
+        return 1;
+    }
+
+    if ( build )
+        return ReportReader::buildIndex( report, block_rows, index ) ? 0 : 1;
+
+    ReportReader reader;
+    if ( !reader.open( report, index ) )
+        return 1;
+
+    if ( list ) {
+        cout << "Time range: " << reader.startTime() << " - " << reader.endTime() << endl;
+        for ( vector<string>::const_iterator it = reader.columns().begin(); it != reader.columns().end(); ++it )
+            cout << *it << endl;
+        return 0;
+    }
+
+    // the time stamp is always printed as the first column.
+    if ( columns.empty() && !reader.columns().empty() )
+        columns.assign( reader.columns().begin() + 1, reader.columns().end() );
+    cout << "# " << ( reader.columns().empty() ? string("TimeStamp") : reader.columns().front() );
+    for ( vector<string>::const_iterator it = columns.begin(); it != columns.end(); ++it )
+        cout << ' ' << *it;
+    cout << '\n';
+
+    Printer printer;
+    if ( !columns.empty() && !reader.query( columns, t0, t1, printer ) )
+        return 1;
+    cout.flush();
+    if ( stats )
+        cerr << printer.rows << " rows, " << reader.scannedBytes() << " bytes scanned, "
+             << reader.skippedRows() << " rows skipped." << endl;
+    return 0;
+}
@@ -0,0 +1,452 @@
+/**
+ * Load test for TcpReporting.
+ *
+ * Starts a TcpReporting component which reports a synthetic component at
+ * a fixed rate and forks a client process which connects N loopback
+ * clients speaking the TcpReporting protocol. The clients measure frame
+ * latency and missed frames, the server process measures its CPU usage.
+ *
+ * Usage: tcpbench [options]
+ *   --clients N        Number of clients (default 4)
+ *   --ports N          Number of synthetic double ports (default 10)
+ *   --rate HZ          Reporting rate of the server (default 1000)
+ *   --duration S       Measurement time in seconds (default 2)
+ *   --subscribe PAT    Subscription (name, prefix* or pattern) of every
+ *                      client, may be repeated (default Bench.Data*)
+ *   --client-rate HZ   Send SETRATE HZ for every client (default none)
+ *   --decimate         Use SETRATE HZ DECIMATE instead of LATEST
+ *   --slow N           Number of clients that are slow readers (default 0)
+ *   --slow-delay MS    Sleep time of a slow reader per frame (default 10)
+ *   --late MS          Frames with a higher latency are late (default 2 periods)
+ *   --tcp-port P       Port of the server (default 3142)
+ *
+ * The Bench.Stamp port carries the write time in microseconds since the
+ * start of the benchmark, hence durations are limited to about half an hour.
+ */
+#include <rtt/os/main.h>
+#include <reporting/TcpReporting.hpp>
+
+#include <rtt/extras/SlaveActivity.hpp>
+#include <rtt/Port.hpp>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+
+namespace
+{
+    struct BenchConfig
+    {
+        int clients;
+        int ports;
+        double rate;
+        double duration;
+        vector<string> subscriptions;
+        double client_rate;
+        bool decimate;
+        int slow;
+        int slow_delay_ms;
+        double late_ms;
+        unsigned short tcp_port;
+    };
+
+    /** Start of the benchmark, shared by server and client process. */
+    struct timespec t0;
+
+    double now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (ts.tv_sec - t0.tv_sec) + (ts.tv_nsec - t0.tv_nsec) * 1e-9;
+    }
+
+    void sleepUntil(double t)
+    {
+        struct timespec ts = t0;
+        long long ns = ts.tv_nsec + (long long)(t * 1e9);
+        ts.tv_sec += ns / 1000000000LL;
+        ts.tv_nsec = ns % 1000000000LL;
+        while ( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) != 0 )
+            ;
+    }
+
+    /**
+     * Minimal line reader on a blocking socket.
+     */
+    class LineSocket
+    {
+        int fd;
+        char buf[65536];
+        size_t begin, end;
+    public:
+        LineSocket() : fd(-1), begin(0), end(0) {}
+        ~LineSocket() { if (fd >= 0) ::close(fd); }
+
+        bool connect(unsigned short port, double timeout)
+        {
+            double deadline = now() + timeout;
+            while ( now() < deadline ) {
+                fd = ::socket(PF_INET, SOCK_STREAM, 0);
+                struct sockaddr_in addr;
+                memset(&addr, 0, sizeof(addr));
+                addr.sin_family = AF_INET;
+                addr.sin_port = htons(port);
+                addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                if ( ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0 ) {
+                    struct timeval tv = { 1, 0 };
+                    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+                    return true;
+                }
+                ::close(fd);
+                fd = -1;
+                usleep(50000);
+            }
+            return false;
+        }
+
+        bool send(const string& line)
+        {
+            string l = line + "\n";
+            return ::send(fd, l.c_str(), l.size(), MSG_NOSIGNAL) == (ssize_t)l.size();
+        }
+
+        bool readLine(string& line)
+        {
+            for (;;) {
+                char* nl = (char*)memchr(buf + begin, '\n', end - begin);
+                if ( nl ) {
+                    line.assign(buf + begin, nl - (buf + begin));
+                    begin = nl - buf + 1;
+                    return true;
+                }
+                if ( begin > 0 ) {
+                    memmove(buf, buf + begin, end - begin);
+                    end -= begin;
+                    begin = 0;
+                }
+                if ( end == sizeof(buf) )
+                    end = 0; // line too long: drop it.
+                ssize_t r = ::recv(fd, buf + end, sizeof(buf) - end, 0);
+                if ( r <= 0 )
+                    return false;
+                end += r;
+            }
+        }
+
+        /**
+         * Read until a reply line with the given code prefix arrives,
+         * skipping streamed frame lines (2xx).
+         */
+        bool expect(const char* code)
+        {
+            string line;
+            while ( readLine(line) ) {
+                if ( line.compare(0, strlen(code), code) == 0 )
+                    return true;
+                if ( line.empty() || line[0] != '2' ) {
+                    fprintf(stderr, "tcpbench: unexpected reply '%s', expected %s\n", line.c_str(), code);
+                    return false;
+                }
+            }
+            return false;
+        }
+    };
+
+    struct ClientResult
+    {
+        int id;
+        const BenchConfig* cfg;
+        bool slow;
+        bool ok;
+        unsigned long long frames;
+        unsigned long long missed;
+        unsigned long long late;
+        unsigned long long bytes;
+        vector<double> latencies;
+    };
+
+    void* clientMain(void* arg)
+    {
+        ClientResult* res = static_cast<ClientResult*>(arg);
+        const BenchConfig& cfg = *res->cfg;
+        res->ok = false;
+        LineSocket sock;
+        if ( !sock.connect(cfg.tcp_port, 10.0) ) {
+            fprintf(stderr, "tcpbench: client %d could not connect.\n", res->id);
+            return 0;
+        }
+        if ( !sock.expect("100") || !sock.send("VERSION 1.0") || !sock.expect("101") )
+            return 0;
+        if ( cfg.client_rate > 0 ) {
+            ostringstream cmd;
+            cmd << "SETRATE " << cfg.client_rate << (cfg.decimate ? " DECIMATE" : " LATEST");
+            if ( !sock.send(cmd.str()) || !sock.expect("101") )
+                return 0;
+        }
+        vector<string> subs = cfg.subscriptions;
+        subs.insert(subs.begin(), "Bench.Seq");
+        subs.insert(subs.begin(), "Bench.Stamp");
+        for (size_t i = 0; i != subs.size(); ++i) {
+            if ( !sock.send("SUBSCRIBE " + subs[i]) || !sock.expect("302") ) {
+                fprintf(stderr, "tcpbench: client %d could not subscribe to %s.\n", res->id, subs[i].c_str());
+                return 0;
+            }
+        }
+
+        res->ok = true;
+        res->frames = res->missed = res->late = res->bytes = 0;
+        res->latencies.reserve( (size_t)(cfg.rate * cfg.duration) + 1 );
+
+        double warmup = 0.5, stop = warmup + cfg.duration;
+        double period = 1.0 / cfg.rate;
+        double late = cfg.late_ms > 0 ? cfg.late_ms * 1e-3 : 2 * period;
+        string line, current;
+        long stamp = -1, seq = -1, lastseq = -1;
+        while ( now() < stop + 1.0 && sock.readLine(line) ) {
+            res->bytes += line.size() + 1;
+            if ( line.compare(0, 4, "202 ") == 0 )
+                current = line.substr(4);
+            else if ( line.compare(0, 4, "205 ") == 0 ) {
+                if ( current == "Bench.Stamp" )
+                    stamp = atol(line.c_str() + 4);
+                else if ( current == "Bench.Seq" )
+                    seq = atol(line.c_str() + 4);
+            }
+            else if ( line.compare(0, 4, "203 ") == 0 ) {
+                double t = now();
+                if ( t >= warmup && stamp >= 0 && stamp * 1e-6 < stop ) {
+                    double lat = t - stamp * 1e-6;
+                    res->latencies.push_back(lat);
+                    ++res->frames;
+                    if ( lat > late )
+                        ++res->late;
+                    if ( lastseq >= 0 && seq > lastseq + 1 )
+                        res->missed += seq - lastseq - 1;
+                }
+                lastseq = seq;
+                stamp = seq = -1;
+                if ( res->slow )
+                    usleep( cfg.slow_delay_ms * 1000 );
+            }
+        }
+        sock.send("QUIT");
+        return 0;
+    }
+
+    double percentile(const vector<double>& sorted, double p)
+    {
+        if ( sorted.empty() )
+            return 0.0;
+        size_t i = (size_t)( p / 100.0 * (sorted.size() - 1) + 0.5 );
+        return sorted[i];
+    }
+
+    int runClients(const BenchConfig& cfg)
+    {
+        vector<ClientResult> results(cfg.clients);
+        vector<pthread_t> threads(cfg.clients);
+        for (int i = 0; i != cfg.clients; ++i) {
+            results[i].id = i;
+            results[i].cfg = &cfg;
+            results[i].slow = i < cfg.slow;
+            pthread_create(&threads[i], 0, &clientMain, &results[i]);
+        }
+        vector<double> all;
+        unsigned long long frames = 0, missed = 0, late = 0, bytes = 0;
+        int failed = 0;
+        for (int i = 0; i != cfg.clients; ++i) {
+            pthread_join(threads[i], 0);
+            ClientResult& r = results[i];
+            if ( !r.ok ) {
+                ++failed;
+                continue;
+            }
+            sort(r.latencies.begin(), r.latencies.end());
+            printf("client %3d%s: %8llu frames %8llu missed %8llu late  p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",
+                   r.id, r.slow ? " (slow)" : "       ", r.frames, r.missed, r.late,
+                   percentile(r.latencies, 50) * 1e3, percentile(r.latencies, 99) * 1e3,
+                   percentile(r.latencies, 100) * 1e3);
+            all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+            frames += r.frames; missed += r.missed; late += r.late; bytes += r.bytes;
+        }
+        sort(all.begin(), all.end());
+        printf("\nclients: %d ok, %d failed\n", cfg.clients - failed, failed);
+        printf("frames received: %llu (%.1f frames/s per client), %.2f MB/s total\n",
+               frames, cfg.clients - failed ? frames / cfg.duration / (cfg.clients - failed) : 0.0,
+               bytes / cfg.duration / 1e6);
+        printf("frames missed: %llu (includes frames skipped by SETRATE)\n", missed);
+        printf("frames late: %llu\n", late);
+        printf("latency ms: p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+               percentile(all, 50) * 1e3, percentile(all, 90) * 1e3, percentile(all, 99) * 1e3,
+               percentile(all, 99.9) * 1e3, percentile(all, 100) * 1e3);
+        fflush(stdout);
+        return failed ? 1 : 0;
+    }
+
+    /**
+     * The synthetic component of which all ports are reported.
+     */
+    class BenchComponent
+        : public TaskContext
+    {
+    public:
+        OutputPort<int> stamp;
+        OutputPort<int> seq;
+        vector<OutputPort<double>*> data;
+
+        BenchComponent(int nports)
+            : TaskContext("Bench"), stamp("Stamp"), seq("Seq")
+        {
+            this->ports()->addPort( stamp );
+            this->ports()->addPort( seq );
+            stamp.setDataSample( 0 );
+            seq.setDataSample( 0 );
+            for (int i = 0; i != nports; ++i) {
+                ostringstream name;
+                name << "Data" << i;
+                data.push_back( new OutputPort<double>( name.str() ) );
+                data.back()->setDataSample( 0.0 );
+                this->ports()->addPort( *data.back() );
+            }
+        }
+
+        ~BenchComponent()
+        {
+            for (size_t i = 0; i != data.size(); ++i) {
+                this->ports()->removePort( data[i]->getName() );
+                delete data[i];
+            }
+        }
+
+        void write(int n)
+        {
+            for (size_t i = 0; i != data.size(); ++i)
+                data[i]->write( n + 0.001 * i );
+            seq.write( n );
+            stamp.write( (int)( now() * 1e6 ) );
+        }
+    };
+
+    double cpuSeconds()
+    {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6
+            + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+    }
+}
+
+int ORO_main( int argc, char** argv)
+{
+    BenchConfig cfg;
+    cfg.clients = 4;
+    cfg.ports = 10;
+    cfg.rate = 1000.0;
+    cfg.duration = 2.0;
+    cfg.client_rate = 0.0;
+    cfg.decimate = false;
+    cfg.slow = 0;
+    cfg.slow_delay_ms = 10;
+    cfg.late_ms = 0.0;
+    cfg.tcp_port = 3142;
+
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i+1] : 0;
+        if ( a == "--decimate" ) { cfg.decimate = true; continue; }
+        if ( !v ) {
+            cerr << "Missing value for option " << a << endl;
+            return 1;
+        }
+        ++i;
+        if ( a == "--clients" ) cfg.clients = atoi(v);
+        else if ( a == "--ports" ) cfg.ports = atoi(v);
+        else if ( a == "--rate" ) cfg.rate = atof(v);
+        else if ( a == "--duration" ) cfg.duration = atof(v);
+        else if ( a == "--subscribe" ) cfg.subscriptions.push_back(v);
+        else if ( a == "--client-rate" ) cfg.client_rate = atof(v);
+        else if ( a == "--slow" ) cfg.slow = atoi(v);
+        else if ( a == "--slow-delay" ) cfg.slow_delay_ms = atoi(v);
+        else if ( a == "--late" ) cfg.late_ms = atof(v);
+        else if ( a == "--tcp-port" ) cfg.tcp_port = (unsigned short)atoi(v);
+        else {
+            cerr << "Unknown option " << a << ". See the top of tcpbench.cpp for usage." << endl;
+            return 1;
+        }
+    }
+    if ( cfg.subscriptions.empty() )
+        cfg.subscriptions.push_back("Bench.Data*");
+    if ( cfg.rate <= 0 || cfg.clients <= 0 || cfg.duration <= 0 ) {
+        cerr << "Rate, clients and duration must be positive." << endl;
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    // The clients run in a separate process, such that the CPU usage
+    // of this process is the one of the server alone.
+    fflush(stdout);
+    pid_t child = fork();
+    if ( child < 0 ) {
+        perror("fork");
+        return 1;
+    }
+    if ( child == 0 )
+        _exit( runClients(cfg) );
+
+    BenchComponent bench(cfg.ports);
+    TcpReporting rc("TCPReporting");
+    rc.properties()->getPropertyType<unsigned int>("port")->set( cfg.tcp_port );
+    // The reporter runs in this thread, right after the synthetic data was written.
+    rc.setActivity( new extras::SlaveActivity( 1.0 / cfg.rate ) );
+    rc.addPeer( &bench );
+    if ( !rc.reportComponent("Bench") || !rc.configure() || !rc.start() ) {
+        cerr << "Could not start the TcpReporting component." << endl;
+        kill(child, SIGTERM);
+        waitpid(child, 0, 0);
+        return 1;
+    }
+
+    double warmup = 0.5, stop = warmup + cfg.duration;
+    double period = 1.0 / cfg.rate, cpu0 = 0.0, cpu1 = 0.0, overrun = 0.0;
+    int n = 0;
+    for (double t = period; t < stop + 0.5; t += period, ++n) {
+        sleepUntil(t);
+        if ( cpu0 == 0.0 && t >= warmup )
+            cpu0 = cpuSeconds();
+        if ( cpu1 == 0.0 && t >= stop )
+            cpu1 = cpuSeconds();
+        bench.write(n);
+        rc.getActivity()->execute();
+        if ( t >= warmup && t < stop )
+            overrun = max( overrun, now() - t );
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    rc.stop();
+    rc.cleanup();
+
+    printf("\nserver: %d clients, %d ports, %.0f Hz, %.1f s\n", cfg.clients, cfg.ports, cfg.rate, cfg.duration);
+    printf("server CPU: %.3f s (%.1f %% of one core)\n", cpu1 - cpu0, 100.0 * (cpu1 - cpu0) / cfg.duration);
+    printf("server worst cycle time: %.3f ms (period %.3f ms)\n", overrun * 1e3, period * 1e3);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -0,0 +1,191 @@
+/**
+ * Test of the report index and of queries on indexed reports.
+ *
+ * A FileReporting with WriteIndex is stepped on a frozen clock, and the
+ * report is queried while it is written, when the index only covers the
+ * first block, and again after it stopped, over a time range which
+ * crosses a block boundary. An index built afterwards by
+ * ReportReader::buildIndex must give the same rows, and rows with values
+ * which contain spaces must be skipped.
+ *
+ * Usage: testreportindex
+ */
+#include <rtt/os/main.h>
+#include <reporting/FileReporting.hpp>
+#include <reporting/ReportReader.hpp>
+
+#include <rtt/extras/SlaveActivity.hpp>
+#include <rtt/os/TimeService.hpp>
+#include <rtt/Property.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+
+namespace
+{
+    const char* report = "testreportindex.dat";
+    const char* builtIndex = "testreportindex.built.idx";
+    const char* spaced = "testreportindex-spaces.dat";
+
+    /// Collects the first value of each row
+    struct Rows : public OCL::ReportReader::RowHandler
+    {
+        vector<double> times;
+        vector<string> values;
+        virtual void row(double time, const vector<string>& v)
+        {
+            times.push_back(time);
+            values.push_back(v.empty() ? string() : v.front());
+        }
+    };
+
+    /// Query \a column over [t0, t1] and compare the values with \a expected
+    bool queries(OCL::ReportReader& reader, const string& column, double t0, double t1,
+                 const vector<string>& expected, const string& what)
+    {
+        Rows rows;
+        if (reader.query(vector<string>(1, column), t0, t1, rows) && rows.values == expected)
+            return true;
+        cerr << "FAILED: " << what << ", read";
+        for (size_t i = 0; i != rows.values.size(); ++i)
+            cerr << " " << rows.times[i] << ":" << rows.values[i];
+        cerr << endl;
+        return false;
+    }
+
+    /// The values first, first + 1, ..., last as written by the TableMarshaller
+    vector<string> range(int first, int last)
+    {
+        vector<string> v;
+        for (int i = first; i <= last; ++i) {
+            ostringstream s;
+            s << i;
+            v.push_back(s.str());
+        }
+        return v;
+    }
+
+    int testWriteIndex()
+    {
+        TaskContext comp("Comp");
+        Attribute<double> x("X", 0.0);
+        comp.addAttribute(x);
+
+        OCL::FileReporting reporter("Reporter");
+        reporter.addPeer(&comp);
+        reporter.properties()->getPropertyType<string>("ReportFile")->set(report);
+        reporter.properties()->getPropertyType<bool>("WriteIndex")->set(true);
+        reporter.properties()->getPropertyType<int>("IndexBlockRows")->set(4);
+        reporter.setActivity(new extras::SlaveActivity(0.1));
+
+        // sample X = i at i * 0.1 s, after the initial X = 0 at 0 s
+        os::TimeService* time = os::TimeService::Instance();
+        time->enableSystemClock(false);
+        bool ok = reporter.reportData("Comp", "X") && reporter.start();
+        if (!ok)
+            cerr << "FAILED: starting the reporter" << endl;
+        OCL::ReportReader reader;
+        for (int i = 1; ok && (i <= 10); ++i) {
+            time->secondsChange(0.1);
+            x.set(i);
+            reporter.getActivity()->execute();
+
+            // the index only has the block of 0 .. 3 yet, but the rows
+            // written after it are found up to the end of the report.
+            if (i == 6) {
+                ok &= reader.open(report) && (2 == reader.columns().size()) && (1 == reader.column("Comp.X"));
+                if (!ok)
+                    cerr << "FAILED: opening the report while it is written" << endl;
+                ok = ok && queries(reader, "Comp.X", 0.0, 10.0, range(0, 6), "querying the report while it is written");
+                reader.close();
+            }
+        }
+        reporter.stop();
+        time->enableSystemClock(true);
+        reporter.removePeer("Comp");
+
+        // the blocks hold 0 .. 3, 4 .. 7 and 8 .. 10
+        if (ok && !reader.open(report)) {
+            cerr << "FAILED: opening the written report" << endl;
+            ok = false;
+        }
+        if (ok && ((reader.startTime() != 0.0) || (reader.endTime() < 0.95) || (reader.endTime() > 1.05))) {
+            cerr << "FAILED: the indexed time range is " << reader.startTime() << " .. " << reader.endTime() << endl;
+            ok = false;
+        }
+        ok = ok && queries(reader, "Comp.X", 0.0, 10.0, range(0, 10), "querying all rows");
+        unsigned long long all = reader.scannedBytes();
+        ok = ok && queries(reader, "Comp.X", 0.35, 0.85, range(4, 8), "querying across a block boundary");
+        if (ok && !(reader.scannedBytes() < all)) {
+            cerr << "FAILED: the first block was scanned for a later time range" << endl;
+            ok = false;
+        }
+        ok = ok && queries(reader, "Comp.X", 0.75, 0.75, vector<string>(), "querying between two rows");
+        Rows unknown;
+        if (ok && reader.query(vector<string>(1, "Comp.Y"), 0.0, 10.0, unknown)) {
+            cerr << "FAILED: querying an unknown column" << endl;
+            ok = false;
+        }
+        reader.close();
+
+        // an index built from the report, in other blocks, gives the same rows
+        if (ok && !(OCL::ReportReader::buildIndex(report, 3, builtIndex) && reader.open(report, builtIndex))) {
+            cerr << "FAILED: building the index" << endl;
+            ok = false;
+        }
+        ok = ok && (1 == reader.column("Comp.X"))
+            && queries(reader, "Comp.X", 0.35, 0.85, range(4, 8), "querying a built index across a block boundary");
+        reader.close();
+
+        remove(report);
+        remove((string(report) + ".idx").c_str());
+        remove(builtIndex);
+        return ok ? 0 : 1;
+    }
+
+    int testSpaces()
+    {
+        {
+            ofstream out(spaced);
+            out << " TimeStamp A B" << endl
+                << " 0 1 x" << endl
+                << " 1 2 y" << endl
+                << " 2 3 two words" << endl
+                << " 3 4 z" << endl;
+        }
+        OCL::ReportReader reader;
+        bool ok = OCL::ReportReader::buildIndex(spaced, 2) && reader.open(spaced);
+        if (!ok)
+            cerr << "FAILED: indexing the report with spaces" << endl;
+        vector<string> expected;
+        expected.push_back("x");
+        expected.push_back("y");
+        expected.push_back("z");
+        ok = ok && queries(reader, "B", 0.0, 10.0, expected, "skipping the row with spaces");
+        if (ok && (1 != reader.skippedRows())) {
+            cerr << "FAILED: counting the skipped rows, counted " << reader.skippedRows() << endl;
+            ok = false;
+        }
+        reader.close();
+
+        remove(spaced);
+        remove((string(spaced) + ".idx").c_str());
+        return ok ? 0 : 1;
+    }
+}
+
+int ORO_main(int argc, char** argv)
+{
+    int rc = 0;
+    rc |= testWriteIndex();
+    rc |= testSpaces();
+    cout << (rc ? "testreportindex FAILED" : "testreportindex passed") << endl;
+    return rc;
+}
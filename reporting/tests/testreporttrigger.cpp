@@ -0,0 +1,180 @@
+/**
+ * Test of triggered reporting.
+ *
+ * Trigger expressions are compiled against a bag of columns, and must
+ * evaluate with the usual precedence, see changed() on every sample, and
+ * be rejected for trailing input and unknown or non-numeric columns.
+ * A ReportingComponent with a trigger is then stepped on a frozen clock,
+ * and must only write out the samples in the PreTrigger and PostTrigger
+ * windows around each trigger.
+ *
+ * Usage: testreporttrigger
+ */
+#include <rtt/os/main.h>
+#include <reporting/ReportTrigger.hpp>
+#include <reporting/ReportingComponent.hpp>
+
+#include <rtt/extras/SlaveActivity.hpp>
+#include <rtt/marsh/MarshallInterface.hpp>
+#include <rtt/os/TimeService.hpp>
+#include <rtt/Property.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace RTT;
+
+namespace
+{
+    bool check(bool ok, const string& what)
+    {
+        if (!ok)
+            cerr << "FAILED: " << what << endl;
+        return ok;
+    }
+
+    /// Compile \a expr against \a bag, and compare its value with \a expected
+    bool evaluates(const string& expr, const PropertyBag& bag, bool expected)
+    {
+        OCL::ReportTrigger trigger;
+        return check(trigger.compile(expr, bag) && (expected == trigger.evaluate()),
+                     "'" + expr + "' evaluates to " + (expected ? "true" : "false"));
+    }
+
+    bool rejects(const string& expr, const PropertyBag& bag)
+    {
+        OCL::ReportTrigger trigger;
+        return check(!trigger.compile(expr, bag) && !trigger.evaluate(),
+                     "'" + expr + "' is rejected");
+    }
+
+    int testExpressions()
+    {
+        Property<double> x("Comp.X", "", 2.0);
+        Property<int> n("Comp.N", "", 3);
+        Property<bool> b("Comp.B", "", true);
+        Property<string> s("Comp.S", "", "text");
+        Property<PropertyBag> vec("Comp.Vec", "");
+        vec.value().ownProperty(new Property<double>("0", "", 1.0));
+        vec.value().ownProperty(new Property<double>("1", "", -1.0));
+        PropertyBag bag;
+        bag.addProperty(x);
+        bag.addProperty(n);
+        bag.addProperty(b);
+        bag.addProperty(s);
+        bag.addProperty(vec);
+
+        bool ok = true;
+        ok &= evaluates("Comp.X > 1", bag, true);
+        ok &= evaluates("Comp.X > 1 && Comp.N == 3", bag, true);
+        ok &= evaluates("Comp.X >= 2 && Comp.X <= 2 && Comp.X != 3", bag, true);
+        ok &= evaluates("1 || 0 && 0", bag, true);
+        ok &= evaluates("(1 || 0) && 0", bag, false);
+        ok &= evaluates("!Comp.B || Comp.X < 0", bag, false);
+        ok &= evaluates("!(Comp.B && 0)", bag, true);
+        ok &= evaluates("-2.5 < Comp.Vec.1", bag, true);
+        ok &= evaluates("Comp.N", bag, true);
+
+        ok &= rejects("", bag);
+        ok &= rejects("Comp.X > 1 )", bag);
+        ok &= rejects("Comp.X >", bag);
+        ok &= rejects("(Comp.X > 1", bag);
+        ok &= rejects("Comp.Y > 1", bag);
+        ok &= rejects("Comp.S == 1", bag);
+        ok &= rejects("Comp.Vec > 0", bag);
+        ok &= rejects("changed(Comp.X", bag);
+
+        // changed() is false on the first sample, and true once per change
+        OCL::ReportTrigger changed;
+        ok &= check(changed.compile("changed(Comp.X)", bag), "compiling changed()");
+        ok &= check(!changed.evaluate(), "changed() on the first sample");
+        ok &= check(!changed.evaluate(), "changed() without a change");
+        x.set(3.0);
+        ok &= check(changed.evaluate(), "changed() after a change");
+        ok &= check(!changed.evaluate(), "changed() after the change was seen");
+
+        // changed() sees every sample, also when the other operand decides
+        OCL::ReportTrigger either;
+        n.set(10);
+        ok &= check(either.compile("Comp.N > 5 || changed(Comp.X)", bag), "compiling ||");
+        ok &= check(either.evaluate(), "|| on the first sample");
+        x.set(4.0);
+        ok &= check(either.evaluate(), "|| on a change");
+        n.set(0);
+        ok &= check(!either.evaluate(), "changed() saw the sample in which the other operand decided");
+
+        return ok ? 0 : 1;
+    }
+
+    /// Records the Comp.X column of the written samples
+    class Recorder : public marsh::MarshallInterface
+    {
+    public:
+        vector<double>& written;
+        Recorder(vector<double>& w) : written(w) {}
+        virtual void serialize(base::PropertyBase*) {}
+        virtual void serialize(const PropertyBag& v)
+        {
+            Property<double>* x = v.getPropertyType<double>("Comp.X");
+            written.push_back(x ? x->get() : -1.0);
+        }
+        virtual void flush() {}
+    };
+
+    int testWindows()
+    {
+        TaskContext comp("Comp");
+        Attribute<double> x("X", 0.0);
+        comp.addAttribute(x);
+
+        OCL::ReportingComponent reporter("Reporter");
+        vector<double> written;
+        reporter.addMarshaller(0, new Recorder(written));
+        reporter.addPeer(&comp);
+        reporter.properties()->getPropertyType<bool>("Decompose")->set(false);
+        reporter.properties()->getPropertyType<bool>("WriteHeader")->set(false);
+        reporter.properties()->getPropertyType<string>("Trigger")->set("Comp.X == 5 || Comp.X == 10");
+        // a history of 3 samples
+        reporter.properties()->getPropertyType<double>("PreTrigger")->set(0.25);
+        reporter.properties()->getPropertyType<double>("PostTrigger")->set(0.15);
+        reporter.setActivity(new extras::SlaveActivity(0.1));
+
+        // sample X = i at i * 0.1 s
+        os::TimeService* time = os::TimeService::Instance();
+        time->enableSystemClock(false);
+        bool ok = check(reporter.reportData("Comp", "X") && reporter.start(), "starting the reporter");
+        for (int i = 1; ok && (i <= 12); ++i) {
+            time->secondsChange(0.1);
+            x.set(i);
+            reporter.getActivity()->execute();
+        }
+        reporter.stop();
+        time->enableSystemClock(true);
+
+        // the first trigger writes out 3 and 4 of the history, but not 2,
+        // which is older than PreTrigger, then 5 and 6 in the PostTrigger
+        // window. The second one writes out 8 and 9, then 10 and 11.
+        const double expected[] = { 3, 4, 5, 6, 8, 9, 10, 11 };
+        const vector<double> v(expected, expected + sizeof(expected) / sizeof(expected[0]));
+        if (written != v) {
+            cerr << "FAILED: the trigger windows, wrote";
+            for (size_t i = 0; i != written.size(); ++i)
+                cerr << " " << written[i];
+            cerr << endl;
+            ok = false;
+        }
+        reporter.removePeer("Comp");
+        return ok ? 0 : 1;
+    }
+}
+
+int ORO_main(int argc, char** argv)
+{
+    int rc = 0;
+    rc |= testExpressions();
+    rc |= testWindows();
+    cout << (rc ? "testreporttrigger FAILED" : "testreporttrigger passed") << endl;
+    return rc;
+}